@@ -40,7 +40,7 @@ if { [string first $scripts_vivado_version $current_vivado_version] == -1 } {
 
 # The design that will be created by this Tcl script contains the following 
 # module references:
-# get_pix, orb, write_descriptor_bram, write_descriptors
+# descriptor_match, get_pix, orb, orb_counters, write_descriptor_bram, write_descriptors
 
 # Please add the sources of those modules before sourcing this Tcl script.
 
@@ -59,6 +59,22 @@ if { $list_projs eq "" } {
 variable design_name
 set design_name orb_acc_demo
 
+# CHANGE ORIENTATION RESOLUTION HERE
+# 2^theta_size orientation sectors per quadrant, 2 to 5 (4 to 32 sectors,
+# 22.5 to 2.8 degrees). Selects the orientation module and BRIEF ROMs of orb_0
+# and the width of the angle field written by write_descriptors_0.
+variable theta_size
+set theta_size 3
+
+# CHANGE PIXEL UPLOAD HERE
+# true splits the pixel BRAM of get_pix_0 in two chunks of mem_size_pix
+# pixels, filled by the host while the other one streams; false streams one
+# chunk at a time. Two chunks of 32760 or one of 65528 fill the 64 KiB BRAM.
+variable ping_pong
+set ping_pong true
+variable mem_size_pix
+set mem_size_pix 32760
+
 # If you do not already have an existing IP Integrator design open,
 # you can create a design using the following command:
 #    create_bd_design $design_name
@@ -165,8 +181,10 @@ xilinx.com:ip:xlslice:1.0\
 set bCheckModules 1
 if { $bCheckModules == 1 } {
    set list_check_mods "\ 
+descriptor_match\
 get_pix\
 orb\
+orb_counters\
 write_descriptor_bram\
 write_descriptors\
 "
@@ -201,6 +219,7 @@ if { $bCheckIPsPassed != 1 } {
 proc create_hier_cell_orb_descriptors_memory { parentCell nameHier } {
 
   variable script_folder
+  variable theta_size
 
   if { $parentCell eq "" || $nameHier eq "" } {
      catch {common::send_gid_msg -ssname BD::TCL -id 2092 -severity "ERROR" "create_hier_cell_orb_descriptors_memory() - Empty argument(s)!"}
@@ -240,9 +259,11 @@ proc create_hier_cell_orb_descriptors_memory { parentCell nameHier } {
 
   create_bd_intf_pin -mode Slave -vlnv xilinx.com:interface:aximm_rtl:1.0 S_AXI10
 
+  create_bd_intf_pin -mode Slave -vlnv xilinx.com:interface:aximm_rtl:1.0 S_AXI11
+
 
   # Create pins
-  create_bd_pin -dir I -from 3 -to 0 angle
+  create_bd_pin -dir I -from [expr {$theta_size + 1}] -to 0 angle
   create_bd_pin -dir I -from 255 -to 0 descriptor
   create_bd_pin -dir I en
   create_bd_pin -dir I -type rst led_2
@@ -250,8 +271,9 @@ proc create_hier_cell_orb_descriptors_memory { parentCell nameHier } {
   create_bd_pin -dir I -from 10 -to 0 pos_y
   create_bd_pin -dir I -type clk s_axi_aclk
   create_bd_pin -dir I -type rst s_axi_aresetn
-  create_bd_pin -dir I scale
+  create_bd_pin -dir I -from 2 -to 0 scale
   create_bd_pin -dir I -from 11 -to 0 score
+  create_bd_pin -dir O -from 31 -to 0 status
 
   # Create instance: axi_bram_ctrl_descriptor_0, and set properties
   set axi_bram_ctrl_descriptor_0 [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_bram_ctrl:4.1 axi_bram_ctrl_descriptor_0 ]
@@ -307,6 +329,14 @@ proc create_hier_cell_orb_descriptors_memory { parentCell nameHier } {
    CONFIG.SINGLE_PORT_BRAM {1} \
  ] $axi_bram_ctrl_descriptors_scr_angle
 
+  # Create instance: axi_bram_ctrl_match, and set properties
+  set axi_bram_ctrl_match [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_bram_ctrl:4.1 axi_bram_ctrl_match ]
+  set_property -dict [ list \
+   CONFIG.DATA_WIDTH {32} \
+   CONFIG.ECC_TYPE {0} \
+   CONFIG.SINGLE_PORT_BRAM {1} \
+ ] $axi_bram_ctrl_match
+
   # Create instance: axi_bram_descriptors_pos, and set properties
   set axi_bram_descriptors_pos [ create_bd_cell -type ip -vlnv xilinx.com:ip:blk_mem_gen:8.4 axi_bram_descriptors_pos ]
   set_property -dict [ list \
@@ -329,6 +359,22 @@ proc create_hier_cell_orb_descriptors_memory { parentCell nameHier } {
    CONFIG.Use_RSTB_Pin {true} \
  ] $axi_bram_descriptors_scr_angle
 
+  # Create instance: descriptor_match_0, and set properties
+  set block_name descriptor_match
+  set block_cell_name descriptor_match_0
+  if { [catch {set descriptor_match_0 [create_bd_cell -type module -reference $block_name $block_cell_name] } errmsg] } {
+     catch {common::send_gid_msg -ssname BD::TCL -id 2095 -severity "ERROR" "Unable to add referenced block <$block_name>. Please add the files for ${block_name}'s definition into the project."}
+     return 1
+   } elseif { $descriptor_match_0 eq "" } {
+     catch {common::send_gid_msg -ssname BD::TCL -id 2096 -severity "ERROR" "Unable to referenced block <$block_name>. Please add the files for ${block_name}'s definition into the project."}
+     return 1
+   }
+    set_property -dict [ list \
+   CONFIG.FEATURE_LINES {512} \
+   CONFIG.MAX_REFS {512} \
+   CONFIG.QUEUE_DEPTH {16} \
+ ] $descriptor_match_0
+
   # Create instance: write_descriptor_bram_0, and set properties
   set block_name write_descriptor_bram
   set block_cell_name write_descriptor_bram_0
@@ -351,39 +397,52 @@ proc create_hier_cell_orb_descriptors_memory { parentCell nameHier } {
      return 1
    }
     set_property -dict [ list \
+   CONFIG.CELL_K {512} \
+   CONFIG.FEATURE_LINES {512} \
+   CONFIG.GRID_X {1} \
+   CONFIG.GRID_Y {1} \
+   CONFIG.LINE_SIZE {640} \
    CONFIG.MEM_SIZE {4096} \
-   CONFIG.THETA_SIZE {2} \
+   CONFIG.NUM_LINES {480} \
+   CONFIG.QUEUE_DEPTH {8} \
+   CONFIG.THETA_SIZE $theta_size \
  ] $write_descriptors_0
 
   # Create interface connections
   connect_bd_intf_net -intf_net Conn5 [get_bd_intf_pins S_AXI9] [get_bd_intf_pins axi_bram_ctrl_descriptors_scr_angle/S_AXI]
   connect_bd_intf_net -intf_net S_AXI10_1 [get_bd_intf_pins S_AXI10] [get_bd_intf_pins axi_bram_ctrl_descriptor_0/S_AXI]
+  connect_bd_intf_net -intf_net S_AXI11_1 [get_bd_intf_pins S_AXI11] [get_bd_intf_pins axi_bram_ctrl_match/S_AXI]
   connect_bd_intf_net -intf_net S_AXI1_1 [get_bd_intf_pins S_AXI1] [get_bd_intf_pins axi_bram_ctrl_descriptor_1/S_AXI]
   connect_bd_intf_net -intf_net axi_bram_ctrl_descriptor_0_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_descriptor_0/BRAM_PORTA] [get_bd_intf_pins axi_bram_ctrl_descriptor_0_bram/BRAM_PORTA]
   connect_bd_intf_net -intf_net axi_bram_ctrl_descriptor_1_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_descriptor_1/BRAM_PORTA] [get_bd_intf_pins axi_bram_ctrl_descriptor_1_bram/BRAM_PORTA]
   connect_bd_intf_net -intf_net axi_bram_ctrl_descriptors_4_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_descriptors_pos/BRAM_PORTA] [get_bd_intf_pins axi_bram_descriptors_pos/BRAM_PORTA]
   connect_bd_intf_net -intf_net axi_bram_ctrl_descriptors_scr_angle_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_descriptors_scr_angle/BRAM_PORTA] [get_bd_intf_pins axi_bram_descriptors_scr_angle/BRAM_PORTA]
+  connect_bd_intf_net -intf_net axi_bram_ctrl_match_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_match/BRAM_PORTA] [get_bd_intf_pins descriptor_match_0/BRAM_PORTA]
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M10_AXI [get_bd_intf_pins S_AXI] [get_bd_intf_pins axi_bram_ctrl_descriptors_pos/S_AXI]
 
   # Create port connections
   connect_bd_net -net angle_0_1 [get_bd_pins angle] [get_bd_pins write_descriptors_0/angle]
-  connect_bd_net -net axi_gpio_reset_fast_gpio_io_o [get_bd_pins led_2] [get_bd_pins axi_bram_ctrl_descriptor_0_bram/enb] [get_bd_pins axi_bram_ctrl_descriptor_1_bram/enb] [get_bd_pins axi_bram_descriptors_pos/enb] [get_bd_pins axi_bram_descriptors_scr_angle/enb] [get_bd_pins write_descriptor_bram_0/rst_n] [get_bd_pins write_descriptors_0/rst_n]
-  connect_bd_net -net orb_0_descriptor [get_bd_pins descriptor] [get_bd_pins write_descriptor_bram_0/descriptor] [get_bd_pins write_descriptors_0/descriptor]
-  connect_bd_net -net orb_0_descriptor_ready [get_bd_pins en] [get_bd_pins axi_bram_descriptors_pos/web] [get_bd_pins axi_bram_descriptors_scr_angle/web] [get_bd_pins write_descriptor_bram_0/we_i] [get_bd_pins write_descriptors_0/en]
+  connect_bd_net -net axi_gpio_reset_fast_gpio_io_o [get_bd_pins led_2] [get_bd_pins axi_bram_ctrl_descriptor_0_bram/enb] [get_bd_pins axi_bram_ctrl_descriptor_1_bram/enb] [get_bd_pins axi_bram_descriptors_pos/enb] [get_bd_pins axi_bram_descriptors_scr_angle/enb] [get_bd_pins descriptor_match_0/rst_n] [get_bd_pins write_descriptor_bram_0/rst_n] [get_bd_pins write_descriptors_0/rst_n]
+  connect_bd_net -net orb_0_descriptor [get_bd_pins descriptor] [get_bd_pins write_descriptors_0/descriptor]
+  connect_bd_net -net orb_0_descriptor_ready [get_bd_pins en] [get_bd_pins write_descriptors_0/en]
   connect_bd_net -net orb_0_pos_descriptor_x [get_bd_pins pos_x] [get_bd_pins write_descriptors_0/pos_x]
   connect_bd_net -net orb_0_pos_descriptor_y [get_bd_pins pos_y] [get_bd_pins write_descriptors_0/pos_y]
-  connect_bd_net -net proc_sys_reset_0_peripheral_aresetn [get_bd_pins s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptor_0/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptor_1/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptors_pos/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptors_scr_angle/s_axi_aresetn]
-  connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptor_0/s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptor_0_bram/clkb] [get_bd_pins axi_bram_ctrl_descriptor_1/s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptor_1_bram/clkb] [get_bd_pins axi_bram_ctrl_descriptors_pos/s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptors_scr_angle/s_axi_aclk] [get_bd_pins axi_bram_descriptors_pos/clkb] [get_bd_pins axi_bram_descriptors_scr_angle/clkb] [get_bd_pins write_descriptor_bram_0/clk] [get_bd_pins write_descriptors_0/clk]
+  connect_bd_net -net proc_sys_reset_0_peripheral_aresetn [get_bd_pins s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptor_0/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptor_1/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptors_pos/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_descriptors_scr_angle/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_match/s_axi_aresetn]
+  connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptor_0/s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptor_0_bram/clkb] [get_bd_pins axi_bram_ctrl_descriptor_1/s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptor_1_bram/clkb] [get_bd_pins axi_bram_ctrl_descriptors_pos/s_axi_aclk] [get_bd_pins axi_bram_ctrl_descriptors_scr_angle/s_axi_aclk] [get_bd_pins axi_bram_ctrl_match/s_axi_aclk] [get_bd_pins axi_bram_descriptors_pos/clkb] [get_bd_pins axi_bram_descriptors_scr_angle/clkb] [get_bd_pins descriptor_match_0/clk] [get_bd_pins write_descriptor_bram_0/clk] [get_bd_pins write_descriptors_0/clk]
   connect_bd_net -net scale_0_1 [get_bd_pins scale] [get_bd_pins write_descriptors_0/scale]
   connect_bd_net -net score_0_1 [get_bd_pins score] [get_bd_pins write_descriptors_0/score]
   connect_bd_net -net write_descriptor_bram_0_addr_o [get_bd_pins axi_bram_ctrl_descriptor_0_bram/addrb] [get_bd_pins axi_bram_ctrl_descriptor_1_bram/addrb] [get_bd_pins write_descriptor_bram_0/addr_o]
   connect_bd_net -net write_descriptor_bram_0_data_o_0 [get_bd_pins axi_bram_ctrl_descriptor_0_bram/dinb] [get_bd_pins write_descriptor_bram_0/data_o_0]
   connect_bd_net -net write_descriptor_bram_0_data_o_1 [get_bd_pins axi_bram_ctrl_descriptor_1_bram/dinb] [get_bd_pins write_descriptor_bram_0/data_o_1]
   connect_bd_net -net write_descriptor_bram_0_we_o [get_bd_pins axi_bram_ctrl_descriptor_0_bram/web] [get_bd_pins axi_bram_ctrl_descriptor_1_bram/web] [get_bd_pins write_descriptor_bram_0/we_o]
-  connect_bd_net -net write_descriptors_0_addr [get_bd_pins axi_bram_descriptors_pos/addrb] [get_bd_pins axi_bram_descriptors_scr_angle/addrb] [get_bd_pins write_descriptors_0/addr]
+  connect_bd_net -net write_descriptors_0_addr [get_bd_pins axi_bram_descriptors_pos/addrb] [get_bd_pins axi_bram_descriptors_scr_angle/addrb] [get_bd_pins descriptor_match_0/addr] [get_bd_pins write_descriptors_0/addr]
   connect_bd_net -net write_descriptors_0_addr_128b [get_bd_pins write_descriptor_bram_0/addr] [get_bd_pins write_descriptors_0/addr_128b]
+  connect_bd_net -net write_descriptors_0_descriptor_o [get_bd_pins descriptor_match_0/descriptor] [get_bd_pins write_descriptor_bram_0/descriptor] [get_bd_pins write_descriptors_0/descriptor_o]
   connect_bd_net -net write_descriptors_0_pos_line [get_bd_pins axi_bram_descriptors_pos/dinb] [get_bd_pins write_descriptors_0/pos_line]
   connect_bd_net -net write_descriptors_0_scr_angle_line [get_bd_pins axi_bram_descriptors_scr_angle/dinb] [get_bd_pins write_descriptors_0/scr_angle_line]
+  connect_bd_net -net write_descriptors_0_status [get_bd_pins status] [get_bd_pins write_descriptors_0/status]
+  connect_bd_net -net write_descriptors_0_we [get_bd_pins axi_bram_descriptors_pos/web] [get_bd_pins axi_bram_descriptors_scr_angle/web] [get_bd_pins write_descriptors_0/we]
+  connect_bd_net -net write_descriptors_0_we_descriptor [get_bd_pins descriptor_match_0/we] [get_bd_pins write_descriptor_bram_0/we_i] [get_bd_pins write_descriptors_0/we_descriptor]
 
   # Restore current instance
   current_bd_instance $oldCurInst
@@ -396,6 +455,9 @@ proc create_root_design { parentCell } {
 
   variable script_folder
   variable design_name
+  variable theta_size
+  variable ping_pong
+  variable mem_size_pix
 
   if { $parentCell eq "" } {
      set parentCell [get_bd_cells /]
@@ -454,6 +516,14 @@ proc create_root_design { parentCell } {
    CONFIG.Use_RSTB_Pin {true} \
  ] $axi_bram_ctrl_0_bram
 
+  # Create instance: axi_bram_ctrl_counters, and set properties
+  set axi_bram_ctrl_counters [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_bram_ctrl:4.1 axi_bram_ctrl_counters ]
+  set_property -dict [ list \
+   CONFIG.DATA_WIDTH {32} \
+   CONFIG.ECC_TYPE {0} \
+   CONFIG.SINGLE_PORT_BRAM {1} \
+ ] $axi_bram_ctrl_counters
+
   # Create instance: axi_gpio_corner_thresh, and set properties
   set axi_gpio_corner_thresh [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_gpio:2.0 axi_gpio_corner_thresh ]
   set_property -dict [ list \
@@ -465,8 +535,11 @@ proc create_root_design { parentCell } {
   # Create instance: axi_gpio_reset_fast, and set properties
   set axi_gpio_reset_fast [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_gpio:2.0 axi_gpio_reset_fast ]
   set_property -dict [ list \
+   CONFIG.C_ALL_INPUTS_2 {1} \
    CONFIG.C_ALL_OUTPUTS {1} \
+   CONFIG.C_GPIO2_WIDTH {32} \
    CONFIG.C_GPIO_WIDTH {1} \
+   CONFIG.C_IS_DUAL {1} \
  ] $axi_gpio_reset_fast
 
   # Create instance: get_pix_0, and set properties
@@ -480,7 +553,8 @@ proc create_root_design { parentCell } {
      return 1
    }
     set_property -dict [ list \
-   CONFIG.MEM_SIZE {65528} \
+   CONFIG.MEM_SIZE $mem_size_pix \
+   CONFIG.PING_PONG $ping_pong \
  ] $get_pix_0
 
   # Create instance: orb_0, and set properties
@@ -497,11 +571,23 @@ proc create_root_design { parentCell } {
    CONFIG.ACONF_FEATURE_FIFO_ADDR_SIZE {8} \
    CONFIG.ACONF_FEATURE_FIFO_SIZE {256} \
    CONFIG.ACONF_LINE_SIZE {640} \
+   CONFIG.ACONF_NUM_CONSTRUCTORS {1} \
    CONFIG.ACONF_NUM_LINES {480} \
    CONFIG.ACONF_NUM_SCALES {3} \
-   CONFIG.ACONF_THETA_SIZE {2} \
+   CONFIG.ACONF_THETA_SIZE $theta_size \
  ] $orb_0
 
+  # Create instance: orb_counters_0, and set properties
+  set block_name orb_counters
+  set block_cell_name orb_counters_0
+  if { [catch {set orb_counters_0 [create_bd_cell -type module -reference $block_name $block_cell_name] } errmsg] } {
+     catch {common::send_gid_msg -ssname BD::TCL -id 2095 -severity "ERROR" "Unable to add referenced block <$block_name>. Please add the files for ${block_name}'s definition into the project."}
+     return 1
+   } elseif { $orb_counters_0 eq "" } {
+     catch {common::send_gid_msg -ssname BD::TCL -id 2096 -severity "ERROR" "Unable to referenced block <$block_name>. Please add the files for ${block_name}'s definition into the project."}
+     return 1
+   }
+
   # Create instance: orb_descriptors_memory
   create_hier_cell_orb_descriptors_memory [current_bd_instance .] orb_descriptors_memory
 
@@ -745,7 +831,7 @@ proc create_root_design { parentCell } {
    CONFIG.PCW_INCLUDE_TRACE_BUFFER {0} \
    CONFIG.PCW_IOPLL_CTRL_FBDIV {30} \
    CONFIG.PCW_IO_IO_PLL_FREQMHZ {1000.000} \
-   CONFIG.PCW_IRQ_F2P_INTR {0} \
+   CONFIG.PCW_IRQ_F2P_INTR {1} \
    CONFIG.PCW_IRQ_F2P_MODE {DIRECT} \
    CONFIG.PCW_MIO_0_DIRECTION {inout} \
    CONFIG.PCW_MIO_0_IOTYPE {LVCMOS 3.3V} \
@@ -1291,7 +1377,7 @@ proc create_root_design { parentCell } {
    CONFIG.PCW_USE_DMA3 {0} \
    CONFIG.PCW_USE_EXPANDED_IOP {0} \
    CONFIG.PCW_USE_EXPANDED_PS_SLCR_REGISTERS {0} \
-   CONFIG.PCW_USE_FABRIC_INTERRUPT {0} \
+   CONFIG.PCW_USE_FABRIC_INTERRUPT {1} \
    CONFIG.PCW_USE_HIGH_OCM {0} \
    CONFIG.PCW_USE_M_AXI_GP0 {1} \
    CONFIG.PCW_USE_M_AXI_GP1 {0} \
@@ -1317,7 +1403,7 @@ proc create_root_design { parentCell } {
   set ps7_0_axi_periph [ create_bd_cell -type ip -vlnv xilinx.com:ip:axi_interconnect:2.1 ps7_0_axi_periph ]
   set_property -dict [ list \
    CONFIG.ENABLE_ADVANCED_OPTIONS {0} \
-   CONFIG.NUM_MI {7} \
+   CONFIG.NUM_MI {9} \
    CONFIG.NUM_SI {1} \
    CONFIG.STRATEGY {1} \
  ] $ps7_0_axi_periph
@@ -1341,6 +1427,7 @@ proc create_root_design { parentCell } {
 
   # Create interface connections
   connect_bd_intf_net -intf_net axi_bram_ctrl_0_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_0/BRAM_PORTA] [get_bd_intf_pins axi_bram_ctrl_0_bram/BRAM_PORTA]
+  connect_bd_intf_net -intf_net axi_bram_ctrl_counters_BRAM_PORTA [get_bd_intf_pins axi_bram_ctrl_counters/BRAM_PORTA] [get_bd_intf_pins orb_counters_0/BRAM_PORTA]
   connect_bd_intf_net -intf_net processing_system7_0_DDR [get_bd_intf_ports DDR] [get_bd_intf_pins processing_system7_0/DDR]
   connect_bd_intf_net -intf_net processing_system7_0_FIXED_IO [get_bd_intf_ports FIXED_IO] [get_bd_intf_pins processing_system7_0/FIXED_IO]
   connect_bd_intf_net -intf_net processing_system7_0_M_AXI_GP0 [get_bd_intf_pins processing_system7_0/M_AXI_GP0] [get_bd_intf_pins ps7_0_axi_periph/S00_AXI]
@@ -1351,28 +1438,39 @@ proc create_root_design { parentCell } {
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M04_AXI [get_bd_intf_pins axi_gpio_reset_fast/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M04_AXI]
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M05_AXI [get_bd_intf_pins axi_gpio_corner_thresh/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M05_AXI]
   connect_bd_intf_net -intf_net ps7_0_axi_periph_M06_AXI [get_bd_intf_pins orb_descriptors_memory/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M06_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M07_AXI [get_bd_intf_pins orb_descriptors_memory/S_AXI11] [get_bd_intf_pins ps7_0_axi_periph/M07_AXI]
+  connect_bd_intf_net -intf_net ps7_0_axi_periph_M08_AXI [get_bd_intf_pins axi_bram_ctrl_counters/S_AXI] [get_bd_intf_pins ps7_0_axi_periph/M08_AXI]
 
   # Create port connections
   connect_bd_net -net axi_bram_ctrl_0_bram_doutb [get_bd_pins axi_bram_ctrl_0_bram/doutb] [get_bd_pins get_pix_0/data_in]
   connect_bd_net -net axi_gpio_corner_thresh_gpio2_io_o [get_bd_pins axi_gpio_corner_thresh/gpio2_io_o] [get_bd_pins xlslice_1/Din]
   connect_bd_net -net axi_gpio_corner_thresh_gpio_io_o [get_bd_pins axi_gpio_corner_thresh/gpio_io_o] [get_bd_pins xlslice_0/Din]
-  connect_bd_net -net axi_gpio_reset_fast_gpio_io_o [get_bd_ports led_2] [get_bd_pins axi_gpio_reset_fast/gpio_io_o] [get_bd_pins get_pix_0/reset_n] [get_bd_pins orb_0/reset_n] [get_bd_pins orb_descriptors_memory/led_2]
+  connect_bd_net -net axi_gpio_reset_fast_gpio_io_o [get_bd_ports led_2] [get_bd_pins axi_gpio_reset_fast/gpio_io_o] [get_bd_pins get_pix_0/reset_n] [get_bd_pins orb_0/reset_n] [get_bd_pins orb_counters_0/rst_n] [get_bd_pins orb_descriptors_memory/led_2]
   connect_bd_net -net descriptor_1 [get_bd_pins orb_0/feature_descriptor] [get_bd_pins orb_descriptors_memory/descriptor]
   connect_bd_net -net get_pix_0_addr [get_bd_pins axi_bram_ctrl_0_bram/addrb] [get_bd_pins get_pix_0/addr]
+  connect_bd_net -net get_pix_0_chunk_done [get_bd_pins get_pix_0/chunk_done] [get_bd_pins processing_system7_0/IRQ_F2P]
   connect_bd_net -net get_pix_0_data_out [get_bd_pins axi_bram_ctrl_0_bram/dinb] [get_bd_pins get_pix_0/data_out]
   connect_bd_net -net get_pix_0_mem_rst [get_bd_pins axi_bram_ctrl_0_bram/rstb] [get_bd_pins get_pix_0/mem_rst]
   connect_bd_net -net get_pix_0_pix [get_bd_pins get_pix_0/pix] [get_bd_pins orb_0/pix_in]
-  connect_bd_net -net get_pix_0_pix_ready [get_bd_pins get_pix_0/pix_ready] [get_bd_pins orb_0/push]
+  connect_bd_net -net get_pix_0_pix_ready [get_bd_pins get_pix_0/pix_ready] [get_bd_pins orb_0/push] [get_bd_pins orb_counters_0/push]
   connect_bd_net -net get_pix_0_pix_ready_n [get_bd_ports led_1] [get_bd_pins get_pix_0/pix_ready_n]
   connect_bd_net -net get_pix_0_renb [get_bd_pins axi_bram_ctrl_0_bram/enb] [get_bd_pins get_pix_0/enb]
   connect_bd_net -net get_pix_0_wenb [get_bd_pins axi_bram_ctrl_0_bram/web] [get_bd_pins get_pix_0/wenb]
   connect_bd_net -net orb_0_feature_angle [get_bd_pins orb_0/feature_angle] [get_bd_pins orb_descriptors_memory/angle]
   connect_bd_net -net orb_0_feature_pos_x [get_bd_pins orb_0/feature_pos_x] [get_bd_pins orb_descriptors_memory/pos_x]
   connect_bd_net -net orb_0_feature_pos_y [get_bd_pins orb_0/feature_pos_y] [get_bd_pins orb_descriptors_memory/pos_y]
-  connect_bd_net -net orb_0_feature_ready [get_bd_pins orb_0/feature_ready] [get_bd_pins orb_descriptors_memory/en]
+  connect_bd_net -net orb_0_feature_ready [get_bd_pins orb_0/feature_ready] [get_bd_pins orb_counters_0/feature_ready] [get_bd_pins orb_descriptors_memory/en]
+  connect_bd_net -net orb_descriptors_memory_status [get_bd_pins axi_gpio_reset_fast/gpio2_io_i] [get_bd_pins orb_descriptors_memory/status]
   connect_bd_net -net orb_0_feature_score [get_bd_pins orb_0/feature_score] [get_bd_pins orb_descriptors_memory/score]
-  connect_bd_net -net proc_sys_reset_0_peripheral_aresetn [get_bd_pins axi_bram_ctrl_0/s_axi_aresetn] [get_bd_pins orb_descriptors_memory/s_axi_aresetn] [get_bd_pins proc_sys_reset_0/peripheral_aresetn] [get_bd_pins ps7_0_axi_periph/M03_ARESETN] [get_bd_pins ps7_0_axi_periph/M05_ARESETN] [get_bd_pins ps7_0_axi_periph/M06_ARESETN]
-  connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins axi_bram_ctrl_0/s_axi_aclk] [get_bd_pins axi_bram_ctrl_0_bram/clkb] [get_bd_pins axi_gpio_corner_thresh/s_axi_aclk] [get_bd_pins axi_gpio_reset_fast/s_axi_aclk] [get_bd_pins get_pix_0/clk] [get_bd_pins get_pix_0/pix_clk] [get_bd_pins orb_0/clk] [get_bd_pins orb_descriptors_memory/s_axi_aclk] [get_bd_pins proc_sys_reset_0/slowest_sync_clk] [get_bd_pins processing_system7_0/FCLK_CLK0] [get_bd_pins processing_system7_0/M_AXI_GP0_ACLK] [get_bd_pins processing_system7_0/S_AXI_HP0_ACLK] [get_bd_pins ps7_0_axi_periph/ACLK] [get_bd_pins ps7_0_axi_periph/M00_ACLK] [get_bd_pins ps7_0_axi_periph/M01_ACLK] [get_bd_pins ps7_0_axi_periph/M02_ACLK] [get_bd_pins ps7_0_axi_periph/M03_ACLK] [get_bd_pins ps7_0_axi_periph/M04_ACLK] [get_bd_pins ps7_0_axi_periph/M05_ACLK] [get_bd_pins ps7_0_axi_periph/M06_ACLK] [get_bd_pins ps7_0_axi_periph/S00_ACLK] [get_bd_pins rst_ps7_0_50M/slowest_sync_clk]
+  connect_bd_net -net orb_0_stat_busy_dropped [get_bd_pins orb_0/stat_busy_dropped] [get_bd_pins orb_counters_0/stat_busy_dropped]
+  connect_bd_net -net orb_0_stat_candidate [get_bd_pins orb_0/stat_candidate] [get_bd_pins orb_counters_0/stat_candidate]
+  connect_bd_net -net orb_0_stat_constructor_busy [get_bd_pins orb_0/stat_constructor_busy] [get_bd_pins orb_counters_0/stat_constructor_busy]
+  connect_bd_net -net orb_0_stat_fifo_dropped [get_bd_pins orb_0/stat_fifo_dropped] [get_bd_pins orb_counters_0/stat_fifo_dropped]
+  connect_bd_net -net orb_0_stat_fifo_full [get_bd_pins orb_0/stat_fifo_full] [get_bd_pins orb_counters_0/stat_fifo_full]
+  connect_bd_net -net orb_0_stat_fifo_level [get_bd_pins orb_0/stat_fifo_level] [get_bd_pins orb_counters_0/stat_fifo_level]
+  connect_bd_net -net orb_0_stat_survivor [get_bd_pins orb_0/stat_survivor] [get_bd_pins orb_counters_0/stat_survivor]
+  connect_bd_net -net proc_sys_reset_0_peripheral_aresetn [get_bd_pins axi_bram_ctrl_0/s_axi_aresetn] [get_bd_pins axi_bram_ctrl_counters/s_axi_aresetn] [get_bd_pins orb_descriptors_memory/s_axi_aresetn] [get_bd_pins proc_sys_reset_0/peripheral_aresetn] [get_bd_pins ps7_0_axi_periph/M03_ARESETN] [get_bd_pins ps7_0_axi_periph/M05_ARESETN] [get_bd_pins ps7_0_axi_periph/M06_ARESETN] [get_bd_pins ps7_0_axi_periph/M07_ARESETN] [get_bd_pins ps7_0_axi_periph/M08_ARESETN]
+  connect_bd_net -net processing_system7_0_FCLK_CLK0 [get_bd_pins axi_bram_ctrl_0/s_axi_aclk] [get_bd_pins axi_bram_ctrl_0_bram/clkb] [get_bd_pins axi_bram_ctrl_counters/s_axi_aclk] [get_bd_pins axi_gpio_corner_thresh/s_axi_aclk] [get_bd_pins axi_gpio_reset_fast/s_axi_aclk] [get_bd_pins get_pix_0/clk] [get_bd_pins get_pix_0/pix_clk] [get_bd_pins orb_0/clk] [get_bd_pins orb_counters_0/clk] [get_bd_pins orb_descriptors_memory/s_axi_aclk] [get_bd_pins proc_sys_reset_0/slowest_sync_clk] [get_bd_pins processing_system7_0/FCLK_CLK0] [get_bd_pins processing_system7_0/M_AXI_GP0_ACLK] [get_bd_pins processing_system7_0/S_AXI_HP0_ACLK] [get_bd_pins ps7_0_axi_periph/ACLK] [get_bd_pins ps7_0_axi_periph/M00_ACLK] [get_bd_pins ps7_0_axi_periph/M01_ACLK] [get_bd_pins ps7_0_axi_periph/M02_ACLK] [get_bd_pins ps7_0_axi_periph/M03_ACLK] [get_bd_pins ps7_0_axi_periph/M04_ACLK] [get_bd_pins ps7_0_axi_periph/M05_ACLK] [get_bd_pins ps7_0_axi_periph/M06_ACLK] [get_bd_pins ps7_0_axi_periph/M07_ACLK] [get_bd_pins ps7_0_axi_periph/M08_ACLK] [get_bd_pins ps7_0_axi_periph/S00_ACLK] [get_bd_pins rst_ps7_0_50M/slowest_sync_clk]
   connect_bd_net -net processing_system7_0_FCLK_RESET0_N [get_bd_pins proc_sys_reset_0/ext_reset_in] [get_bd_pins processing_system7_0/FCLK_RESET0_N] [get_bd_pins rst_ps7_0_50M/ext_reset_in]
   connect_bd_net -net rst_ps7_0_50M_peripheral_aresetn [get_bd_pins axi_gpio_corner_thresh/s_axi_aresetn] [get_bd_pins axi_gpio_reset_fast/s_axi_aresetn] [get_bd_pins ps7_0_axi_periph/ARESETN] [get_bd_pins ps7_0_axi_periph/M00_ARESETN] [get_bd_pins ps7_0_axi_periph/M01_ARESETN] [get_bd_pins ps7_0_axi_periph/M02_ARESETN] [get_bd_pins ps7_0_axi_periph/M04_ARESETN] [get_bd_pins ps7_0_axi_periph/S00_ARESETN] [get_bd_pins rst_ps7_0_50M/peripheral_aresetn]
   connect_bd_net -net scale_1 [get_bd_pins orb_0/feature_scale] [get_bd_pins orb_descriptors_memory/scale]
@@ -1385,6 +1483,8 @@ proc create_root_design { parentCell } {
   assign_bd_address -offset 0x42000000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_bram_ctrl_0/S_AXI/Mem0] -force
   assign_bd_address -offset 0x46000000 -range 0x00004000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs orb_descriptors_memory/axi_bram_ctrl_descriptor_0/S_AXI/Mem0] -force
   assign_bd_address -offset 0x44000000 -range 0x00004000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs orb_descriptors_memory/axi_bram_ctrl_descriptor_1/S_AXI/Mem0] -force
+  assign_bd_address -offset 0x4B000000 -range 0x00001000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_bram_ctrl_counters/S_AXI/Mem0] -force
+  assign_bd_address -offset 0x4A000000 -range 0x00008000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs orb_descriptors_memory/axi_bram_ctrl_match/S_AXI/Mem0] -force
   assign_bd_address -offset 0x48000000 -range 0x00001000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs orb_descriptors_memory/axi_bram_ctrl_descriptors_pos/S_AXI/Mem0] -force
   assign_bd_address -offset 0x40000000 -range 0x00001000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs orb_descriptors_memory/axi_bram_ctrl_descriptors_scr_angle/S_AXI/Mem0] -force
   assign_bd_address -offset 0x41230000 -range 0x00010000 -target_address_space [get_bd_addr_spaces processing_system7_0/Data] [get_bd_addr_segs axi_gpio_corner_thresh/S_AXI/Reg] -force
@@ -33,7 +33,8 @@ entity brief_construct is
         ORIENTATION_LINE_SIZE_MIDDLE: integer := 18;
         FEATURE_FIFO_SIZE: integer := 128;
         FEATURE_FIFO_ADDR_SIZE: integer := 7;
-        THETA_SIZE: natural := 3
+        THETA_SIZE: natural := 3;
+        NUM_CONSTRUCTORS: integer := 1
     );
     port (
         clk     : in std_logic;
@@ -54,7 +55,13 @@ entity brief_construct is
         pos_descriptor_y : out std_logic_vector (10 downto 0);
         pos_descriptor_x : out std_logic_vector (10 downto 0);
         descriptor_score : out std_logic_vector (11 downto 0);
-        descriptor_angle : out std_logic_vector (THETA_SIZE-1+2 downto 0)
+        descriptor_angle : out std_logic_vector (THETA_SIZE-1+2 downto 0);
+        -- Events for orb_counters
+        fifo_full : out std_logic;
+        fifo_dropped : out std_logic;
+        fifo_level : out std_logic_vector(FEATURE_FIFO_ADDR_SIZE-1 downto 0);
+        busy_dropped : out std_logic;
+        constructor_busy : out std_logic -- Every constructor is busy
     );
 end brief_construct;
 
@@ -64,8 +71,6 @@ architecture STRUCTURE of brief_construct is
   signal s_pos_orientation_y, s_pos_orientation_x : std_logic_vector(10 downto 0);
   signal s_quadrant : std_logic_vector(1 downto 0);
   signal s_theta : std_logic_vector(THETA_SIZE-1 downto 0);
-  signal descript_quadrant : std_logic_vector(1 downto 0);
-  signal descript_theta : std_logic_vector(THETA_SIZE-1 downto 0);
   signal s_valid_orientation : std_logic;
   signal s_descriptor : std_logic_vector(255 downto 0);
   signal s_pop_feature : std_logic;
@@ -73,11 +78,25 @@ architecture STRUCTURE of brief_construct is
   signal s_pop_feature_score : std_logic_vector(feature_score'high downto 0);
   signal s_constructor_ready : std_logic;
   signal s_start_constructor : std_logic;
-  constant brief_delay : integer := 47;
-  type feature_angle_delay_buf_type is array (0 to (brief_delay+2-1)) of std_logic_vector (descriptor_angle'high downto 0);
-  type feature_score_delay_buf_type is array (0 to (brief_delay-1)) of std_logic_vector (feature_score'high downto 0);
-  signal feature_score_delay_buf : feature_score_delay_buf_type := (others => (others=> '0'));
-  signal feature_angle_delay_buf : feature_angle_delay_buf_type := (others => (others=> '0'));
+
+  -- One entry per descriptor constructor
+  type constructor_descriptor_array is array (0 to NUM_CONSTRUCTORS-1) of std_logic_vector(255 downto 0);
+  type constructor_pos_array is array (0 to NUM_CONSTRUCTORS-1) of std_logic_vector(10 downto 0);
+  type constructor_score_array is array (0 to NUM_CONSTRUCTORS-1) of std_logic_vector(feature_score'high downto 0);
+  type constructor_quadrant_array is array (0 to NUM_CONSTRUCTORS-1) of std_logic_vector(1 downto 0);
+  type constructor_theta_array is array (0 to NUM_CONSTRUCTORS-1) of std_logic_vector(THETA_SIZE-1 downto 0);
+  signal s_constructors_ready : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0);
+  signal s_start_constr : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0);
+  signal s_descriptors_ready : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0);
+  signal s_constructors_busy : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0);
+  signal s_constr_descriptor : constructor_descriptor_array;
+  signal s_constr_pos_y : constructor_pos_array;
+  signal s_constr_pos_x : constructor_pos_array;
+  signal s_constr_score : constructor_score_array := (others => (others => '0'));
+  signal s_constr_quadrant : constructor_quadrant_array;
+  signal s_constr_theta : constructor_theta_array;
+  constant NONE_READY : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0) := (others => '0');
+  constant ALL_BUSY : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0) := (others => '1');
 
 begin
     -- Holds the features detected by FAST in a FIFO waiting for the orientation to arrive to the same coordinate
@@ -98,18 +117,23 @@ begin
             pop_feature => s_pop_feature,
             pop_pos_feature_y => s_pop_pos_feature_y,
             pop_pos_feature_x => s_pop_pos_feature_x,
-            pop_feature_score => s_pop_feature_score
+            pop_feature_score => s_pop_feature_score,
+            full => fifo_full,
+            dropped => fifo_dropped,
+            level => fifo_level
         );
-    feature_score_delay: process(clk)
+    -- The FIFO head is the started feature until the pop takes effect, so
+    -- its score is kept with the constructor that builds its descriptor
+    constructor_score: process(clk)
     begin
         if (rising_edge(clk)) then
-            feature_score_delay_buf(0) <= s_pop_feature_score;
-            for i in feature_score_delay_buf'high downto 1 loop
-                feature_score_delay_buf(i) <= feature_score_delay_buf(i-1);
+            for c in 0 to NUM_CONSTRUCTORS-1 loop
+                if s_start_constr(c) = '1' then
+                    s_constr_score(c) <= s_pop_feature_score;
+                end if;
             end loop;
-            descriptor_score <= feature_score_delay_buf(feature_score_delay_buf'high);
         end if;
-    end process feature_score_delay;
+    end process constructor_score;
     -- Compares feature FIFO head and Orienntation to command BRIEF constructionn
     fast_brief_coordinator : entity work.fast_brief_coordinator
         generic map (
@@ -134,7 +158,8 @@ begin
             pos_orientation_x => s_pos_orientation_x,
             constructor_available => s_constructor_ready,
             pop_feature => s_pop_feature,
-            start_constructor => s_start_constructor
+            start_constructor => s_start_constructor,
+            dropped => busy_dropped
         );
     
     orientation_32_generate : if THETA_SIZE=5 generate
@@ -254,16 +279,22 @@ begin
                 pix_out => s_blurred_pixels
             );
     end generate;
-    feature_angle_delay: process(clk)
-    begin
-        if (rising_edge(clk)) then
-            --feature_angle_delay_buf(0) <= s_quadrant&s_theta;
-            --for i in feature_angle_delay_buf'high downto 1 loop
-            --    feature_angle_delay_buf(i) <= feature_angle_delay_buf(i-1);
-            --end loop;
-            descriptor_angle <= descript_quadrant&descript_theta;
-        end if;
-    end process feature_angle_delay;
+    -- Starts go to the constructors round-robin, all of them fed the same
+    -- blurred pixels and orientation
+    constructor_dispatcher : entity work.constructor_dispatcher
+        generic map (
+            NUM_CONSTRUCTORS => NUM_CONSTRUCTORS
+        )
+        port map (
+            clk => clk,
+            reset_n => reset_n,
+            start_constructor => s_start_constructor,
+            constructors_ready => s_constructors_ready,
+            constructor_available => s_constructor_ready,
+            start_constr => s_start_constr
+        );
+
+    constructors : for c in 0 to NUM_CONSTRUCTORS-1 generate
     descriptor_construct : entity work.descriptor_construct
       generic map (
         ELEMENT_SIZE => ELEMENT_SIZE,
@@ -289,15 +320,41 @@ begin
         theta => s_theta,
         valid_pix_in => s_valid_blurred_pixels,
         pix_in => s_blurred_pixels,
-        descriptor => descriptor,
-        pos_descriptor_y => pos_descriptor_y,
-        pos_descriptor_x => pos_descriptor_x,
-        start_constr => s_start_constructor,
-        constructor_ready => s_constructor_ready,
-        descriptor_ready => descriptor_ready,
-        quadrant_o => descript_quadrant,
-        theta_o => descript_theta
+        descriptor => s_constr_descriptor(c),
+        pos_descriptor_y => s_constr_pos_y(c),
+        pos_descriptor_x => s_constr_pos_x(c),
+        start_constr => s_start_constr(c),
+        constructor_ready => s_constructors_ready(c),
+        descriptor_ready => s_descriptors_ready(c),
+        quadrant_o => s_constr_quadrant(c),
+        theta_o => s_constr_theta(c),
+        constructor_busy => s_constructors_busy(c)
       );
+    end generate;
+
+    -- Every constructor takes the same number of cycles and starts are at
+    -- least three cycles apart, so descriptors finish one at a time and in
+    -- the order their features were popped. The output is the constructor
+    -- whose descriptor is ready; quadrant_o and theta_o hold from the cycle
+    -- before until the constructor is started again.
+    merge_descriptors: process(s_descriptors_ready, s_constr_descriptor, s_constr_pos_y, s_constr_pos_x, s_constr_score, s_constr_quadrant, s_constr_theta)
+        variable selected : integer range 0 to NUM_CONSTRUCTORS-1;
+    begin
+        selected := 0;
+        for c in NUM_CONSTRUCTORS-1 downto 0 loop
+            if s_descriptors_ready(c) = '1' then
+                selected := c;
+            end if;
+        end loop;
+        descriptor <= s_constr_descriptor(selected);
+        pos_descriptor_y <= s_constr_pos_y(selected);
+        pos_descriptor_x <= s_constr_pos_x(selected);
+        descriptor_score <= s_constr_score(selected);
+        descriptor_angle <= s_constr_quadrant(selected) & s_constr_theta(selected);
+    end process merge_descriptors;
+
+    descriptor_ready <= '0' when s_descriptors_ready = NONE_READY else '1';
+    constructor_busy <= '1' when s_constructors_busy = ALL_BUSY else '0';
 
     valid_orientation <= s_valid_blurred_pixels;
     pos_orientation_y <= s_pos_orientation_y;
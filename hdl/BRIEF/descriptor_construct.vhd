@@ -51,7 +51,8 @@ entity descriptor_construct is
         pos_descriptor_x : out std_logic_vector (10 downto 0);
         constructor_ready : out std_logic;
         quadrant_o : out std_logic_vector(1 downto 0);
-        theta_o : out std_logic_vector(THETA_SIZE-1 downto 0)
+        theta_o : out std_logic_vector(THETA_SIZE-1 downto 0);
+        constructor_busy : out std_logic
     );
 end descriptor_construct;
 
@@ -505,7 +506,8 @@ begin
         start_constr => start_constr,
         constructor_finished => constructor_finished,
         pixel_toggle => pixel_toggle,
-        descriptor_ready => descriptor_ready
+        descriptor_ready => descriptor_ready,
+        busy => constructor_busy
     );
 
     update_trig_values: process(clk)
@@ -32,7 +32,10 @@ ENTITY feature_fifo IS
         pop_feature : IN STD_LOGIC;
         pop_pos_feature_y : OUT STD_LOGIC_VECTOR (COORDINATE_SIZE - 1 DOWNTO 0);
         pop_pos_feature_x : OUT STD_LOGIC_VECTOR (COORDINATE_SIZE - 1 DOWNTO 0);
-        pop_feature_score : OUT STD_LOGIC_VECTOR (SCORE_SIZE - 1 DOWNTO 0)
+        pop_feature_score : OUT STD_LOGIC_VECTOR (SCORE_SIZE - 1 DOWNTO 0);
+        full : OUT STD_LOGIC;
+        dropped : OUT STD_LOGIC; -- A new feature found the FIFO full
+        level : OUT STD_LOGIC_VECTOR (ADDR_SIZE - 1 DOWNTO 0) -- Features queued
     );
 END feature_fifo;
 
@@ -45,13 +48,20 @@ ARCHITECTURE Behavioral OF feature_fifo IS
     SIGNAL push_ptr : unsigned((ADDR_SIZE - 1) DOWNTO 0) := (OTHERS => '0');
     SIGNAL pop_ptr : unsigned((ADDR_SIZE - 1) DOWNTO 0) := (OTHERS => '0');
     SIGNAL previous_push_feature : STD_LOGIC := '0';
+    SIGNAL s_full : STD_LOGIC;
 
 BEGIN
+    s_full <= '0' WHEN (push_ptr >= pop_ptr OR push_ptr <= pop_ptr-2) ELSE '1';
+    full <= s_full AND rst_n;
+    dropped <= push_feature AND NOT previous_push_feature AND s_full AND rst_n;
+    -- At most FIFO_SIZE - 1, so it never wraps
+    level <= STD_LOGIC_VECTOR(push_ptr - pop_ptr) WHEN rst_n = '1' ELSE (OTHERS => '0');
+
     PROCESS (clk)
     BEGIN
         IF rising_edge(clk) THEN
             IF rst_n = '1' THEN
-                IF (push_feature = '1' AND previous_push_feature = '0' AND (push_ptr >= pop_ptr OR push_ptr <= pop_ptr-2)) THEN
+                IF (push_feature = '1' AND previous_push_feature = '0' AND s_full = '0') THEN
                     pos_y_fifo(to_integer(push_ptr)) <= push_pos_feature_y;
                     pos_x_fifo(to_integer(push_ptr)) <= push_pos_feature_x;
                     score_fifo(to_integer(push_ptr)) <= push_feature_score;
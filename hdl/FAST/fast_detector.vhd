@@ -44,7 +44,11 @@ entity fast_detector is
         is_feature : out std_logic;
         pos_feature_y : out std_logic_vector (10 downto 0);
         pos_feature_x : out std_logic_vector (10 downto 0);
-        feature_score : out std_logic_vector((ELEMENT_SIZE+3) downto 0)
+        feature_score : out std_logic_vector((ELEMENT_SIZE+3) downto 0);
+        -- One cycle per evaluated pixel that is a corner, before and after
+        -- the NMS, for orb_counters
+        is_candidate : out std_logic;
+        is_survivor : out std_logic
     );
 end fast_detector;
 
@@ -180,6 +184,11 @@ begin
     end process;
     ------------------------
 
+    -- is_corner and internal_is_feature only advance with active, so each
+    -- value is counted once
+    is_candidate <= is_corner and active;
+    is_survivor <= internal_is_feature and active;
+
     line_buffers_detector: process(clk)
     begin
         if (rising_edge(clk)) then
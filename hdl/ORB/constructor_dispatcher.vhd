@@ -0,0 +1,76 @@
+----------------------------------------------------------------------------------
+-- Company: INESC-ID
+-- Engineer: Andre Costa [andre.mestre.costa@tecnico.ulisboa.pt]
+--
+-- Create Date: 10/17/2026 08:02:14 AM
+-- Module Name: constructor_dispatcher - rtl
+-- Project Name: ORB-Accelerator
+-- Target Devices: NA
+-- Tool Versions: NA
+-- Description: Hands the starts of fast_brief_coordinator to NUM_CONSTRUCTORS
+--              descriptor constructors of one level, round-robin: a start
+--              goes to the first ready constructor from the one after the
+--              last started. The coordinator sees a constructor available
+--              while any is ready.
+--
+--              A started constructor drops its ready one cycle later and
+--              the coordinator starts at most every three cycles, so the
+--              ready vector never offers a constructor already started.
+--
+----------------------------------------------------------------------------------
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+
+entity constructor_dispatcher is
+    generic (
+        NUM_CONSTRUCTORS : integer := 1
+    );
+    port (
+        clk : in std_logic;
+        reset_n : in std_logic;
+        start_constructor : in std_logic;
+        constructors_ready : in std_logic_vector(NUM_CONSTRUCTORS-1 downto 0);
+        constructor_available : out std_logic;
+        start_constr : out std_logic_vector(NUM_CONSTRUCTORS-1 downto 0)
+    );
+end constructor_dispatcher;
+
+architecture rtl of constructor_dispatcher is
+    constant NONE_READY : std_logic_vector(NUM_CONSTRUCTORS-1 downto 0) := (others => '0');
+    signal s_next : integer range 0 to NUM_CONSTRUCTORS-1 := 0;
+    signal s_target : integer range 0 to NUM_CONSTRUCTORS-1;
+begin
+
+    constructor_available <= '0' when constructors_ready = NONE_READY else '1';
+
+    -- First ready constructor from s_next, wrapping around
+    select_target: process(constructors_ready, s_next)
+        variable candidate : integer range 0 to NUM_CONSTRUCTORS-1;
+    begin
+        s_target <= s_next;
+        for i in NUM_CONSTRUCTORS-1 downto 0 loop
+            candidate := (s_next + i) mod NUM_CONSTRUCTORS;
+            if constructors_ready(candidate) = '1' then
+                s_target <= candidate;
+            end if;
+        end loop;
+    end process select_target;
+
+    start_outputs: for c in 0 to NUM_CONSTRUCTORS-1 generate
+        start_constr(c) <= start_constructor when s_target = c else '0';
+    end generate;
+
+    round_robin: process(clk)
+    begin
+        if rising_edge(clk) then
+            if reset_n = '0' then
+                s_next <= 0;
+            elsif start_constructor = '1' then
+                s_next <= (s_target + 1) mod NUM_CONSTRUCTORS;
+            end if;
+        end if;
+    end process round_robin;
+
+end rtl;
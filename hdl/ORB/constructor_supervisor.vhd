@@ -29,7 +29,9 @@ entity constructor_supervisor is
         start_constr : in std_logic;
         constructor_finished : inout std_logic;
         pixel_toggle : out std_logic;
-        descriptor_ready : out std_logic
+        descriptor_ready : out std_logic;
+        -- A descriptor is being built, for orb_counters
+        busy : out std_logic
     );
 end constructor_supervisor;
 
@@ -48,6 +50,8 @@ architecture rtl of constructor_supervisor is
     signal pixel_toggle_s : std_logic := '0';
 
 begin
+    busy <= not constructor_finished;
+
     constructor_supervisor: process(clk)
     begin
         if (rising_edge(clk)) then
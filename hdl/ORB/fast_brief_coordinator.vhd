@@ -38,7 +38,9 @@ entity fast_brief_coordinator is
         pos_orientation_x : in std_logic_vector(10 downto 0);
         constructor_available : in std_logic;
         pop_feature : out std_logic;
-        start_constructor : out std_logic
+        start_constructor : out std_logic;
+        -- The orientation reached the feature while the constructor was busy
+        dropped : out std_logic
     );
 end fast_brief_coordinator;
 
@@ -60,11 +62,14 @@ begin
     begin
         if (rising_edge(clk)) then
             if (rst_n='1') then
-                if ((pos_feature_x=pos_orientation_x and pos_feature_y=pos_orientation_y) and not(pos_feature_x = "00000000000") and not(pos_feature_y = "00000000000")) then
+                -- The head shows a popped feature for two more cycles, which must not start a second constructor
+                if ((pos_feature_x=pos_orientation_x and pos_feature_y=pos_orientation_y) and not(pos_feature_x = "00000000000") and not(pos_feature_y = "00000000000") and s_pop_feature = '0' and s_pop_feature_delay = '0') then
                     if (constructor_available='1') then
                         start_constructor <= '1';
+                        dropped <= '0';
                     else
                         start_constructor <= '0';
+                        dropped <= '1';
                     end if;
                     pop_feature <= '1';
                     s_pop_feature <= '1';
@@ -87,6 +92,7 @@ begin
                         end if;
                     end if;
                     start_constructor <= '0';
+                    dropped <= '0';
                 end if;
                 s_pop_feature_delay <= s_pop_feature;
             else
@@ -94,6 +100,7 @@ begin
                 s_pop_feature <= '0';
                 s_pop_feature_delay <= '0';
                 start_constructor <= '0';
+                dropped <= '0';
             end if;
         end if;
         
@@ -7,7 +7,11 @@
 -- Project Name: ORB-Accelerator
 -- Target Devices: NA
 -- Tool Versions: NA
--- Description: 
+-- Description: ORB pyramid of ACONF_NUM_SCALES levels, each one a FAST
+--              detector and a BRIEF constructor fed by a cascade of 2x2
+--              scalar stages. The descriptors of all levels are merged into
+--              one output, with positions in level 0 pixels and the level in
+--              feature_scale.
 -- 
 ----------------------------------------------------------------------------------
 library IEEE;
@@ -25,7 +29,8 @@ entity orb is
         ACONF_FEATURE_FIFO_ADDR_SIZE: integer := 7;
         ACONF_DESCRIPTOR_FIFO_SIZE: integer := 128;
         ACONF_DESCRIPTOR_FIFO_ADDR_SIZE: integer := 7;
-        ACONF_THETA_SIZE: natural := 3
+        ACONF_THETA_SIZE: natural := 3;
+        ACONF_NUM_CONSTRUCTORS: integer := 1 -- Descriptor constructors per level
     );
     Port ( 
         clk : in STD_LOGIC;
@@ -40,7 +45,17 @@ entity orb is
         feature_pos_x : out std_logic_vector (10 downto 0);
         feature_score : out std_logic_vector (11 downto 0);
         feature_angle : out std_logic_vector (ACONF_THETA_SIZE-1+2 downto 0);
-        feature_scale : out std_logic_vector (0 downto 0)
+        feature_scale : out std_logic_vector (2 downto 0);
+        -- Events of each level for orb_counters, bit s for level s, unused
+        -- levels '0'
+        stat_candidate : out std_logic_vector (7 downto 0);
+        stat_survivor : out std_logic_vector (7 downto 0);
+        stat_fifo_full : out std_logic_vector (7 downto 0);
+        stat_fifo_dropped : out std_logic_vector (7 downto 0);
+        stat_busy_dropped : out std_logic_vector (7 downto 0);
+        stat_constructor_busy : out std_logic_vector (7 downto 0);
+        -- Features queued in the feature FIFO of level s, bits 16s+15 to 16s
+        stat_fifo_level : out std_logic_vector (127 downto 0)
     );
 end orb;
 
@@ -93,17 +108,35 @@ architecture rtl of orb is
     signal s_pos_descriptor_y : pos_descriptor_y_array := (others => (others => '0'));
     signal s_descriptor_score : descriptor_score_array := (others => (others => '0'));
     signal s_descriptor_angle : descriptor_angle_array := (others => (others => '0'));
-    
-    signal descriptors_ready : std_logic_vector(2 downto 0) := (others => '0');
-    signal descriptor_delayed : std_logic := '0';
-    signal descriptor_ready_delay : std_logic := '0';
-    signal descriptor_delay : std_logic_vector(255 downto 0) := (others => '0');
-    signal pos_descriptor_x_delay : std_logic_vector(10 downto 0) := (others => '0');
-    signal pos_descriptor_y_delay : std_logic_vector(10 downto 0) := (others => '0');
-    signal descriptor_score_delay : std_logic_vector(11 downto 0) := (others => '0');
-    signal descriptor_angle_delay : std_logic_vector(ACONF_THETA_SIZE-1+2  downto 0) := (others => '0');
+    signal s_candidate : std_logic_vector(7 downto 0) := (others => '0');
+    signal s_survivor : std_logic_vector(7 downto 0) := (others => '0');
+    signal s_fifo_full : std_logic_vector(7 downto 0) := (others => '0');
+    signal s_fifo_dropped : std_logic_vector(7 downto 0) := (others => '0');
+    signal s_busy_dropped : std_logic_vector(7 downto 0) := (others => '0');
+    signal s_constructor_busy : std_logic_vector(7 downto 0) := (others => '0');
+    signal s_fifo_level : std_logic_vector(127 downto 0) := (others => '0');
+
+    -- Descriptors that collided with another level, waiting for the output
+    signal s_pending : std_logic_vector(ACONF_NUM_SCALES-1 downto 0) := (others => '0');
+    signal s_hold_descriptor : feature_descriptor_array := (others => (others => '0'));
+    signal s_hold_pos_x : pos_descriptor_x_array := (others => (others => '0'));
+    signal s_hold_pos_y : pos_descriptor_y_array := (others => (others => '0'));
+    signal s_hold_score : descriptor_score_array := (others => (others => '0'));
+    signal s_hold_angle : descriptor_angle_array := (others => (others => '0'));
+
+    -- Position of a level in level 0 pixels
+    function to_level0(pos : std_logic_vector(10 downto 0); scale : natural)
+    return std_logic_vector is
+    begin
+        return std_logic_vector(shift_left(unsigned(pos), scale));
+    end to_level0;
 begin
-    
+
+    assert ACONF_NUM_SCALES >= 1 and ACONF_NUM_SCALES <= 2**feature_scale'length
+        report "ACONF_NUM_SCALES must fit feature_scale" severity failure;
+    assert ACONF_NUM_LINES/(2**(ACONF_NUM_SCALES-1)) > ORIENTATION_NUM_LINES+GAUSSIAN_NUM_LINES
+        report "The last level is too small for the orientation window" severity warning;
+
     s_pix_in(0) <= pix_in;
     s_push(0)   <= push;
     
@@ -152,7 +185,9 @@ begin
                 is_feature => is_feature(scale),
                 pos_feature_y => pos_feature_y(scale),
                 pos_feature_x => pos_feature_x(scale),
-                feature_score => s_feature_score(scale)
+                feature_score => s_feature_score(scale),
+                is_candidate => s_candidate(scale),
+                is_survivor => s_survivor(scale)
             );
 
         BRIEF: entity work.brief_construct
@@ -170,7 +205,8 @@ begin
                 ORIENTATION_NUM_LINES_MIDDLE => ORIENTATION_NUM_LINES_MIDDLE,
                 ORIENTATION_LINE_SIZE => ORIENTATION_LINE_SIZE,
                 ORIENTATION_LINE_SIZE_MIDDLE => ORIENTATION_LINE_SIZE_MIDDLE,
-                THETA_SIZE => ACONF_THETA_SIZE
+                THETA_SIZE => ACONF_THETA_SIZE,
+                NUM_CONSTRUCTORS => ACONF_NUM_CONSTRUCTORS
             )
             port map (
                 clk => clk,
@@ -186,72 +222,87 @@ begin
                 pos_descriptor_y => s_pos_descriptor_y(scale),
                 pos_descriptor_x => s_pos_descriptor_x(scale),
                 descriptor_score => s_descriptor_score(scale),
-                descriptor_angle => s_descriptor_angle(scale)
+                descriptor_angle => s_descriptor_angle(scale),
+                fifo_full => s_fifo_full(scale),
+                fifo_dropped => s_fifo_dropped(scale),
+                fifo_level => s_fifo_level(16*scale+ACONF_FEATURE_FIFO_ADDR_SIZE-1 downto 16*scale),
+                busy_dropped => s_busy_dropped(scale),
+                constructor_busy => s_constructor_busy(scale)
             );
 
     end generate;
 
-    -- TODO: The following lines will have to be changed should more scales be needed
-    
-    descriptors_ready <= descriptor_delayed&s_descriptor_ready(1)&s_descriptor_ready(0);
+    stat_candidate <= s_candidate;
+    stat_survivor <= s_survivor;
+    stat_fifo_full <= s_fifo_full;
+    stat_fifo_dropped <= s_fifo_dropped;
+    stat_busy_dropped <= s_busy_dropped;
+    stat_constructor_busy <= s_constructor_busy;
+    stat_fifo_level <= s_fifo_level;
 
+    -- Levels share the output: a descriptor that collides with another one
+    -- is held and sent in a later cycle, held ones first, lowest level first.
+    -- A level produces at most one descriptor every three cycles, however
+    -- many constructors it has, so one held entry per level suffices while
+    -- fewer than four levels collide.
     descriptor_output: process(clk)
+        variable selected : integer range -1 to ACONF_NUM_SCALES-1;
+        variable held : boolean;
     begin
         if rising_edge(clk) then
-            case descriptors_ready is
-                when "100" =>
-                    feature_ready <= descriptor_ready_delay;
-                    feature_descriptor <= descriptor_delay;
-                    feature_pos_y <= pos_descriptor_x_delay;
-                    feature_pos_x <= pos_descriptor_y_delay;
-                    feature_score <= descriptor_score_delay;
-                    feature_angle <= descriptor_angle_delay;
-                    feature_scale <= "1";
-                    descriptor_delayed <= '0';
-                when "001" =>
-                    feature_ready <= s_descriptor_ready(0);
-                    feature_descriptor <= s_descriptor(0);
-                    feature_pos_y <= s_pos_descriptor_y(0);
-                    feature_pos_x <= s_pos_descriptor_x(0);
-                    feature_score <= s_descriptor_score(0);
-                    feature_angle <= s_descriptor_angle(0);
-                    feature_scale <= "0";
-                    descriptor_delayed <= '0';
-                when "010" =>
-                    feature_ready <= s_descriptor_ready(1);
-                    feature_descriptor <= s_descriptor(1);
-                    feature_pos_y <= s_pos_descriptor_y(1)(s_pos_descriptor_y(1)'high-1 downto 0)&'0';
-                    feature_pos_x <= s_pos_descriptor_x(1)(s_pos_descriptor_x(1)'high-1 downto 0)&'0';
-                    feature_score <= s_descriptor_score(1);
-                    feature_angle <= s_descriptor_angle(1);
-                    feature_scale <= "1";
-                    descriptor_delayed <= '0';
-                when "011" =>
-                    feature_ready <= s_descriptor_ready(0);
-                    feature_descriptor <= s_descriptor(0);
-                    feature_pos_y <= s_pos_descriptor_y(0);
-                    feature_pos_x <= s_pos_descriptor_x(0);
-                    feature_score <= s_descriptor_score(0);
-                    feature_angle <= s_descriptor_angle(0);
-                    feature_scale <= "0";
-                    descriptor_delayed <= '1';
-                when others =>
-                    feature_ready <= '0';
-                    feature_descriptor <= (others => '0');
-                    feature_pos_y <= (others => '0');
-                    feature_pos_x <= (others => '0');
-                    feature_score <= (others => '0');
-                    feature_angle <= (others => '0');
-                    feature_scale <= (others => '0');
-                    descriptor_delayed <= '0';
-            end case;
+            selected := -1;
+            held := false;
+            for scale in ACONF_NUM_SCALES-1 downto 0 loop
+                if s_pending(scale) = '1' then
+                    selected := scale;
+                    held := true;
+                end if;
+            end loop;
+            if not held then
+                for scale in ACONF_NUM_SCALES-1 downto 0 loop
+                    if s_descriptor_ready(scale) = '1' then
+                        selected := scale;
+                    end if;
+                end loop;
+            end if;
+
+            if selected < 0 then
+                feature_ready <= '0';
+                feature_descriptor <= (others => '0');
+                feature_pos_y <= (others => '0');
+                feature_pos_x <= (others => '0');
+                feature_score <= (others => '0');
+                feature_angle <= (others => '0');
+                feature_scale <= (others => '0');
+            elsif held then
+                feature_ready <= '1';
+                feature_descriptor <= s_hold_descriptor(selected);
+                feature_pos_y <= s_hold_pos_y(selected);
+                feature_pos_x <= s_hold_pos_x(selected);
+                feature_score <= s_hold_score(selected);
+                feature_angle <= s_hold_angle(selected);
+                feature_scale <= std_logic_vector(to_unsigned(selected, feature_scale'length));
+                s_pending(selected) <= '0';
+            else
+                feature_ready <= '1';
+                feature_descriptor <= s_descriptor(selected);
+                feature_pos_y <= to_level0(s_pos_descriptor_y(selected), selected);
+                feature_pos_x <= to_level0(s_pos_descriptor_x(selected), selected);
+                feature_score <= s_descriptor_score(selected);
+                feature_angle <= s_descriptor_angle(selected);
+                feature_scale <= std_logic_vector(to_unsigned(selected, feature_scale'length));
+            end if;
 
-            descriptor_ready_delay <= s_descriptor_ready(1); 
-            descriptor_delay       <= s_descriptor(1); 
-            pos_descriptor_x_delay <= s_pos_descriptor_y(1)(s_pos_descriptor_y(1)'high-1 downto 0)&'0'; 
-            pos_descriptor_y_delay <= s_pos_descriptor_x(1)(s_pos_descriptor_x(1)'high-1 downto 0)&'0'; 
-            descriptor_score_delay <= s_descriptor_score(1); 
-            descriptor_angle_delay <= s_descriptor_angle(1); 
+            for scale in 0 to ACONF_NUM_SCALES-1 loop
+                if s_descriptor_ready(scale) = '1' and (held or selected /= scale) then
+                    s_pending(scale) <= '1';
+                    s_hold_descriptor(scale) <= s_descriptor(scale);
+                    s_hold_pos_y(scale) <= to_level0(s_pos_descriptor_y(scale), scale);
+                    s_hold_pos_x(scale) <= to_level0(s_pos_descriptor_x(scale), scale);
+                    s_hold_score(scale) <= s_descriptor_score(scale);
+                    s_hold_angle(scale) <= s_descriptor_angle(scale);
+                end if;
+            end loop;
         end if;
     end process descriptor_output;
 
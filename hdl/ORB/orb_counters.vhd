@@ -0,0 +1,165 @@
+----------------------------------------------------------------------------------
+-- Company: INESC-ID
+-- Engineer: Andre Costa [andre.mestre.costa@tecnico.ulisboa.pt]
+--
+-- Create Date: 10/17/2026 05:42:37 PM
+-- Module Name: orb_counters - rtl
+-- Project Name: ORB-Accelerator
+-- Target Devices: NA
+-- Tool Versions: NA
+-- Description: Event counters of a frame, read by the host to tell whether
+--              a slow frame waited on the host, the bus or the fabric.
+--              The stat_* vectors of orb hold one bit per level and each
+--              counter adds the bits set in a cycle, so the level counts
+--              are summed. All counters and stamps are cleared while rst_n
+--              is low, i.e. at the start of every frame, and are 32 bits
+--              wide, wrapping after 42 s at 100 MHz.
+--
+--              The host window (BRAM port of an AXI BRAM controller, same
+--              clock as clk, one cycle read latency, read-only), in 32-bit
+--              words:
+--                0   pixels pushed into level 0
+--                1   FAST candidates, corners before the NMS
+--                2   NMS survivors, pushed to the feature FIFOs
+--                3   descriptors out of orb (feature_ready)
+--                4   cycles a feature FIFO was full, per level
+--                5   features dropped on a full FIFO
+--                6   features dropped on a busy constructor
+--                7   cycles every constructor of a level was busy, per level
+--                8   cycle of the first pixel
+--                9   cycle of the last pixel
+--                10  cycle of the last descriptor
+--                11  cycles since rst_n went high
+--                12+s  most features queued in the FIFO of level s
+--                20+s  features of level s dropped on a full FIFO
+--                28+s  features of level s dropped on a busy constructor
+--              Stamps are in the cycles of word 11, 0 until the event.
+--              Words 12 to 35 cover 8 levels, those past the pyramid stay 0.
+--
+----------------------------------------------------------------------------------
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+
+entity orb_counters is
+    Port (
+        clk : in STD_LOGIC;
+        rst_n : in STD_LOGIC;
+        push : in STD_LOGIC;
+        feature_ready : in STD_LOGIC;
+        stat_candidate : in STD_LOGIC_VECTOR(7 downto 0);
+        stat_survivor : in STD_LOGIC_VECTOR(7 downto 0);
+        stat_fifo_full : in STD_LOGIC_VECTOR(7 downto 0);
+        stat_fifo_dropped : in STD_LOGIC_VECTOR(7 downto 0);
+        stat_busy_dropped : in STD_LOGIC_VECTOR(7 downto 0);
+        stat_constructor_busy : in STD_LOGIC_VECTOR(7 downto 0);
+        stat_fifo_level : in STD_LOGIC_VECTOR(127 downto 0);
+        bram_clk : in STD_LOGIC;
+        bram_rst : in STD_LOGIC;
+        bram_en : in STD_LOGIC;
+        bram_we : in STD_LOGIC_VECTOR(3 downto 0);
+        bram_addr : in STD_LOGIC_VECTOR(11 downto 0);
+        bram_din : in STD_LOGIC_VECTOR(31 downto 0);
+        bram_dout : out STD_LOGIC_VECTOR(31 downto 0)
+    );
+end orb_counters;
+
+architecture rtl of orb_counters is
+    ATTRIBUTE X_INTERFACE_INFO : STRING;
+    ATTRIBUTE X_INTERFACE_INFO of bram_clk: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA CLK";
+    ATTRIBUTE X_INTERFACE_INFO of bram_rst: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA RST";
+    ATTRIBUTE X_INTERFACE_INFO of bram_en: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA EN";
+    ATTRIBUTE X_INTERFACE_INFO of bram_we: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA WE";
+    ATTRIBUTE X_INTERFACE_INFO of bram_addr: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA ADDR";
+    ATTRIBUTE X_INTERFACE_INFO of bram_din: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA DIN";
+    ATTRIBUTE X_INTERFACE_INFO of bram_dout: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA DOUT";
+
+    constant NUM_WORDS : integer := 36;
+    constant HIGH_WATER_WORD : integer := 12;
+    constant FIFO_DROPPED_WORD : integer := 20;
+    constant BUSY_DROPPED_WORD : integer := 28;
+
+    subtype word_type is unsigned(31 downto 0);
+    type word_array is array (0 to NUM_WORDS-1) of word_type;
+
+    signal s_words : word_array := (others => (others => '0'));
+    signal s_cycles : word_type := (others => '0');
+    signal s_first_seen : std_logic := '0';
+
+    -- Bits set in a level vector, at most 8
+    function bits_set(v : std_logic_vector(7 downto 0)) return word_type is
+        variable count : integer range 0 to 8;
+    begin
+        count := 0;
+        for i in v'range loop
+            if v(i) = '1' then
+                count := count + 1;
+            end if;
+        end loop;
+        return to_unsigned(count, 32);
+    end bits_set;
+begin
+
+    count_events: process(clk)
+    begin
+        if rising_edge(clk) then
+            if rst_n = '0' then
+                s_words <= (others => (others => '0'));
+                s_cycles <= (others => '0');
+                s_first_seen <= '0';
+            else
+                s_cycles <= s_cycles + 1;
+                if push = '1' then
+                    s_words(0) <= s_words(0) + 1;
+                    s_words(9) <= s_cycles;
+                    if s_first_seen = '0' then
+                        s_words(8) <= s_cycles;
+                        s_first_seen <= '1';
+                    end if;
+                end if;
+                s_words(1) <= s_words(1) + bits_set(stat_candidate);
+                s_words(2) <= s_words(2) + bits_set(stat_survivor);
+                if feature_ready = '1' then
+                    s_words(3) <= s_words(3) + 1;
+                    s_words(10) <= s_cycles;
+                end if;
+                s_words(4) <= s_words(4) + bits_set(stat_fifo_full);
+                s_words(5) <= s_words(5) + bits_set(stat_fifo_dropped);
+                s_words(6) <= s_words(6) + bits_set(stat_busy_dropped);
+                s_words(7) <= s_words(7) + bits_set(stat_constructor_busy);
+                s_words(11) <= s_cycles + 1;
+                for level in 0 to 7 loop
+                    if unsigned(stat_fifo_level(16*level+15 downto 16*level)) >
+                       s_words(HIGH_WATER_WORD+level) then
+                        s_words(HIGH_WATER_WORD+level) <=
+                            resize(unsigned(stat_fifo_level(16*level+15 downto 16*level)), 32);
+                    end if;
+                    if stat_fifo_dropped(level) = '1' then
+                        s_words(FIFO_DROPPED_WORD+level) <= s_words(FIFO_DROPPED_WORD+level) + 1;
+                    end if;
+                    if stat_busy_dropped(level) = '1' then
+                        s_words(BUSY_DROPPED_WORD+level) <= s_words(BUSY_DROPPED_WORD+level) + 1;
+                    end if;
+                end loop;
+            end if;
+        end if;
+    end process count_events;
+
+    -- Writes from the host are ignored
+    host_read: process(bram_clk)
+        variable word : integer range 0 to 1023;
+    begin
+        if rising_edge(bram_clk) then
+            if bram_en = '1' then
+                word := to_integer(unsigned(bram_addr(11 downto 2)));
+                if word < NUM_WORDS then
+                    bram_dout <= std_logic_vector(s_words(word));
+                else
+                    bram_dout <= (others => '0');
+                end if;
+            end if;
+        end if;
+    end process host_read;
+
+end rtl;
@@ -0,0 +1,374 @@
+----------------------------------------------------------------------------------
+-- Company: INESC-ID
+-- Engineer: Andre Costa [andre.mestre.costa@tecnico.ulisboa.pt]
+--
+-- Create Date: 10/17/2026 02:05:11 PM
+-- Module Name: descriptor_match - rtl
+-- Project Name: ORB-Accelerator
+-- Target Devices: NA
+-- Tool Versions: NA
+-- Description: Hamming distance matcher of the keypoints written by
+--              write_descriptors against a reference set loaded by the host.
+--              Each keypoint (we, addr, descriptor) waits in a QUEUE_DEPTH
+--              deep queue, then the references are read one per clock from
+--              eight 32-bit banks, XORed with the descriptor and counted in
+--              a 3 stage pipeline, and the nearest and second nearest are
+--              written to the match table at the entry of the keypoint.
+--              A keypoint takes the reference count plus 5 clocks (2
+--              without references). Ties go to the lowest index.
+--              A keypoint that finds the queue full is dropped: its entry
+--              is invalidated, and so is the result of a queued keypoint
+--              for the same entry, since the BRAMs now hold another one.
+--
+--              The host window (BRAM port of an AXI BRAM controller, same
+--              clock as clk, one cycle read latency), in 32-bit words:
+--                0-4095     references, word w of reference r at 8*r+w,
+--                           bits 32*w+31 downto 32*w of the descriptor
+--                4096-6143  match table, best and second best of entry e
+--                           at 4096+2*e: valid(1) & "000000" &
+--                           distance(9) & reference index(16)
+--                6144       references in use (read/write)
+--                6145       status: busy(1) & zeros & dropped(16)
+--              The references and their count are kept across rst_n. rst_n
+--              clears the queue and the dropped count, and the match table
+--              in FEATURE_LINES clocks.
+--
+----------------------------------------------------------------------------------
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+
+entity descriptor_match is
+    generic (
+        FEATURE_LINES : integer := 512; -- at most 1024
+        MAX_REFS : integer := 512; -- at most 512
+        QUEUE_DEPTH : integer := 16
+    );
+    Port (
+        clk : in STD_LOGIC;
+        rst_n : in STD_LOGIC;
+        we : in STD_LOGIC;
+        addr : in STD_LOGIC_VECTOR(31 downto 0);
+        descriptor : in STD_LOGIC_VECTOR(255 downto 0);
+        bram_clk : in STD_LOGIC;
+        bram_rst : in STD_LOGIC;
+        bram_en : in STD_LOGIC;
+        bram_we : in STD_LOGIC_VECTOR(3 downto 0);
+        bram_addr : in STD_LOGIC_VECTOR(14 downto 0);
+        bram_din : in STD_LOGIC_VECTOR(31 downto 0);
+        bram_dout : out STD_LOGIC_VECTOR(31 downto 0)
+    );
+end descriptor_match;
+
+architecture rtl of descriptor_match is
+    ATTRIBUTE X_INTERFACE_INFO : STRING;
+    ATTRIBUTE X_INTERFACE_INFO of bram_clk: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA CLK";
+    ATTRIBUTE X_INTERFACE_INFO of bram_rst: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA RST";
+    ATTRIBUTE X_INTERFACE_INFO of bram_en: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA EN";
+    ATTRIBUTE X_INTERFACE_INFO of bram_we: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA WE";
+    ATTRIBUTE X_INTERFACE_INFO of bram_addr: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA ADDR";
+    ATTRIBUTE X_INTERFACE_INFO of bram_din: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA DIN";
+    ATTRIBUTE X_INTERFACE_INFO of bram_dout: SIGNAL is "xilinx.com:interface:bram:1.0 BRAM_PORTA DOUT";
+
+    constant TABLE_WORD : integer := 4096;
+    constant COUNT_WORD : integer := 6144;
+    constant STATUS_WORD : integer := 6145;
+
+    subtype word_type is std_logic_vector(31 downto 0);
+    type ref_bank is array (0 to MAX_REFS-1) of word_type;
+    type bank_words is array (0 to 7) of word_type;
+    type table_type is array (0 to FEATURE_LINES-1) of word_type;
+    type descriptor_queue is array (0 to QUEUE_DEPTH-1) of std_logic_vector(255 downto 0);
+    type slot_queue is array (0 to QUEUE_DEPTH-1) of integer range 0 to FEATURE_LINES-1;
+    type partial_array is array (0 to 7) of unsigned(5 downto 0);
+
+    type state_type is (CLEAR, IDLE, RUN, WRITE);
+    type region_type is (REFS, TABLE, COUNT, STATUS, NONE);
+
+    -- Host port
+    signal s_word : integer range 0 to 8191;
+    signal s_region : region_type;
+    signal s_region_r : region_type;
+    signal s_ref_we : std_logic;
+    signal s_ref_bank : integer range 0 to 7;
+    signal s_ref_bank_r : integer range 0 to 7;
+    signal s_host_ref : integer range 0 to MAX_REFS-1;
+    signal s_host_entry : integer range 0 to FEATURE_LINES-1;
+    signal s_host_second_r : std_logic;
+    signal s_host_refs : bank_words;
+    signal s_host_best : word_type;
+    signal s_host_second : word_type;
+    signal s_ref_count : integer range 0 to MAX_REFS := 0;
+
+    -- Match tables
+    signal s_best_table : table_type;
+    signal s_second_table : table_type;
+
+    -- Keypoint queue
+    signal q_descriptor : descriptor_queue;
+    signal q_slot : slot_queue;
+    signal s_head : integer range 0 to QUEUE_DEPTH-1;
+    signal s_tail : integer range 0 to QUEUE_DEPTH-1;
+    signal s_fill : integer range 0 to QUEUE_DEPTH;
+    signal s_stale : std_logic_vector(0 to FEATURE_LINES-1);
+    signal s_drop_pending : std_logic;
+    signal s_drop_slot : integer range 0 to FEATURE_LINES-1;
+    signal s_dropped : unsigned(15 downto 0);
+
+    -- Keypoint being matched
+    signal s_state : state_type := CLEAR;
+    signal s_clear : integer range 0 to FEATURE_LINES-1;
+    signal s_descriptor : std_logic_vector(255 downto 0);
+    signal s_slot : integer range 0 to FEATURE_LINES-1;
+    signal s_run_count : integer range 0 to MAX_REFS;
+    signal s_issue : std_logic;
+    signal s_rd_ref : integer range 0 to MAX_REFS-1;
+
+    -- Pipeline: bank read, partial counts, distance
+    signal s_ref_words : bank_words;
+    signal p1_valid, p2_valid, p3_valid : std_logic;
+    signal p1_last, p2_last, p3_last : std_logic;
+    signal p1_ref, p2_ref, p3_ref : integer range 0 to MAX_REFS-1;
+    signal p2_partial : partial_array;
+    signal p3_distance : unsigned(8 downto 0);
+
+    signal s_best_distance : unsigned(8 downto 0);
+    signal s_best_ref : integer range 0 to MAX_REFS-1;
+    signal s_second_distance : unsigned(8 downto 0);
+    signal s_second_ref : integer range 0 to MAX_REFS-1;
+
+    signal s_busy : std_logic;
+
+    function popcount(v : std_logic_vector(31 downto 0)) return unsigned is
+        variable count : unsigned(5 downto 0) := (others => '0');
+    begin
+        for i in v'range loop
+            if v(i) = '1' then
+                count := count + 1;
+            end if;
+        end loop;
+        return count;
+    end function;
+
+    function match_word(valid : boolean; distance : unsigned(8 downto 0); ref : integer) return word_type is
+    begin
+        if not valid then
+            return (others => '0');
+        end if;
+        return "1" & "000000" & std_logic_vector(distance) & std_logic_vector(to_unsigned(ref, 16));
+    end function;
+
+begin
+    assert FEATURE_LINES <= 1024 and MAX_REFS <= 512
+        report "descriptor_match: the window holds 512 references and 1024 entries" severity failure;
+
+    -- Host window
+
+    s_word <= to_integer(unsigned(bram_addr(14 downto 2)));
+    s_region <= REFS when s_word < TABLE_WORD and s_word / 8 < MAX_REFS else
+                TABLE when s_word >= TABLE_WORD and s_word < TABLE_WORD + 2*FEATURE_LINES else
+                COUNT when s_word = COUNT_WORD else
+                STATUS when s_word = STATUS_WORD else
+                NONE;
+    s_ref_bank <= s_word mod 8;
+    s_host_ref <= s_word / 8 when s_word / 8 < MAX_REFS else 0;
+    s_host_entry <= (s_word - TABLE_WORD) / 2 when s_region = TABLE else 0;
+    s_ref_we <= '1' when bram_en = '1' and s_region = REFS and bram_we /= "0000" else '0';
+
+    -- Reference banks: host port read/write, matcher port read only
+    gen_banks: for w in 0 to 7 generate
+        signal s_bank : ref_bank;
+    begin
+        process(clk)
+        begin
+            if rising_edge(clk) then
+                if bram_en = '1' then
+                    if s_ref_we = '1' and s_ref_bank = w then
+                        for b in 0 to 3 loop
+                            if bram_we(b) = '1' then
+                                s_bank(s_host_ref)(8*b+7 downto 8*b) <= bram_din(8*b+7 downto 8*b);
+                            end if;
+                        end loop;
+                    end if;
+                    s_host_refs(w) <= s_bank(s_host_ref);
+                end if;
+                s_ref_words(w) <= s_bank(s_rd_ref);
+            end if;
+        end process;
+    end generate;
+
+    -- Table read port and control words
+    process(clk)
+    begin
+        if rising_edge(clk) then
+            if bram_en = '1' then
+                s_host_best <= s_best_table(s_host_entry);
+                s_host_second <= s_second_table(s_host_entry);
+                s_host_second_r <= bram_addr(2);
+                s_ref_bank_r <= s_ref_bank;
+                s_region_r <= s_region;
+                if s_region = COUNT and bram_we /= "0000" then
+                    if to_integer(unsigned(bram_din(15 downto 0))) > MAX_REFS then
+                        s_ref_count <= MAX_REFS;
+                    else
+                        s_ref_count <= to_integer(unsigned(bram_din(15 downto 0)));
+                    end if;
+                end if;
+            end if;
+        end if;
+    end process;
+
+    s_busy <= '1' when s_state /= IDLE or s_fill > 0 or s_drop_pending = '1' else '0';
+
+    bram_dout <= s_host_refs(s_ref_bank_r) when s_region_r = REFS else
+                 s_host_second when s_region_r = TABLE and s_host_second_r = '1' else
+                 s_host_best when s_region_r = TABLE else
+                 std_logic_vector(to_unsigned(s_ref_count, 32)) when s_region_r = COUNT else
+                 s_busy & std_logic_vector(to_unsigned(0, 15)) & std_logic_vector(s_dropped) when s_region_r = STATUS else
+                 (others => '0');
+
+    -- Distance pipeline, one reference per clock
+    process(clk)
+        variable sum : unsigned(8 downto 0);
+    begin
+        if rising_edge(clk) then
+            p1_valid <= s_issue;
+            if s_rd_ref = s_run_count-1 then
+                p1_last <= '1';
+            else
+                p1_last <= '0';
+            end if;
+            p1_ref <= s_rd_ref;
+
+            for w in 0 to 7 loop
+                p2_partial(w) <= popcount(s_ref_words(w) xor s_descriptor(32*w+31 downto 32*w));
+            end loop;
+            p2_valid <= p1_valid;
+            p2_last <= p1_last;
+            p2_ref <= p1_ref;
+
+            sum := (others => '0');
+            for w in 0 to 7 loop
+                sum := sum + p2_partial(w);
+            end loop;
+            p3_distance <= sum;
+            p3_valid <= p2_valid;
+            p3_last <= p2_last;
+            p3_ref <= p2_ref;
+        end if;
+    end process;
+
+    process(clk)
+        variable push : boolean;
+        variable pop : boolean;
+        variable slot : integer;
+    begin
+        if rising_edge(clk) then
+            if rst_n = '1' then
+                slot := to_integer(unsigned(addr(11 downto 2))) mod FEATURE_LINES;
+                push := we = '1' and s_fill < QUEUE_DEPTH;
+                -- An entry invalidated by a drop is written before the next pop
+                pop := s_state = IDLE and s_fill > 0 and s_drop_pending = '0';
+                -- IDLE and RUN write the pending drop this cycle; a drop of
+                -- this cycle sets the flag again below, after the clear
+                if (s_state = IDLE or s_state = RUN) and s_drop_pending = '1' then
+                    s_drop_pending <= '0';
+                end if;
+                if push then
+                    q_descriptor(s_tail) <= descriptor;
+                    q_slot(s_tail) <= slot;
+                    s_tail <= (s_tail + 1) mod QUEUE_DEPTH;
+                    s_stale(slot) <= '0';
+                elsif we = '1' then
+                    s_stale(slot) <= '1';
+                    s_drop_pending <= '1';
+                    s_drop_slot <= slot;
+                    s_dropped <= s_dropped + 1;
+                end if;
+                if push and not pop then
+                    s_fill <= s_fill + 1;
+                elsif pop and not push then
+                    s_fill <= s_fill - 1;
+                end if;
+
+                case s_state is
+                    when CLEAR =>
+                        s_best_table(s_clear) <= (others => '0');
+                        s_second_table(s_clear) <= (others => '0');
+                        if s_clear = FEATURE_LINES-1 then
+                            s_state <= IDLE;
+                        else
+                            s_clear <= s_clear + 1;
+                        end if;
+
+                    when IDLE =>
+                        if s_drop_pending = '1' then
+                            s_best_table(s_drop_slot) <= (others => '0');
+                            s_second_table(s_drop_slot) <= (others => '0');
+                        elsif pop then
+                            s_descriptor <= q_descriptor(s_head);
+                            s_slot <= q_slot(s_head);
+                            s_head <= (s_head + 1) mod QUEUE_DEPTH;
+                            s_run_count <= s_ref_count;
+                            s_best_distance <= (others => '1');
+                            s_second_distance <= (others => '1');
+                            s_best_ref <= 0;
+                            s_second_ref <= 0;
+                            s_rd_ref <= 0;
+                            if s_ref_count = 0 then
+                                s_state <= WRITE;
+                            else
+                                s_issue <= '1';
+                                s_state <= RUN;
+                            end if;
+                        end if;
+
+                    when RUN =>
+                        if s_issue = '1' then
+                            if s_rd_ref = s_run_count-1 then
+                                s_issue <= '0';
+                            else
+                                s_rd_ref <= s_rd_ref + 1;
+                            end if;
+                        end if;
+                        if s_drop_pending = '1' then
+                            s_best_table(s_drop_slot) <= (others => '0');
+                            s_second_table(s_drop_slot) <= (others => '0');
+                        end if;
+                        -- Nearest two so far, the lower index on ties
+                        if p3_valid = '1' then
+                            if p3_distance < s_best_distance then
+                                s_second_distance <= s_best_distance;
+                                s_second_ref <= s_best_ref;
+                                s_best_distance <= p3_distance;
+                                s_best_ref <= p3_ref;
+                            elsif p3_distance < s_second_distance then
+                                s_second_distance <= p3_distance;
+                                s_second_ref <= p3_ref;
+                            end if;
+                            if p3_last = '1' then
+                                s_state <= WRITE;
+                            end if;
+                        end if;
+
+                    when WRITE =>
+                        s_best_table(s_slot) <= match_word(s_run_count > 0 and s_stale(s_slot) = '0', s_best_distance, s_best_ref);
+                        s_second_table(s_slot) <= match_word(s_run_count > 1 and s_stale(s_slot) = '0', s_second_distance, s_second_ref);
+                        s_state <= IDLE;
+                end case;
+            else
+                s_state <= CLEAR;
+                s_clear <= 0;
+                s_head <= 0;
+                s_tail <= 0;
+                s_fill <= 0;
+                s_issue <= '0';
+                s_drop_pending <= '0';
+                s_dropped <= (others => '0');
+                s_stale <= (others => '0');
+            end if;
+        end if;
+    end process;
+
+end rtl;
@@ -0,0 +1,177 @@
+----------------------------------------------------------------------------------
+-- Company: INESC-ID
+-- Engineer: Andre Costa [andre.mestre.costa@tecnico.ulisboa.pt]
+--
+-- Create Date: 10/17/2026 09:12:40 AM
+-- Module Name: feature_select - rtl
+-- Project Name: ORB-Accelerator
+-- Target Devices: NA
+-- Tool Versions: NA
+-- Description: Streaming top-K selection of keypoints by FAST score, per
+--              cell of a grid. Each cell owns CELL_K consecutive entries of
+--              the descriptor BRAMs and a tournament tree over them: the
+--              leaves hold the key of each entry ('1' & score, zero while
+--              empty) and every node the smaller key of its children, so
+--              the root names the entry to replace. A keypoint is kept when
+--              its key is above the root key; it takes that entry and the
+--              path from the leaf to the root is updated, one level per
+--              clock. Ties go to the left child, so the entries of a cell
+--              fill in order and, once full, the lowest entry among those
+--              with the lowest score is replaced first.
+--              After rst_n the trees are cleared in 2*CELLS*CELL_K clocks,
+--              during which clear_we walks over the entries so their pos
+--              word can be zeroed. ready is low while clearing or updating.
+--
+----------------------------------------------------------------------------------
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+
+
+entity feature_select is
+    generic (
+        CELLS : integer := 1;
+        CELL_K : integer := 512 -- power of two
+    );
+    Port (
+        clk : in STD_LOGIC;
+        rst_n : in STD_LOGIC;
+        start : in STD_LOGIC;
+        cell : in integer range 0 to CELLS-1;
+        score : in STD_LOGIC_VECTOR(11 downto 0);
+        ready : out STD_LOGIC;
+        keep : out STD_LOGIC;
+        empty : out STD_LOGIC;
+        slot : out integer range 0 to CELLS*CELL_K-1;
+        clear_we : out STD_LOGIC;
+        clear_slot : out integer range 0 to CELLS*CELL_K-1
+    );
+end feature_select;
+
+architecture rtl of feature_select is
+    function log2(n : integer) return integer is
+        variable bits : integer := 0;
+    begin
+        while 2**bits < n loop
+            bits := bits + 1;
+        end loop;
+        return bits;
+    end function;
+
+    constant LOG_K : integer := log2(CELL_K);
+    constant TREE_SIZE : integer := CELLS*2*CELL_K;
+
+    subtype key_type is unsigned(12 downto 0);
+    type key_array is array (0 to TREE_SIZE-1) of key_type;
+    type slot_array is array (0 to TREE_SIZE-1) of integer range 0 to CELL_K-1;
+
+    type state_type is (CLEAR, IDLE, UPDATE);
+
+    signal s_keys : key_array;
+    signal s_slots : slot_array;
+    signal s_state : state_type := CLEAR;
+    signal s_clear : integer range 0 to TREE_SIZE-1;
+    signal s_base : integer range 0 to TREE_SIZE-1;
+    signal s_node : integer range 1 to 2*CELL_K-1;
+    signal s_key : key_type;
+    signal s_slot : integer range 0 to CELL_K-1;
+
+    signal s_key_in : key_type;
+    signal s_root_key : key_type;
+    signal s_root_slot : integer range 0 to CELL_K-1;
+    signal s_keep : std_logic;
+
+    -- Leftmost leaf under node n of a tree, as an entry of its cell
+    function leftmost(n : integer) return integer is
+        variable v : integer;
+    begin
+        v := n;
+        if v = 0 then
+            return 0;
+        end if;
+        for level in 1 to LOG_K loop
+            if v < CELL_K then
+                v := v*2;
+            end if;
+        end loop;
+        return v - CELL_K;
+    end function;
+
+begin
+    assert 2**LOG_K = CELL_K
+        report "feature_select: CELL_K must be a power of two" severity failure;
+
+    s_key_in <= '1' & unsigned(score);
+    s_root_key <= s_keys(cell*2*CELL_K + 1);
+    s_root_slot <= s_slots(cell*2*CELL_K + 1);
+    s_keep <= '1' when s_state = IDLE and s_key_in > s_root_key else '0';
+
+    ready <= '1' when s_state = IDLE else '0';
+    keep <= s_keep;
+    empty <= '1' when s_root_key = 0 else '0';
+    slot <= cell*CELL_K + s_root_slot;
+
+    clear_we <= '1' when s_state = CLEAR and s_clear < CELLS*CELL_K else '0';
+    clear_slot <= s_clear when s_clear < CELLS*CELL_K else 0;
+
+    process(clk)
+        variable sibling : integer range 0 to 2*CELL_K-1;
+        variable parent : integer range 1 to 2*CELL_K-1;
+        variable take_sibling : boolean;
+    begin
+        if rising_edge(clk) then
+            if rst_n = '1' then
+                case s_state is
+                    when CLEAR =>
+                        s_keys(s_clear) <= (others => '0');
+                        s_slots(s_clear) <= leftmost(s_clear mod (2*CELL_K));
+                        if s_clear = TREE_SIZE-1 then
+                            s_state <= IDLE;
+                        else
+                            s_clear <= s_clear + 1;
+                        end if;
+
+                    when IDLE =>
+                        if start = '1' and s_keep = '1' then
+                            s_keys(cell*2*CELL_K + CELL_K + s_root_slot) <= s_key_in;
+                            s_base <= cell*2*CELL_K;
+                            s_node <= CELL_K + s_root_slot;
+                            s_key <= s_key_in;
+                            s_slot <= s_root_slot;
+                            if CELL_K > 1 then
+                                s_state <= UPDATE;
+                            end if;
+                        end if;
+
+                    when UPDATE =>
+                        -- Smaller key of the node and its sibling, left on ties
+                        if s_node mod 2 = 0 then
+                            sibling := s_node + 1;
+                            take_sibling := s_keys(s_base + sibling) < s_key;
+                        else
+                            sibling := s_node - 1;
+                            take_sibling := s_keys(s_base + sibling) <= s_key;
+                        end if;
+                        parent := s_node / 2;
+                        if take_sibling then
+                            s_keys(s_base + parent) <= s_keys(s_base + sibling);
+                            s_slots(s_base + parent) <= s_slots(s_base + sibling);
+                            s_key <= s_keys(s_base + sibling);
+                            s_slot <= s_slots(s_base + sibling);
+                        else
+                            s_keys(s_base + parent) <= s_key;
+                            s_slots(s_base + parent) <= s_slot;
+                        end if;
+                        s_node <= parent;
+                        if parent = 1 then
+                            s_state <= IDLE;
+                        end if;
+                end case;
+            else
+                s_state <= CLEAR;
+                s_clear <= 0;
+            end if;
+        end if;
+    end process;
+
+end rtl;
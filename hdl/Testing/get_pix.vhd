@@ -8,6 +8,14 @@
 -- Target Devices: NA
 -- Tool Versions: NA
 -- Description: 
+--   Streams the pixels written by the host into the pixel BRAM. The host
+--   fills a chunk of MEM_SIZE pixels after the control word and sets bit 0
+--   of the control word; the chunk is streamed and the control word cleared.
+--   With PING_PONG the BRAM holds two such chunks (control word at byte 0
+--   and at byte MEM_SIZE + 8), consumed alternately, so the host can fill
+--   one half while the other is streamed.
+--   chunk_done pulses for one cycle when a control word is cleared, it can
+--   drive an edge triggered interrupt (IRQ_F2P) instead of polling.
 -- 
 ----------------------------------------------------------------------------------
 library IEEE;
@@ -17,7 +25,8 @@ use IEEE.NUMERIC_STD.ALL;
 
 entity get_pix is
     generic (
-        MEM_SIZE : integer := 1050 -- 30x35
+        MEM_SIZE : integer := 1050; -- 30x35
+        PING_PONG : boolean := false
     );
     port (
         clk: in std_logic;
@@ -33,11 +42,15 @@ entity get_pix is
         pix_ready: out std_logic;
         pix_ready_n: out std_logic;
         pix_ready_1: out std_logic;
+        chunk_done: out std_logic;
         pix: out std_logic_vector (7 downto 0)
     );
 end get_pix;
 
 architecture Behavioral of get_pix is
+    -- Byte offset of the second half (control word + MEM_SIZE pixels)
+    constant HALF_OFFSET : unsigned (31 downto 0) := to_unsigned(MEM_SIZE + 8, 32);
+    signal half_base : unsigned (31 downto 0) := (others => '0');
     signal value_buf : unsigned (31 downto 0) := (others => '0');
     signal value_out_buf : unsigned (31 downto 0);
     signal wenb_delay_1 : std_logic := '0';
@@ -73,9 +86,9 @@ begin
             if reset_n = '1' then
                 -- BRAM adress
                 case state is
-                    when 0 => addr <= (others => '0');
+                    when 0 => addr <= std_logic_vector(half_base);
                     when 1 => addr <= std_logic_vector(mem_addr);
-                    when 2 => addr <= (others => '0');
+                    when 2 => addr <= std_logic_vector(half_base);
                     when others => addr <= (others => '0');
                 end case;
                 -- BRAM write enable
@@ -98,11 +111,17 @@ begin
                     when 2 => enb_s <= '1';
                     when others => enb_s <= '0';
                 end case;
+                -- Chunk streamed, control word cleared
+                case state is
+                    when 2 => chunk_done <= '1';
+                    when others => chunk_done <= '0';
+                end case;
             else
                 addr <= (others => '0');
                 wenb <= '0';
                 enb <= '0';
                 enb_s <= '0';
+                chunk_done <= '0';
             end if;
 
             mem_rst <= '0';
@@ -166,7 +185,7 @@ begin
             if reset_n = '1' then
                 if state = 1  and pix_count < MEM_SIZE then
                     if start_stream = '0' then
-                        mem_addr <= "0000000000000000000000000000" & "1000"; -- 8
+                        mem_addr <= half_base + 8;
                         valid_pixel_read_delay_2 <= '1';
                         start_stream_delay <= '1';
                         pix_array_saved <= '0';
@@ -210,6 +229,12 @@ begin
                         end if;
                     end if;
                 elsif state = 2 then
+                    -- Control word of this half is cleared now, move on
+                    if PING_PONG and half_base = 0 then
+                        half_base <= HALF_OFFSET;
+                    else
+                        half_base <= (others => '0');
+                    end if;
 
                     pix_array <= (others => '0');
                     pix <= (others => '0');
@@ -227,6 +252,7 @@ begin
                     pix_ready_n <= '1';
                 end if;
             else
+                half_base <= (others => '0');
                 pix_array <= (others => '0');
                 pix <= (others => '0');
                 pix_index <= 1;
@@ -7,7 +7,19 @@
 -- Project Name: ORB-Accelerator
 -- Target Devices: NA
 -- Tool Versions: NA
--- Description: 
+-- Description: Writes the keypoints of a frame to the descriptor BRAMs,
+--              keeping the CELL_K best by FAST score in each cell of a
+--              GRID_X x GRID_Y grid over the LINE_SIZE x NUM_LINES frame
+--              (feature_select). Cell c owns entries c*CELL_K to
+--              (c+1)*CELL_K-1; with a 1x1 grid the entries fill in order.
+--              Keypoints wait in a QUEUE_DEPTH deep queue while the
+--              selection of the previous one runs, 1 + log2(CELL_K) clocks
+--              and at least 5, so bursts from the pyramid levels are kept.
+--              After rst_n the pos word of every entry is zeroed.
+--              status holds the entries used in bits 15-0 and, in bit 31, an
+--              overflow flag set when a keypoint finds its cell full (it
+--              then replaces the weakest one or is dropped) or the queue
+--              full. Both are cleared by rst_n.
 -- 
 ----------------------------------------------------------------------------------
 library IEEE;
@@ -18,7 +30,14 @@ use IEEE.NUMERIC_STD.ALL;
 entity write_descriptors is
     generic (
         MEM_SIZE : integer := 4096;
-        THETA_SIZE : integer := 3
+        FEATURE_LINES : integer := 512;
+        THETA_SIZE : integer := 3;
+        LINE_SIZE : integer := 640;
+        NUM_LINES : integer := 480;
+        GRID_X : integer := 1;
+        GRID_Y : integer := 1;
+        CELL_K : integer := 512; -- power of two, GRID_X*GRID_Y*CELL_K <= FEATURE_LINES
+        QUEUE_DEPTH : integer := 8
     );
     Port ( 
         clk : in STD_LOGIC;
@@ -29,9 +48,12 @@ entity write_descriptors is
         pos_x : in STD_LOGIC_VECTOR(10 downto 0);
         score : in STD_LOGIC_VECTOR(11 downto 0);
         angle : in STD_LOGIC_VECTOR(THETA_SIZE+2-1 downto 0);
-        scale : in STD_LOGIC;
+        scale : in STD_LOGIC_VECTOR(2 downto 0);
+        we : out STD_LOGIC;
+        we_descriptor : out STD_LOGIC;
         addr : out STD_LOGIC_VECTOR(31 downto 0);
         addr_128b : out STD_LOGIC_VECTOR(31 downto 0);
+        descriptor_o : out STD_LOGIC_VECTOR(255 downto 0);
         d0 : out STD_LOGIC_VECTOR(31 downto 0);
         d1 : out STD_LOGIC_VECTOR(31 downto 0);
         d2 : out STD_LOGIC_VECTOR(31 downto 0);
@@ -41,46 +63,197 @@ entity write_descriptors is
         d6 : out STD_LOGIC_VECTOR(31 downto 0);
         d7 : out STD_LOGIC_VECTOR(31 downto 0);
         pos_line : out STD_LOGIC_VECTOR(31 downto 0);
-        scr_angle_line : out STD_LOGIC_VECTOR(31 downto 0)
+        scr_angle_line : out STD_LOGIC_VECTOR(31 downto 0);
+        status : out STD_LOGIC_VECTOR(31 downto 0)
     );
 end write_descriptors;
 
 architecture rtl of write_descriptors is
-    signal s_addr : integer range 0 to MEM_SIZE-1;
-    signal s_addr_128 : integer range 0 to MEM_SIZE*4-1;
-    signal s_prev_en : std_logic := '0';
+    constant CELLS : integer := GRID_X*GRID_Y;
+    constant CELL_WIDTH : integer := (LINE_SIZE + GRID_X - 1) / GRID_X;
+    constant CELL_HEIGHT : integer := (NUM_LINES + GRID_Y - 1) / GRID_Y;
+    -- Clocks write_descriptor_bram needs between two writes
+    constant DESCRIPTOR_WRITE_CYCLES : integer := 5;
+
+    type descriptor_queue is array (0 to QUEUE_DEPTH-1) of std_logic_vector(255 downto 0);
+    type coord_queue is array (0 to QUEUE_DEPTH-1) of std_logic_vector(10 downto 0);
+    type score_queue is array (0 to QUEUE_DEPTH-1) of std_logic_vector(11 downto 0);
+    type angle_queue is array (0 to QUEUE_DEPTH-1) of std_logic_vector(THETA_SIZE+2-1 downto 0);
+    type scale_queue is array (0 to QUEUE_DEPTH-1) of std_logic_vector(2 downto 0);
+
+    signal q_descriptor : descriptor_queue;
+    signal q_pos_y : coord_queue;
+    signal q_pos_x : coord_queue;
+    signal q_score : score_queue;
+    signal q_angle : angle_queue;
+    signal q_scale : scale_queue;
+    signal s_head : integer range 0 to QUEUE_DEPTH-1;
+    signal s_tail : integer range 0 to QUEUE_DEPTH-1;
+    signal s_fill : integer range 0 to QUEUE_DEPTH;
+
+    -- Keypoint under selection
+    signal s_valid : std_logic;
+    signal s_descriptor : std_logic_vector(255 downto 0);
+    signal s_pos_y : std_logic_vector(10 downto 0);
+    signal s_pos_x : std_logic_vector(10 downto 0);
+    signal s_score : std_logic_vector(11 downto 0);
+    signal s_angle : std_logic_vector(THETA_SIZE+2-1 downto 0);
+    signal s_scale : std_logic_vector(2 downto 0);
+    signal s_cell : integer range 0 to CELLS-1;
+
+    signal s_start : std_logic;
+    signal s_select_ready : std_logic;
+    signal s_keep : std_logic;
+    signal s_empty : std_logic;
+    signal s_slot : integer range 0 to CELLS*CELL_K-1;
+    signal s_clear_we : std_logic;
+    signal s_clear_slot : integer range 0 to CELLS*CELL_K-1;
+    signal s_wait : integer range 0 to DESCRIPTOR_WRITE_CYCLES-1;
+
+    signal s_descriptor_o : std_logic_vector(255 downto 0);
+    signal s_count : integer range 0 to FEATURE_LINES;
+    signal s_overflow : std_logic;
+
+    -- Grid cell of a level 0 position
+    function cell_of(x : std_logic_vector; y : std_logic_vector) return integer is
+        variable cell_x : integer range 0 to GRID_X-1 := 0;
+        variable cell_y : integer range 0 to GRID_Y-1 := 0;
+    begin
+        for i in 1 to GRID_X-1 loop
+            if unsigned(x) >= i*CELL_WIDTH then
+                cell_x := i;
+            end if;
+        end loop;
+        for i in 1 to GRID_Y-1 loop
+            if unsigned(y) >= i*CELL_HEIGHT then
+                cell_y := i;
+            end if;
+        end loop;
+        return cell_y*GRID_X + cell_x;
+    end function;
 
 begin
-    d0 <= descriptor(31 downto 0);
-    d1 <= descriptor(63 downto 32);
-    d2 <= descriptor(95 downto 64);
-    d3 <= descriptor(127 downto 96);
-    d4 <= descriptor(159 downto 128);
-    d5 <= descriptor(191 downto 160);
-    d6 <= descriptor(223 downto 192);
-    d7 <= descriptor(255 downto 224);
-    pos_line <= "00000"&pos_y&"00000"&pos_x;
-    scr_angle_line <= "0"&scale&"00"&score&std_logic_vector(to_unsigned(0,16-angle'length))&angle;
+    assert CELLS*CELL_K <= FEATURE_LINES and FEATURE_LINES*4 <= MEM_SIZE
+        report "write_descriptors: GRID_X*GRID_Y*CELL_K entries do not fit" severity failure;
+
+    SELECT_FEATURES: entity work.feature_select
+    generic map (
+        CELLS => CELLS,
+        CELL_K => CELL_K
+    )
+    port map (
+        clk => clk,
+        rst_n => rst_n,
+        start => s_start,
+        cell => s_cell,
+        score => s_score,
+        ready => s_select_ready,
+        keep => s_keep,
+        empty => s_empty,
+        slot => s_slot,
+        clear_we => s_clear_we,
+        clear_slot => s_clear_slot
+    );
+
+    s_start <= '1' when s_valid = '1' and s_select_ready = '1' and s_wait = 0 else '0';
+
+    descriptor_o <= s_descriptor_o;
+    d0 <= s_descriptor_o(31 downto 0);
+    d1 <= s_descriptor_o(63 downto 32);
+    d2 <= s_descriptor_o(95 downto 64);
+    d3 <= s_descriptor_o(127 downto 96);
+    d4 <= s_descriptor_o(159 downto 128);
+    d5 <= s_descriptor_o(191 downto 160);
+    d6 <= s_descriptor_o(223 downto 192);
+    d7 <= s_descriptor_o(255 downto 224);
 
     process(clk)
+        variable push : boolean;
+        variable pop : boolean;
     begin
         if rising_edge(clk) then
             if rst_n = '1' then
-                if en = '1' and s_prev_en = '0' and s_addr <  (MEM_SIZE-1) then
-                    s_addr <= s_addr + 4;
-                    s_addr_128 <= s_addr_128 + 16;
+                -- One keypoint per clock of en
+                push := en = '1' and s_fill < QUEUE_DEPTH;
+                pop := s_valid = '0' and s_fill > 0;
+                if push then
+                    q_descriptor(s_tail) <= descriptor;
+                    q_pos_y(s_tail) <= pos_y;
+                    q_pos_x(s_tail) <= pos_x;
+                    q_score(s_tail) <= score;
+                    q_angle(s_tail) <= angle;
+                    q_scale(s_tail) <= scale;
+                    s_tail <= (s_tail + 1) mod QUEUE_DEPTH;
+                end if;
+                if pop then
+                    s_descriptor <= q_descriptor(s_head);
+                    s_pos_y <= q_pos_y(s_head);
+                    s_pos_x <= q_pos_x(s_head);
+                    s_score <= q_score(s_head);
+                    s_angle <= q_angle(s_head);
+                    s_scale <= q_scale(s_head);
+                    s_cell <= cell_of(q_pos_x(s_head), q_pos_y(s_head));
+                    s_valid <= '1';
+                    s_head <= (s_head + 1) mod QUEUE_DEPTH;
+                end if;
+                if push and not pop then
+                    s_fill <= s_fill + 1;
+                elsif pop and not push then
+                    s_fill <= s_fill - 1;
+                end if;
+
+                if s_wait > 0 then
+                    s_wait <= s_wait - 1;
+                end if;
+
+                if s_start = '1' then
+                    s_valid <= '0';
+                    if s_keep = '1' then
+                        we <= '1';
+                        we_descriptor <= '1';
+                        addr <= std_logic_vector(to_unsigned(s_slot*4, addr'length));
+                        addr_128b <= std_logic_vector(to_unsigned(s_slot*16, addr_128b'length));
+                        pos_line <= "00000"&s_pos_y&"00000"&s_pos_x;
+                        scr_angle_line <= "0"&s_scale&s_score&std_logic_vector(to_unsigned(0,16-s_angle'length))&s_angle;
+                        s_descriptor_o <= s_descriptor;
+                        s_wait <= DESCRIPTOR_WRITE_CYCLES-1;
+                    else
+                        we <= '0';
+                        we_descriptor <= '0';
+                    end if;
+                    if s_keep = '1' and s_empty = '1' then
+                        s_count <= s_count + 1;
+                    else
+                        s_overflow <= '1';
+                    end if;
+                elsif s_clear_we = '1' then
+                    -- End markers for the entries left empty
+                    we <= '1';
+                    we_descriptor <= '0';
+                    addr <= std_logic_vector(to_unsigned(s_clear_slot*4, addr'length));
+                    pos_line <= (others => '0');
+                    scr_angle_line <= (others => '0');
                 else
-                    s_addr <= s_addr;
-                    s_addr_128 <= s_addr_128;
+                    we <= '0';
+                    we_descriptor <= '0';
+                end if;
+
+                if en = '1' and s_fill = QUEUE_DEPTH then
+                    s_overflow <= '1';
                 end if;
             else
-                s_addr <= 0;
-                s_addr_128 <= 0;
+                s_head <= 0;
+                s_tail <= 0;
+                s_fill <= 0;
+                s_valid <= '0';
+                s_wait <= 0;
+                s_count <= 0;
+                s_overflow <= '0';
+                we <= '0';
+                we_descriptor <= '0';
             end if;
 
-            addr <= std_logic_vector(to_unsigned(s_addr, addr'length));
-            addr_128b <= std_logic_vector(to_unsigned(s_addr_128, addr_128b'length));
-            s_prev_en <= en;
+            status <= s_overflow & std_logic_vector(to_unsigned(0, 15)) & std_logic_vector(to_unsigned(s_count, 16));
         end if;
     end process;
 
@@ -0,0 +1,404 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file orb_tb.cpp
+ * @brief C++ testbench of the orb entity, verilated from the RTL
+ *
+ * Feeds grayscale frames through pix_in/push one pixel per clock, as
+ * get_pix.vhd does, then SIM_FLUSH_LINES lines of zeros that flush the
+ * pipeline. Every feature_ready is packed into the words write_descriptors
+ * would store and decoded with KeypointBatch::assign(), the host decode.
+ * The same frame goes through the bit-exact OrbModel, and the two keypoint
+ * sets are diffed by level and position.
+ *
+ * Per frame it prints the cycles from the first pixel to the last
+ * descriptor, the drain after the last pixel, and the FIFO high water and
+ * the FIFO and constructor events of each level against those the model
+ * expects. A keypoint lost to a full FIFO in the RTL but not in the model
+ * shows here as missing.
+ *
+ * Geometry and generics come from the Makefile as SIM_* macros, the same
+ * values given to GHDL.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Vorb.h"
+#include "hamming_matcher.h"
+#include "keypoint_batch.h"
+#include "orb_model.h"
+#include "verilated.h"
+
+// ============================================================================
+// CONFIGURATION CONSTANTS
+// ============================================================================
+
+#ifndef SIM_LINE_SIZE
+#define SIM_LINE_SIZE 640
+#endif
+#ifndef SIM_NUM_LINES
+#define SIM_NUM_LINES 480
+#endif
+#ifndef SIM_NUM_SCALES
+#define SIM_NUM_SCALES 3
+#endif
+#ifndef SIM_THETA_SIZE
+#define SIM_THETA_SIZE 3
+#endif
+#ifndef SIM_FIFO_SIZE
+#define SIM_FIFO_SIZE 256
+#endif
+#ifndef SIM_CONSTRUCTORS
+#define SIM_CONSTRUCTORS 1
+#endif
+
+// Lines of zeros after a frame, enough for the 37x37 orientation window of
+// the last level and the constructors to finish
+#define SIM_FLUSH_LINES 160
+
+// Clocks the reset is held at the start of every frame
+#define SIM_RESET_CYCLES 16
+
+// Keypoints kept by the model, more than any frame has
+#define SIM_MODEL_KEYPOINTS 16384
+
+// Differences printed per kind and frame
+#define SIM_MAX_REPORTED 8
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+/**
+ * @brief Read a binary PGM (P5) of 8-bit pixels
+ * @return 0 on success, -1 if it cannot be read or is not 8-bit P5
+ */
+static int read_pgm(const char *path, std::vector<uint8_t> *pixels,
+                    int *width, int *height) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    perror(path);
+    return -1;
+  }
+  char magic[3] = {0};
+  int maxval = 0;
+  int c;
+  bool ok = fscanf(file, "%2s", magic) == 1 && strcmp(magic, "P5") == 0;
+  // Header fields, skipping comments
+  int *fields[3] = {width, height, &maxval};
+  for (int i = 0; ok && i < 3; i++) {
+    while ((c = fgetc(file)) == '#' || c == ' ' || c == '\n' || c == '\r' ||
+           c == '\t') {
+      if (c == '#') {
+        while ((c = fgetc(file)) != '\n' && c != EOF) {
+        }
+      }
+    }
+    ungetc(c, file);
+    ok = fscanf(file, "%d", fields[i]) == 1;
+  }
+  ok = ok && maxval == 255 && fgetc(file) != EOF;
+  if (ok) {
+    pixels->resize(static_cast<size_t>(*width) * *height);
+    ok = fread(pixels->data(), 1, pixels->size(), file) == pixels->size();
+  }
+  fclose(file);
+  if (!ok) fprintf(stderr, "%s: not an 8-bit binary PGM\n", path);
+  return ok ? 0 : -1;
+}
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+/**
+ * @brief Features and events of one frame through the RTL
+ */
+struct SimFrame {
+  std::vector<OrbFeature> features;
+  uint64_t first_pixel;
+  uint64_t last_pixel;
+  uint64_t last_descriptor;
+  uint32_t counters[PERF_WORDS];  // As orb_counters.vhd counts them
+  uint32_t fifo_full[MAX_SCALES];
+};
+
+static int bits_set(uint32_t value) { return __builtin_popcount(value); }
+
+/**
+ * @brief One clock: inputs are applied, the rising edge evaluated and the
+ *        registered outputs sampled
+ */
+static void clock(Vorb *top, uint64_t cycle, SimFrame *frame) {
+  top->clk = 1;
+  top->eval();
+
+  frame->counters[PERF_CANDIDATES] += bits_set(top->stat_candidate);
+  frame->counters[PERF_SURVIVORS] += bits_set(top->stat_survivor);
+  frame->counters[PERF_FIFO_FULL] += bits_set(top->stat_fifo_full);
+  frame->counters[PERF_CONSTRUCTOR_BUSY] +=
+      bits_set(top->stat_constructor_busy);
+  frame->counters[PERF_FIFO_DROPPED] += bits_set(top->stat_fifo_dropped);
+  frame->counters[PERF_BUSY_DROPPED] += bits_set(top->stat_busy_dropped);
+  for (int s = 0; s < SIM_NUM_SCALES; s++) {
+    frame->fifo_full[s] += (top->stat_fifo_full >> s) & 1;
+    frame->counters[PERF_LEVEL_FIFO_DROPPED + s] +=
+        (top->stat_fifo_dropped >> s) & 1;
+    frame->counters[PERF_LEVEL_BUSY_DROPPED + s] +=
+        (top->stat_busy_dropped >> s) & 1;
+    // 16 bits per level, two levels per word of the 128-bit vector
+    uint32_t level = (top->stat_fifo_level[s / 2] >> (16 * (s % 2))) & 0xFFFF;
+    uint32_t &high_water = frame->counters[PERF_FIFO_HIGH_WATER + s];
+    high_water = std::max(high_water, level);
+  }
+
+  if (top->feature_ready) {
+    // The words of write_descriptors.vhd
+    OrbFeature feature;
+    feature.pos = (static_cast<uint32_t>(top->feature_pos_y) << 16) |
+                  top->feature_pos_x;
+    feature.scr_angle = (static_cast<uint32_t>(top->feature_scale) << 28) |
+                        (static_cast<uint32_t>(top->feature_score) << 16) |
+                        top->feature_angle;
+    for (int w = 0; w < 8; w++) {
+      feature.descriptor[w] = top->feature_descriptor[w];
+    }
+    frame->features.push_back(feature);
+    frame->counters[PERF_DESCRIPTORS]++;
+    frame->last_descriptor = cycle;
+  }
+
+  top->clk = 0;
+  top->eval();
+}
+
+/**
+ * @brief Reset the pipeline and stream a frame and the flush lines
+ */
+static void simulate(Vorb *top, const uint8_t *pixels, int threshold,
+                     SimFrame *frame) {
+  memset(frame->counters, 0, sizeof(frame->counters));
+  memset(frame->fifo_full, 0, sizeof(frame->fifo_full));
+  frame->features.clear();
+  frame->last_descriptor = 0;
+
+  top->corner_thr = threshold & 0x1FF;
+  top->corner_thr_n = -threshold & 0x1FF;
+  top->push = 0;
+  top->pix_in = 0;
+  top->reset_n = 0;
+  SimFrame discard = *frame;
+  for (int i = 0; i < SIM_RESET_CYCLES; i++) clock(top, 0, &discard);
+  top->reset_n = 1;
+
+  uint64_t cycle = 0;
+  size_t frame_pixels = static_cast<size_t>(SIM_LINE_SIZE) * SIM_NUM_LINES;
+  size_t flush_pixels = static_cast<size_t>(SIM_LINE_SIZE) * SIM_FLUSH_LINES;
+  frame->first_pixel = 0;
+  frame->last_pixel = frame_pixels - 1;
+  top->push = 1;
+  for (size_t i = 0; i < frame_pixels + flush_pixels; i++, cycle++) {
+    top->pix_in = i < frame_pixels ? pixels[i] : 0;
+    clock(top, cycle, frame);
+  }
+  top->push = 0;
+  frame->counters[PERF_PIXELS] = static_cast<uint32_t>(frame_pixels);
+}
+
+// ============================================================================
+// DIFF
+// ============================================================================
+
+/**
+ * @brief Decode features the way the host decodes the BRAMs
+ */
+static void decode(const std::vector<OrbFeature> &features,
+                   KeypointBatch *batch) {
+  size_t count = features.size();
+  std::vector<uint32_t> pos(count);
+  std::vector<uint32_t> scr_angle(count);
+  std::vector<uint32_t> descript0(count * 4);
+  std::vector<uint32_t> descript1(count * 4);
+  for (size_t i = 0; i < count; i++) {
+    pos[i] = features[i].pos;
+    scr_angle[i] = features[i].scr_angle;
+    memcpy(&descript0[i * 4], features[i].descriptor, 4 * sizeof(uint32_t));
+    memcpy(&descript1[i * 4], features[i].descriptor + 4,
+           4 * sizeof(uint32_t));
+  }
+  batch->theta_size = SIM_THETA_SIZE;
+  batch->assign(pos.data(), scr_angle.data(), descript0.data(),
+                descript1.data(), static_cast<int>(count));
+}
+
+/**
+ * @brief Level, line and column of keypoint i, the key of the diff
+ */
+static uint64_t key(const KeypointBatch &batch, int i) {
+  return (static_cast<uint64_t>(batch.scale[i]) << 32) |
+         (static_cast<uint64_t>(batch.y[i]) << 16) | batch.x[i];
+}
+
+static void print_keypoint(const char *what, const KeypointBatch &batch,
+                           int i) {
+  printf("  %s: level %d (%d, %d) score %d angle %d\n", what, batch.scale[i],
+         batch.x[i], batch.y[i], batch.score[i], batch.angle[i]);
+}
+
+/**
+ * @brief Diff the RTL keypoints against the model's
+ * @return Number of differences
+ */
+static int diff(const KeypointBatch &rtl, const KeypointBatch &model) {
+  std::map<uint64_t, int> expected;
+  for (int i = 0; i < model.count; i++) expected[key(model, i)] = i;
+
+  int differing = 0;
+  int extra = 0;
+  int same = 0;
+  std::vector<bool> seen(model.count, false);
+  for (int i = 0; i < rtl.count; i++) {
+    std::map<uint64_t, int>::const_iterator it = expected.find(key(rtl, i));
+    if (it == expected.end()) {
+      if (extra++ < SIM_MAX_REPORTED) print_keypoint("extra", rtl, i);
+      continue;
+    }
+    int j = it->second;
+    seen[j] = true;
+    int distance = hamming_distance(rtl.descriptor(i), model.descriptor(j));
+    if (rtl.score[i] != model.score[j] || rtl.angle[i] != model.angle[j] ||
+        distance != 0) {
+      if (differing++ < SIM_MAX_REPORTED) {
+        print_keypoint("rtl", rtl, i);
+        print_keypoint("model", model, j);
+        printf("  descriptor distance %d\n", distance);
+      }
+    } else {
+      same++;
+    }
+  }
+  int missing = 0;
+  for (int j = 0; j < model.count; j++) {
+    if (!seen[j] && missing++ < SIM_MAX_REPORTED) {
+      print_keypoint("missing", model, j);
+    }
+  }
+  printf("  keypoints: rtl %d, model %d; %d equal, %d differ, %d missing, "
+         "%d extra\n",
+         rtl.count, model.count, same, differing, missing, extra);
+  return differing + missing + extra;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+/**
+ * @brief Simulate every frame given
+ * @return 0 if the RTL matched the model on every frame, 1 otherwise
+ */
+int main(int argc, char **argv) {
+  Verilated::commandArgs(argc, argv);
+  int threshold = 15;
+  int arg = 1;
+  if (argc > arg + 1 && strcmp(argv[arg], "--threshold") == 0) {
+    threshold = atoi(argv[arg + 1]);
+    arg += 2;
+  }
+  if (arg >= argc) {
+    fprintf(stderr,
+            "Usage: %s [--threshold t] <frame.pgm>...\n"
+            "  Frames are %dx%d binary PGMs, e.g. from\n"
+            "  convert image.png -resize %dx%d! -colorspace gray frame.pgm\n",
+            argv[0], SIM_LINE_SIZE, SIM_NUM_LINES, SIM_LINE_SIZE,
+            SIM_NUM_LINES);
+    return 1;
+  }
+
+  OrbModelConfig model_config;
+  model_config.line_size = SIM_LINE_SIZE;
+  model_config.num_lines = SIM_NUM_LINES;
+  model_config.num_scales = SIM_NUM_SCALES;
+  model_config.theta_size = SIM_THETA_SIZE;
+  model_config.fifo_size = SIM_FIFO_SIZE;
+  model_config.constructors = SIM_CONSTRUCTORS;
+  model_config.feature_lines = SIM_MODEL_KEYPOINTS;
+  model_config.cell_k = SIM_MODEL_KEYPOINTS;
+  model_config.match_refs = 0;
+  OrbModel model(model_config);
+
+  Vorb *top = new Vorb;
+  top->clk = 0;
+  top->eval();
+
+  int failed = 0;
+  for (; arg < argc; arg++) {
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    if (read_pgm(argv[arg], &pixels, &width, &height) != 0) return 1;
+    if (width != SIM_LINE_SIZE || height != SIM_NUM_LINES) {
+      fprintf(stderr, "%s: %dx%d, the RTL is built for %dx%d\n", argv[arg],
+              width, height, SIM_LINE_SIZE, SIM_NUM_LINES);
+      return 1;
+    }
+
+    SimFrame frame;
+    simulate(top, pixels.data(), threshold, &frame);
+    std::vector<OrbFeature> expected;
+    model.process(pixels.data(), width, threshold, -threshold, &expected);
+    uint32_t model_counters[PERF_WORDS];
+    model.store_counters(model_counters);
+
+    KeypointBatch rtl;
+    KeypointBatch reference;
+    decode(frame.features, &rtl);
+    decode(expected, &reference);
+
+    uint64_t cycles = frame.last_descriptor + 1 - frame.first_pixel;
+    uint64_t drain = frame.last_descriptor > frame.last_pixel
+                         ? frame.last_descriptor - frame.last_pixel
+                         : 0;
+    printf("%s\n", argv[arg]);
+    printf("  cycles: %llu to the last descriptor (%.3f per pixel), drain "
+           "%llu; model %u\n",
+           static_cast<unsigned long long>(cycles),
+           static_cast<double>(cycles) / (width * height),
+           static_cast<unsigned long long>(drain),
+           model_counters[PERF_CYCLES]);
+    printf("  events rtl/model: candidates %u/%u, survivors %u/%u, "
+           "descriptors %u/%u, FIFO full cycles %u/%u, FIFO drops %u/%u, "
+           "busy drops %u/%u\n",
+           frame.counters[PERF_CANDIDATES], model_counters[PERF_CANDIDATES],
+           frame.counters[PERF_SURVIVORS], model_counters[PERF_SURVIVORS],
+           frame.counters[PERF_DESCRIPTORS], model_counters[PERF_DESCRIPTORS],
+           frame.counters[PERF_FIFO_FULL], model_counters[PERF_FIFO_FULL],
+           frame.counters[PERF_FIFO_DROPPED],
+           model_counters[PERF_FIFO_DROPPED],
+           frame.counters[PERF_BUSY_DROPPED],
+           model_counters[PERF_BUSY_DROPPED]);
+    for (int s = 0; s < SIM_NUM_SCALES; s++) {
+      printf("  level %d rtl/model: FIFO high water %u/%u of %d, full %u "
+             "cycles, dropped full %u/%u, dropped busy %u/%u\n",
+             s, frame.counters[PERF_FIFO_HIGH_WATER + s],
+             model_counters[PERF_FIFO_HIGH_WATER + s], SIM_FIFO_SIZE - 1,
+             frame.fifo_full[s], frame.counters[PERF_LEVEL_FIFO_DROPPED + s],
+             model_counters[PERF_LEVEL_FIFO_DROPPED + s],
+             frame.counters[PERF_LEVEL_BUSY_DROPPED + s],
+             model_counters[PERF_LEVEL_BUSY_DROPPED + s]);
+    }
+    if (diff(rtl, reference) != 0) failed = 1;
+  }
+
+  top->final();
+  delete top;
+  return failed;
+}
@@ -0,0 +1,417 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file bench_orb.cpp
+ * @brief Benchmark of the accelerator backends over a fixed image corpus
+ *
+ * Runs every workload of the corpus through each backend, at each frame
+ * size and FAST threshold, and reports fps, latency percentiles, host CPU
+ * utilization, bytes moved and keypoints per frame. The synthetic
+ * workloads are generated from fixed seeds, so two runs of the same build
+ * see the same pixels and their results can be compared; recorded frames
+ * are added from a directory. Results go to stdout and, with --out, to a
+ * CSV or JSON Lines file, one line per case.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <random>
+
+#include "orb_accelerator.h"
+#include "tool_common.h"
+
+// ============================================================================
+// CONFIGURATION CONSTANTS
+// ============================================================================
+
+// Distinct frames of a workload, cycled through the timed frames so that
+// consecutive frames differ as in a stream
+#define BENCH_POOL 4
+
+// Seed of the synthetic workloads, fixed for comparable runs
+#define BENCH_SEED 2025
+
+// ============================================================================
+// WORKLOADS
+// ============================================================================
+
+/**
+ * @brief Frames of one workload, all of the size of the case
+ */
+struct Workload {
+  std::string name;
+  std::vector<cv::Mat> frames;
+};
+
+/**
+ * @brief Checkerboard of square x square cells, shifted by one pixel per
+ *        frame; every cell corner is a corner candidate
+ */
+static cv::Mat checkerboard(cv::Size size, int square, int frame) {
+  cv::Mat image(size, CV_8UC1);
+  for (int y = 0; y < size.height; y++) {
+    uint8_t *row = image.ptr<uint8_t>(y);
+    for (int x = 0; x < size.width; x++) {
+      bool dark = (((x + frame) / square + y / square) & 1) != 0;
+      row[x] = dark ? 40 : 210;
+    }
+  }
+  return image;
+}
+
+/**
+ * @brief Mid-grey image with a fraction of uniformly random pixels, from
+ *        sparse speckle to full noise
+ */
+static cv::Mat noise(cv::Size size, double fraction, int frame) {
+  std::mt19937 random(BENCH_SEED + frame);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  std::uniform_int_distribution<int> value(0, 255);
+  cv::Mat image(size, CV_8UC1, cv::Scalar(128));
+  for (int y = 0; y < size.height; y++) {
+    uint8_t *row = image.ptr<uint8_t>(y);
+    for (int x = 0; x < size.width; x++) {
+      if (chance(random) < fraction) {
+        row[x] = static_cast<uint8_t>(value(random));
+      }
+    }
+  }
+  return image;
+}
+
+/**
+ * @brief Isolated bright squares on a dark ground, one every spacing
+ *        pixels, so the corner count follows the spacing
+ */
+static cv::Mat corner_grid(cv::Size size, int spacing, int frame) {
+  cv::Mat image(size, CV_8UC1, cv::Scalar(30));
+  int side = std::max(spacing / 3, 4);
+  for (int y = spacing / 2; y + side < size.height; y += spacing) {
+    for (int x = spacing / 2 + frame % 4; x + side < size.width; x += spacing) {
+      cv::rectangle(image, cv::Rect(x, y, side, side), cv::Scalar(220),
+                    cv::FILLED);
+    }
+  }
+  return image;
+}
+
+/**
+ * @brief Synthetic workloads at a frame size, two density profiles each
+ */
+static std::vector<Workload> synthetic_workloads(cv::Size size) {
+  std::vector<Workload> workloads(6);
+  workloads[0].name = "checker_coarse";
+  workloads[1].name = "checker_fine";
+  workloads[2].name = "noise_sparse";
+  workloads[3].name = "noise_dense";
+  workloads[4].name = "corners_sparse";
+  workloads[5].name = "corners_dense";
+  for (int i = 0; i < BENCH_POOL; i++) {
+    workloads[0].frames.push_back(checkerboard(size, 32, i));
+    workloads[1].frames.push_back(checkerboard(size, 8, i));
+    workloads[2].frames.push_back(noise(size, 0.02, i));
+    workloads[3].frames.push_back(noise(size, 1.0, i));
+    workloads[4].frames.push_back(corner_grid(size, 64, i));
+    workloads[5].frames.push_back(corner_grid(size, 16, i));
+  }
+  return workloads;
+}
+
+/**
+ * @brief Recorded frames of a directory, in name order, as one workload
+ *        resized to the frame size
+ */
+static int recorded_workload(const std::string &directory, cv::Size size,
+                             Workload *workload) {
+  std::vector<cv::String> paths;
+  cv::glob(directory + "/*", paths);
+  std::sort(paths.begin(), paths.end());
+  workload->name = "recorded";
+  workload->frames.clear();
+  for (size_t i = 0; i < paths.size(); i++) {
+    cv::Mat image = cv::imread(paths[i], cv::IMREAD_GRAYSCALE);
+    if (image.empty()) continue;
+    if (image.size() != size) cv::resize(image, image, size);
+    workload->frames.push_back(image);
+  }
+  return workload->frames.empty() ? -1 : 0;
+}
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+/**
+ * @brief Results of one case: a workload on a backend at a size and
+ *        threshold
+ */
+struct BenchResult {
+  std::string backend;
+  std::string workload;
+  int width;
+  int height;
+  int threshold;
+  int frames;
+  double fps;
+  double p50_us;
+  double p99_us;
+  double cpu_percent;     // Host CPU time over wall time, all threads
+  double upload_bytes;    // Per frame
+  double readback_bytes;  // Per frame
+  double keypoints;       // Per frame
+};
+
+/**
+ * @brief User and system CPU time of the process, in seconds
+ */
+static double cpu_seconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/**
+ * @brief Run warmup then count frames of a workload, cycling its frames
+ * @return 0 on success, -1 if the accelerator failed
+ */
+static int run_case(OrbAccelerator *accelerator, const Workload &workload,
+                    int warmup, int count, BenchResult *result) {
+  const OrbAcceleratorConfig &config = accelerator->config();
+  KeypointBatch batch;
+  std::vector<double> latencies;
+  OrbFrameMetrics total;
+  double cpu_start = 0;
+  std::chrono::steady_clock::time_point first;
+
+  for (int i = 0; i < warmup + count; i++) {
+    if (i == warmup) {
+      cpu_start = cpu_seconds();
+      first = std::chrono::steady_clock::now();
+    }
+    const cv::Mat &frame = workload.frames[i % workload.frames.size()];
+    bool tiled = frame.cols != config.line_size ||
+                 frame.rows != config.num_lines;
+    auto start = std::chrono::steady_clock::now();
+    int found = tiled ? accelerator->detect_tiled(
+                            frame.ptr<uint8_t>(0), static_cast<int>(frame.step),
+                            frame.cols, frame.rows, &batch)
+                      : accelerator->detect(frame.ptr<uint8_t>(0),
+                                            static_cast<int>(frame.step),
+                                            &batch);
+    auto stop = std::chrono::steady_clock::now();
+    if (found < 0) return -1;
+    if (i < warmup) continue;
+
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(stop - start).count());
+    total.add(accelerator->metrics());
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - first)
+                       .count();
+  double cpu = cpu_seconds() - cpu_start;
+
+  std::sort(latencies.begin(), latencies.end());
+  result->frames = count;
+  result->fps = count / seconds;
+  result->p50_us = latencies[(count - 1) * 50 / 100];
+  result->p99_us = latencies[(count - 1) * 99 / 100];
+  result->cpu_percent = 100.0 * cpu / seconds;
+  result->upload_bytes = static_cast<double>(total.upload_bytes) / count;
+  result->readback_bytes = static_cast<double>(total.readback_bytes) / count;
+  result->keypoints = static_cast<double>(total.keypoints) / count;
+  return 0;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+static void write_result(RecordWriter *out, const BenchResult &r) {
+  out->text("backend", r.backend);
+  out->text("workload", r.workload);
+  out->integer("width", r.width);
+  out->integer("height", r.height);
+  out->integer("threshold", r.threshold);
+  out->integer("frames", r.frames);
+  out->number("fps", r.fps, 2);
+  out->number("p50_us", r.p50_us, 1);
+  out->number("p99_us", r.p99_us, 1);
+  out->number("cpu_percent", r.cpu_percent, 1);
+  out->number("upload_bytes", r.upload_bytes, 0);
+  out->number("readback_bytes", r.readback_bytes, 0);
+  out->number("keypoints", r.keypoints, 1);
+  out->end_record();
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+/**
+ * @brief Run every case of the corpus
+ * @return 0 on success, 1 on a bad option or if any case failed
+ */
+int main(int argc, char const *argv[]) {
+  std::string backends = "model";
+  std::string sizes;
+  std::string thresholds = "10,20,40";
+  std::string frames_dir;
+  std::string config_path;
+  std::string out_path;
+  int warmup = 2;
+  int count = 20;
+
+  for (int arg = 1; arg < argc; arg += 2) {
+    std::string option = argv[arg];
+    if (arg + 1 >= argc) {
+      option = "";
+    } else if (option == "--backends") {
+      backends = argv[arg + 1];
+    } else if (option == "--sizes") {
+      sizes = argv[arg + 1];
+    } else if (option == "--thresholds") {
+      thresholds = argv[arg + 1];
+    } else if (option == "--frames") {
+      frames_dir = argv[arg + 1];
+    } else if (option == "--config") {
+      config_path = argv[arg + 1];
+    } else if (option == "--out") {
+      out_path = argv[arg + 1];
+    } else if (option == "--warmup") {
+      warmup = static_cast<int>(strtol(argv[arg + 1], nullptr, 10));
+    } else if (option == "--count") {
+      count = static_cast<int>(strtol(argv[arg + 1], nullptr, 10));
+    } else {
+      option = "";
+    }
+    if (option.empty() || count < 1 || warmup < 0) {
+      std::cerr
+          << "Usage: " << argv[0]
+          << " [--backends zynq,shm,model] [--sizes WxH,...] "
+             "[--thresholds t,...] [--frames dir] [--config file] "
+             "[--out file] [--warmup frames] [--count frames]"
+          << std::endl;
+      std::cerr << "  --backends: Backends to run (default: model)"
+                << std::endl;
+      std::cerr << "  --sizes: Frame sizes, larger ones are tiled (default: "
+                   "the bitstream size and twice it)"
+                << std::endl;
+      std::cerr << "  --thresholds: FAST thresholds (default: 10,20,40)"
+                << std::endl;
+      std::cerr << "  --frames: Directory of recorded frames, one more "
+                   "workload"
+                << std::endl;
+      std::cerr << RESULTS_OUT_USAGE << std::endl;
+      std::cerr << "  --count: Timed frames per case (default: 20), after "
+                   "--warmup frames (default: 2)"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  OrbAcceleratorConfig config;
+  if (load_bitstream_config(&config_path, &config) != 0) return 1;
+  // The matcher is not part of the benchmark
+  config.match_refs = 0;
+
+  std::vector<cv::Size> frame_sizes;
+  if (sizes.empty()) {
+    frame_sizes.push_back(cv::Size(config.line_size, config.num_lines));
+    frame_sizes.push_back(cv::Size(config.line_size * 2, config.num_lines * 2));
+  }
+  std::vector<std::string> size_list = split_list(sizes);
+  for (size_t i = 0; i < size_list.size(); i++) {
+    int width = 0;
+    int height = 0;
+    if (sscanf(size_list[i].c_str(), "%dx%d", &width, &height) != 2 ||
+        width < config.line_size || height < config.num_lines) {
+      std::cerr << "Bad frame size " << size_list[i] << ", at least "
+                << config.line_size << "x" << config.num_lines << std::endl;
+      return 1;
+    }
+    frame_sizes.push_back(cv::Size(width, height));
+  }
+
+  RecordWriter out;
+  if (!out_path.empty() && out.open(out_path) != 0) return 1;
+
+  // ========================================================================
+  // CASES
+  // ========================================================================
+
+  int result = 0;
+  std::vector<std::string> backend_list = split_list(backends);
+  std::vector<std::string> threshold_list = split_list(thresholds);
+  printf("%-8s %-15s %-10s %4s %8s %9s %9s %5s %9s %9s %8s\n", "backend",
+         "workload", "size", "thr", "fps", "p50 us", "p99 us", "cpu%",
+         "up B", "read B", "kp");
+  for (size_t b = 0; b < backend_list.size(); b++) {
+    std::unique_ptr<OrbAccelerator> accelerator =
+        orb_accelerator_create(backend_list[b], config);
+    if (!accelerator) {
+      std::cerr << "Unknown backend: " << backend_list[b] << std::endl;
+      result = 1;
+      continue;
+    }
+    if (accelerator->open() != 0) {
+      std::cerr << "Could not open the " << backend_list[b]
+                << " backend, skipped" << std::endl;
+      result = 1;
+      continue;
+    }
+
+    for (size_t s = 0; s < frame_sizes.size(); s++) {
+      std::vector<Workload> workloads = synthetic_workloads(frame_sizes[s]);
+      if (!frames_dir.empty()) {
+        workloads.push_back(Workload());
+        if (recorded_workload(frames_dir, frame_sizes[s],
+                              &workloads.back()) != 0) {
+          std::cerr << "No frames in: " << frames_dir << std::endl;
+          workloads.pop_back();
+          result = 1;
+        }
+      }
+
+      for (size_t t = 0; t < threshold_list.size(); t++) {
+        int threshold =
+            static_cast<int>(strtol(threshold_list[t].c_str(), nullptr, 10));
+        accelerator->set_thresholds(threshold, -threshold);
+        for (size_t w = 0; w < workloads.size(); w++) {
+          BenchResult r;
+          r.backend = backend_list[b];
+          r.workload = workloads[w].name;
+          r.width = frame_sizes[s].width;
+          r.height = frame_sizes[s].height;
+          r.threshold = threshold;
+          if (run_case(accelerator.get(), workloads[w], warmup, count, &r) !=
+              0) {
+            std::cerr << "Accelerator failed on " << r.backend << " "
+                      << r.workload << std::endl;
+            result = 1;
+            continue;
+          }
+          printf("%-8s %-15s %4dx%-5d %4d %8.2f %9.0f %9.0f %5.0f %9.0f "
+                 "%9.0f %8.1f\n",
+                 r.backend.c_str(), r.workload.c_str(), r.width, r.height,
+                 r.threshold, r.fps, r.p50_us, r.p99_us, r.cpu_percent,
+                 r.upload_bytes, r.readback_bytes, r.keypoints);
+          fflush(stdout);
+          if (out.is_open()) write_result(&out, r);
+        }
+      }
+    }
+    accelerator->close();
+  }
+
+  if (out.close() != 0) result = 1;
+  return result;
+}
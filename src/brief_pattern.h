@@ -0,0 +1,280 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file brief_pattern.h
+ * @brief Reference BRIEF test pattern used by the accelerator
+ *
+ * Copy of hdl/BRIEF/generate_brief_rom/BRIEF_pattern.txt. Each entry holds
+ * the two points {{x0, y0}, {x1, y1}} of one binary test, before clamping to
+ * the 15 pixel radius and rotation. Test k sets bit k of the descriptor.
+ * Keep both files in sync: the ROMs in hdl/BRIEF/generate_brief_rom/roms are
+ * generated from the text file.
+ */
+
+#ifndef BRIEF_PATTERN_H
+#define BRIEF_PATTERN_H
+
+#include <stdint.h>
+
+#define BRIEF_PATTERN_SIZE 256  // Number of binary tests per descriptor
+
+static const int8_t brief_pattern[BRIEF_PATTERN_SIZE][2][2] = {
+    {{8, -3}, {9, 5}},
+    {{4, 2}, {7, -15}},
+    {{-11, 9}, {-8, 2}},
+    {{7, -15}, {15, -13}},
+    {{2, -13}, {2, 15}},
+    {{1, -7}, {1, 6}},
+    {{-2, -10}, {-2, -4}},
+    {{-13, -13}, {-11, -8}},
+    {{-13, -3}, {-15, -9}},
+    {{10, 4}, {11, 9}},
+    {{-13, -8}, {-8, -9}},
+    {{-11, 7}, {-9, 15}},
+    {{7, 7}, {15, 6}},
+    {{-4, -5}, {-3, 0}},
+    {{-13, 2}, {-15, -3}},
+    {{-9, 0}, {-7, 5}},
+    {{15, -6}, {15, -1}},
+    {{-3, 6}, {-2, 15}},
+    {{-6, -13}, {-4, -8}},
+    {{11, -13}, {15, -8}},
+    {{4, 7}, {5, 1}},
+    {{5, -3}, {10, -3}},
+    {{3, -7}, {6, 15}},
+    {{-8, -7}, {-6, -2}},
+    {{-2, 11}, {-1, -10}},
+    {{-13, 15}, {-8, 10}},
+    {{-7, 3}, {-5, -3}},
+    {{-4, 2}, {-3, 7}},
+    {{-10, -15}, {-6, 11}},
+    {{5, -15}, {6, -7}},
+    {{5, -6}, {7, -1}},
+    {{1, 0}, {4, -5}},
+    {{9, 11}, {11, -13}},
+    {{4, 7}, {4, 15}},
+    {{2, -1}, {4, 4}},
+    {{-4, -15}, {-2, 7}},
+    {{-8, -5}, {-7, -10}},
+    {{4, 11}, {9, 15}},
+    {{0, -8}, {1, -13}},
+    {{-13, -2}, {-8, 2}},
+    {{-3, -2}, {-2, 3}},
+    {{-6, 9}, {-4, -9}},
+    {{8, 15}, {10, 7}},
+    {{0, 9}, {1, 3}},
+    {{7, -5}, {11, -10}},
+    {{-13, -6}, {-11, 0}},
+    {{10, 7}, {15, 1}},
+    {{-6, -3}, {-6, 15}},
+    {{10, -9}, {15, -4}},
+    {{-13, 8}, {-8, -15}},
+    {{-13, 0}, {-8, -4}},
+    {{3, 3}, {7, 8}},
+    {{5, 7}, {10, -7}},
+    {{-1, 7}, {1, -15}},
+    {{3, -10}, {5, 6}},
+    {{2, -4}, {3, -10}},
+    {{-13, 0}, {-13, 5}},
+    {{-13, -7}, {-15, 15}},
+    {{-13, 3}, {-11, 8}},
+    {{-7, 15}, {-4, 7}},
+    {{6, -10}, {15, 8}},
+    {{-9, -1}, {-7, -6}},
+    {{-2, -5}, {0, 15}},
+    {{-15, 5}, {-7, 5}},
+    {{3, -10}, {8, -13}},
+    {{-7, -7}, {-4, 5}},
+    {{-3, -2}, {-1, -7}},
+    {{2, 9}, {5, -11}},
+    {{-11, -13}, {-5, -13}},
+    {{-1, 6}, {0, -1}},
+    {{5, -3}, {5, 2}},
+    {{-4, -13}, {-4, 15}},
+    {{-9, -6}, {-9, 6}},
+    {{-15, -10}, {-8, -4}},
+    {{10, 2}, {15, -3}},
+    {{7, 15}, {15, 15}},
+    {{-7, -13}, {-6, 5}},
+    {{-4, 9}, {-3, 4}},
+    {{7, -1}, {15, 2}},
+    {{-7, 6}, {-5, 1}},
+    {{-13, 11}, {-15, 5}},
+    {{-3, 7}, {-2, -6}},
+    {{7, -8}, {15, -7}},
+    {{-13, -7}, {-11, -15}},
+    {{1, -3}, {15, 15}},
+    {{2, -6}, {3, 0}},
+    {{-4, 3}, {-2, -13}},
+    {{-1, -13}, {1, 9}},
+    {{7, 1}, {8, -6}},
+    {{1, -1}, {3, 15}},
+    {{9, 1}, {15, 6}},
+    {{-1, -9}, {-1, 3}},
+    {{-13, -13}, {-10, 5}},
+    {{7, 7}, {10, 15}},
+    {{15, -5}, {15, 9}},
+    {{6, 3}, {7, 11}},
+    {{5, -13}, {6, 10}},
+    {{2, -15}, {2, 3}},
+    {{3, 8}, {4, -6}},
+    {{2, 6}, {15, -13}},
+    {{9, -15}, {10, 3}},
+    {{-8, 4}, {-7, 9}},
+    {{-11, 15}, {-4, -6}},
+    {{1, 15}, {2, -8}},
+    {{6, -9}, {7, -4}},
+    {{2, 3}, {3, -2}},
+    {{6, 3}, {11, 0}},
+    {{3, -3}, {8, -8}},
+    {{7, 8}, {9, 3}},
+    {{-11, -5}, {-6, -4}},
+    {{-10, 11}, {-5, 10}},
+    {{-5, -8}, {-3, 15}},
+    {{-10, 5}, {-9, 0}},
+    {{8, -1}, {15, -6}},
+    {{4, -6}, {6, -11}},
+    {{-10, 15}, {-8, 7}},
+    {{4, -2}, {6, 7}},
+    {{-2, 0}, {-2, 15}},
+    {{-5, -8}, {-5, 2}},
+    {{7, -6}, {10, 15}},
+    {{-9, -13}, {-8, -8}},
+    {{-5, -13}, {-5, -2}},
+    {{8, -8}, {9, -13}},
+    {{-9, -11}, {-9, 0}},
+    {{1, -8}, {1, -2}},
+    {{7, -4}, {9, 1}},
+    {{-2, 1}, {-1, -4}},
+    {{11, -6}, {15, -11}},
+    {{-15, -9}, {-6, 4}},
+    {{3, 7}, {7, 15}},
+    {{5, 5}, {10, 8}},
+    {{0, -4}, {2, 8}},
+    {{-9, 15}, {-5, -13}},
+    {{0, 7}, {2, 15}},
+    {{-1, 2}, {1, 7}},
+    {{5, 11}, {7, -9}},
+    {{3, 5}, {6, -8}},
+    {{-13, -4}, {-8, 9}},
+    {{-5, 9}, {-3, -3}},
+    {{-4, -7}, {-3, -15}},
+    {{6, 5}, {8, 0}},
+    {{-7, 6}, {-6, 15}},
+    {{-13, 6}, {-5, -2}},
+    {{1, -10}, {3, 10}},
+    {{4, 1}, {8, -4}},
+    {{-2, -2}, {2, -13}},
+    {{2, -15}, {15, 15}},
+    {{-2, -13}, {0, -6}},
+    {{4, 1}, {9, 3}},
+    {{-6, -10}, {-3, -5}},
+    {{-3, -13}, {-1, 1}},
+    {{7, 5}, {15, -11}},
+    {{4, -2}, {5, -7}},
+    {{-13, 9}, {-9, -5}},
+    {{7, 1}, {8, 6}},
+    {{7, -8}, {7, 6}},
+    {{-7, -4}, {-7, 1}},
+    {{-8, 11}, {-7, -8}},
+    {{-13, 6}, {-15, -8}},
+    {{2, 4}, {3, 9}},
+    {{10, -5}, {15, 3}},
+    {{-6, -5}, {-6, 7}},
+    {{8, -3}, {9, -8}},
+    {{2, -15}, {2, 8}},
+    {{-11, -2}, {-10, 3}},
+    {{-15, -13}, {-7, -9}},
+    {{-11, 0}, {-10, -5}},
+    {{5, -3}, {11, 8}},
+    {{-2, -13}, {-1, 15}},
+    {{-1, -8}, {0, 9}},
+    {{-13, -11}, {-15, -5}},
+    {{-10, -2}, {-10, 11}},
+    {{-3, 9}, {-2, -13}},
+    {{2, -3}, {3, 2}},
+    {{-9, -13}, {-4, 0}},
+    {{-4, 6}, {-3, -10}},
+    {{-4, 15}, {-2, -7}},
+    {{-6, -11}, {-4, 9}},
+    {{6, -3}, {6, 11}},
+    {{-13, 11}, {-5, 5}},
+    {{11, 11}, {15, 6}},
+    {{7, -5}, {15, -2}},
+    {{-1, 15}, {0, 7}},
+    {{-4, -8}, {-3, -2}},
+    {{-7, 1}, {-6, 7}},
+    {{-13, -15}, {-8, -13}},
+    {{-7, -2}, {-6, -8}},
+    {{-8, 5}, {-6, -9}},
+    {{-5, -1}, {-4, 5}},
+    {{-13, 7}, {-8, 10}},
+    {{1, 5}, {5, -13}},
+    {{1, 0}, {10, -13}},
+    {{9, 15}, {10, -1}},
+    {{5, -8}, {10, -9}},
+    {{-1, 11}, {1, -13}},
+    {{-9, -3}, {-6, 2}},
+    {{-1, -10}, {1, 15}},
+    {{-13, 1}, {-8, -10}},
+    {{8, -11}, {10, -6}},
+    {{2, -13}, {3, -6}},
+    {{7, -13}, {15, -9}},
+    {{-10, -10}, {-5, -7}},
+    {{-10, -8}, {-8, -13}},
+    {{4, -6}, {8, 5}},
+    {{3, 15}, {8, -13}},
+    {{-4, 2}, {-3, -3}},
+    {{5, -13}, {10, -15}},
+    {{4, -13}, {5, -1}},
+    {{-9, 9}, {-4, 3}},
+    {{0, 3}, {3, -9}},
+    {{-15, 1}, {-6, 1}},
+    {{3, 2}, {4, -8}},
+    {{-10, -10}, {-10, 9}},
+    {{8, -13}, {15, 15}},
+    {{-8, -15}, {-6, -5}},
+    {{2, 2}, {3, 7}},
+    {{10, 6}, {11, -8}},
+    {{6, 8}, {8, -15}},
+    {{-7, 10}, {-6, 5}},
+    {{-3, -9}, {-3, 9}},
+    {{-1, -13}, {-1, 5}},
+    {{-3, -7}, {-3, 4}},
+    {{-8, -2}, {-8, 3}},
+    {{4, 2}, {15, 15}},
+    {{2, -5}, {3, 11}},
+    {{6, -9}, {11, -13}},
+    {{3, -1}, {7, 15}},
+    {{11, -1}, {15, 4}},
+    {{-3, 0}, {-3, 6}},
+    {{4, -11}, {4, 15}},
+    {{2, -4}, {2, 1}},
+    {{-10, -6}, {-8, 1}},
+    {{-13, 7}, {-11, 1}},
+    {{-13, 15}, {-11, -13}},
+    {{6, 0}, {11, -13}},
+    {{0, -1}, {1, 4}},
+    {{-13, 3}, {-9, -2}},
+    {{-9, 8}, {-6, -3}},
+    {{-13, -6}, {-8, -2}},
+    {{5, -9}, {8, 10}},
+    {{2, 7}, {3, -9}},
+    {{-1, -6}, {-1, -1}},
+    {{9, 5}, {11, -2}},
+    {{11, -3}, {15, -8}},
+    {{3, 0}, {3, 5}},
+    {{-1, 4}, {0, 10}},
+    {{3, -6}, {4, 5}},
+    {{-13, 0}, {-10, 5}},
+    {{5, 8}, {15, 11}},
+    {{8, 9}, {9, -6}},
+    {{7, -4}, {8, -15}},
+    {{-10, 4}, {-10, 9}},
+    {{7, 3}, {15, 4}},
+    {{9, -7}, {10, -2}},
+    {{7, 0}, {15, -2}},
+    {{-1, -6}, {0, -11}}
+};
+
+#endif  // BRIEF_PATTERN_H
@@ -0,0 +1,291 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file fifo_sizing.cpp
+ * @brief Feature FIFO and constructor sizing on recorded frames
+ *
+ * Replays frames through the software model with every combination of
+ * feature FIFO depth and descriptor constructors per level, and reports per
+ * level the FIFO high water and the features dropped on a full FIFO and on
+ * a busy constructor, the counters orb_counters keeps in the fabric.
+ *
+ * A feature leaves the FIFO when the orientation window reaches it, a fixed
+ * number of lines after FAST found it, so the FIFO holds the features of
+ * that window whatever the constructors do. A constructor that is busy at
+ * that moment loses the feature instead of stalling the FIFO. Full FIFO
+ * drops therefore depend on the depth alone, while a deeper FIFO lets more
+ * features reach the constructors and raises the busy drops. The summary
+ * gives the smallest depth without full FIFO drops, and the fewest
+ * constructors without busy drops behind the deepest FIFO of the sweep.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "orb_accelerator.h"
+#include "tool_common.h"
+
+// ============================================================================
+// SIZING
+// ============================================================================
+
+/**
+ * @brief Counters of one level over the frames of one configuration
+ */
+struct LevelTally {
+  uint32_t high_water;    // Highest of the frames
+  uint64_t high_water_sum;
+  uint64_t fifo_dropped;
+  uint64_t busy_dropped;
+
+  LevelTally()
+      : high_water(0), high_water_sum(0), fifo_dropped(0), busy_dropped(0) {}
+};
+
+/**
+ * @brief One FIFO depth and constructor count, and its tallies
+ */
+struct Sizing {
+  int fifo_size;
+  int constructors;
+  uint64_t descriptors;
+  std::vector<LevelTally> levels;
+};
+
+/**
+ * @brief Integers of a comma separated list
+ */
+static std::vector<int> split_ints(const std::string &list) {
+  std::vector<std::string> items = split_list(list);
+  std::vector<int> values;
+  for (size_t i = 0; i < items.size(); i++) {
+    values.push_back(static_cast<int>(strtol(items[i].c_str(), nullptr, 10)));
+  }
+  return values;
+}
+
+/**
+ * @brief Run the frames through the model of one sizing
+ */
+static void run_sizing(const OrbModelConfig &model_config,
+                       const std::vector<cv::Mat> &frames, int threshold,
+                       Sizing *sizing) {
+  OrbModel model(model_config);
+  std::vector<OrbFeature> features;
+  uint32_t counters[PERF_WORDS];
+  sizing->descriptors = 0;
+  sizing->levels.assign(model_config.num_scales, LevelTally());
+  for (size_t f = 0; f < frames.size(); f++) {
+    model.process(frames[f].ptr<uint8_t>(0),
+                  static_cast<int>(frames[f].step), threshold, -threshold,
+                  &features);
+    model.store_counters(counters);
+    sizing->descriptors += counters[PERF_DESCRIPTORS];
+    for (int s = 0; s < model_config.num_scales; s++) {
+      LevelTally &level = sizing->levels[s];
+      level.high_water =
+          std::max(level.high_water, counters[PERF_FIFO_HIGH_WATER + s]);
+      level.high_water_sum += counters[PERF_FIFO_HIGH_WATER + s];
+      level.fifo_dropped += counters[PERF_LEVEL_FIFO_DROPPED + s];
+      level.busy_dropped += counters[PERF_LEVEL_BUSY_DROPPED + s];
+    }
+  }
+}
+
+/**
+ * @brief Write the records of a sizing, one per level
+ */
+static void write_sizing(RecordWriter *out, const Sizing &sizing,
+                         size_t frames) {
+  double n = static_cast<double>(frames);
+  for (size_t s = 0; s < sizing.levels.size(); s++) {
+    const LevelTally &level = sizing.levels[s];
+    out->integer("fifo_size", sizing.fifo_size);
+    out->integer("constructors", sizing.constructors);
+    out->integer("level", s);
+    out->integer("frames", frames);
+    out->integer("high_water", level.high_water);
+    out->number("mean_high_water", level.high_water_sum / n, 1);
+    out->number("fifo_dropped", level.fifo_dropped / n, 2);
+    out->number("busy_dropped", level.busy_dropped / n, 2);
+    out->number("descriptors", sizing.descriptors / n, 1);
+    out->end_record();
+  }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+/**
+ * @brief Sweep the FIFO depths and constructor counts over the frames
+ * @return 0 on success, 1 on error
+ */
+int main(int argc, char const *argv[]) {
+  std::string config_path;
+  std::string out_path;
+  std::string fifo_sizes = "64,128,256,512";
+  std::string constructors = "1,2,3,4";
+  int threshold = 20;
+
+  int arg = 1;
+  while (argc > arg + 1 && std::string(argv[arg]).compare(0, 2, "--") == 0) {
+    std::string option = argv[arg];
+    std::string value = argv[arg + 1];
+    if (option == "--config") {
+      config_path = value;
+    } else if (option == "--out") {
+      out_path = value;
+    } else if (option == "--threshold") {
+      threshold = static_cast<int>(strtol(value.c_str(), nullptr, 10));
+    } else if (option == "--fifo-sizes") {
+      fifo_sizes = value;
+    } else if (option == "--constructors") {
+      constructors = value;
+    } else {
+      break;
+    }
+    arg += 2;
+  }
+
+  std::vector<int> fifo_list = split_ints(fifo_sizes);
+  std::vector<int> constructor_list = split_ints(constructors);
+  if (argc < arg + 1 || std::string(argv[arg]).compare(0, 2, "--") == 0 ||
+      fifo_list.empty() || constructor_list.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--config file] [--threshold t] [--fifo-sizes n,...] "
+                 "[--constructors n,...] [--out file] "
+                 "<image|directory|glob>..."
+              << std::endl;
+    std::cerr << "  --threshold: FAST threshold (default: 20)" << std::endl;
+    std::cerr << "  --fifo-sizes: Feature FIFO depths, powers of two "
+                 "(default: 64,128,256,512)"
+              << std::endl;
+    std::cerr << "  --constructors: Descriptor constructors per level "
+                 "(default: 1,2,3,4)"
+              << std::endl;
+    std::cerr << RESULTS_OUT_USAGE << std::endl;
+    return 1;
+  }
+  std::sort(fifo_list.begin(), fifo_list.end());
+  std::sort(constructor_list.begin(), constructor_list.end());
+
+  OrbAcceleratorConfig config;
+  if (load_bitstream_config(&config_path, &config) != 0) return 1;
+
+  cv::Size size(config.line_size, config.num_lines);
+  std::vector<cv::Mat> frames;
+  struct stat info;
+  for (; arg < argc; arg++) {
+    std::vector<cv::String> paths;
+    std::string input = argv[arg];
+    if (stat(input.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+      cv::glob(input + "/*", paths);
+    } else {
+      cv::glob(input, paths);
+    }
+    std::sort(paths.begin(), paths.end());
+    for (size_t p = 0; p < paths.size(); p++) {
+      cv::Mat gray = cv::imread(paths[p], cv::IMREAD_GRAYSCALE);
+      if (gray.empty()) continue;
+      if (gray.size() != size) cv::resize(gray, gray, size);
+      frames.push_back(gray);
+    }
+  }
+  if (frames.empty()) {
+    std::cerr << "No frames to replay" << std::endl;
+    return 1;
+  }
+
+  // Geometry of the bitstream; only the FIFO and the constructors change
+  OrbModelConfig model_config;
+  model_config.line_size = config.line_size;
+  model_config.num_lines = config.num_lines;
+  model_config.num_scales = config.num_scales;
+  model_config.theta_size = config.theta_size;
+  model_config.feature_lines = config.feature_lines;
+  model_config.grid_cols = config.grid_cols;
+  model_config.grid_rows = config.grid_rows;
+  model_config.cell_k = config.cell_k;
+  model_config.match_refs = 0;
+
+  std::vector<Sizing> sizings;
+  for (size_t f = 0; f < fifo_list.size(); f++) {
+    for (size_t c = 0; c < constructor_list.size(); c++) {
+      Sizing sizing;
+      sizing.fifo_size = fifo_list[f];
+      sizing.constructors = constructor_list[c];
+      model_config.fifo_size = sizing.fifo_size;
+      model_config.constructors = sizing.constructors;
+      run_sizing(model_config, frames, threshold, &sizing);
+      sizings.push_back(sizing);
+    }
+  }
+
+  // ========================================================================
+  // RESULTS
+  // ========================================================================
+
+  RecordWriter out;
+  if (!out_path.empty() && out.open(out_path) != 0) return 1;
+
+  printf("%zu frames at %dx%d, threshold %d; drops per frame\n",
+         frames.size(), size.width, size.height, threshold);
+  for (size_t i = 0; i < sizings.size(); i++) {
+    const Sizing &sizing = sizings[i];
+    uint64_t fifo_dropped = 0;
+    uint64_t busy_dropped = 0;
+    uint32_t high_water = 0;
+    for (size_t s = 0; s < sizing.levels.size(); s++) {
+      fifo_dropped += sizing.levels[s].fifo_dropped;
+      busy_dropped += sizing.levels[s].busy_dropped;
+      high_water = std::max(high_water, sizing.levels[s].high_water);
+    }
+    double n = static_cast<double>(frames.size());
+    printf("FIFO %4d, %d constructors: high water %u, dropped %.2f full "
+           "and %.2f busy, %.1f descriptors\n",
+           sizing.fifo_size, sizing.constructors, high_water,
+           fifo_dropped / n, busy_dropped / n, sizing.descriptors / n);
+    if (out.is_open()) write_sizing(&out, sizing, frames.size());
+  }
+  if (out.close() != 0) return 1;
+
+  // Smallest FIFO and constructor count without drops of their kind, the
+  // constructors behind the deepest FIFO, which feeds them the most
+  int fifo_needed = 0;
+  int constructors_needed = 0;
+  for (size_t i = 0; i < sizings.size(); i++) {
+    const Sizing &sizing = sizings[i];
+    uint64_t fifo_dropped = 0;
+    uint64_t busy_dropped = 0;
+    for (size_t s = 0; s < sizing.levels.size(); s++) {
+      fifo_dropped += sizing.levels[s].fifo_dropped;
+      busy_dropped += sizing.levels[s].busy_dropped;
+    }
+    if (fifo_dropped == 0 && fifo_needed == 0) fifo_needed = sizing.fifo_size;
+    if (busy_dropped == 0 && sizing.fifo_size == fifo_list.back() &&
+        (constructors_needed == 0 ||
+         sizing.constructors < constructors_needed)) {
+      constructors_needed = sizing.constructors;
+    }
+  }
+  if (fifo_needed > 0) {
+    printf("No full FIFO drops from a FIFO of %d\n", fifo_needed);
+  } else {
+    printf("Every FIFO size dropped features on a full FIFO\n");
+  }
+  if (constructors_needed > 0) {
+    printf("No busy constructor drops behind a FIFO of %d from %d "
+           "constructors per level\n",
+           fifo_list.back(), constructors_needed);
+  } else {
+    printf("Every constructor count dropped features on a busy "
+           "constructor\n");
+  }
+  return 0;
+}
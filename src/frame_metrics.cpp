@@ -0,0 +1,162 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file frame_metrics.cpp
+ * @brief Per-frame record of OrbFrameMetrics
+ */
+
+#include "frame_metrics.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+
+#include "tool_common.h"
+
+/**
+ * @brief Write ", \"name\": [v0, v1, ...]" with the PERF_LEVELS values
+ * @return Result of the last fprintf
+ */
+template <typename T>
+static int write_levels(FILE *file, const char *name, const T *values) {
+  int written = fprintf(file, ", \"%s\": [", name);
+  for (int level = 0; level < PERF_LEVELS && written >= 0; level++) {
+    written = fprintf(file, level > 0 ? ", %" PRIu64 : "%" PRIu64,
+                      static_cast<uint64_t>(values[level]));
+  }
+  if (written >= 0) written = fprintf(file, "]");
+  return written;
+}
+
+const char *frame_bound(const OrbFrameMetrics &metrics) {
+  double host_us = metrics.pack_us + metrics.readback_us;
+  if (metrics.has_counters && metrics.counters.stream_cycles > 0) {
+    const OrbPerfCounters &counters = metrics.counters;
+    double fed = static_cast<double>(counters.pixels) /
+                 static_cast<double>(counters.stream_cycles);
+    if (fed >= FRAME_FABRIC_BOUND) return "fabric";
+    return metrics.upload_us > metrics.pack_us ? "bus" : "host";
+  }
+  if (metrics.wait_us >= host_us && metrics.wait_us >= metrics.upload_us) {
+    return "fabric";
+  }
+  return metrics.upload_us > host_us ? "bus" : "host";
+}
+
+FrameMetricsWriter::FrameMetricsWriter()
+    : file_(NULL), json_(false), failed_(false), frames_(0) {}
+
+FrameMetricsWriter::~FrameMetricsWriter() { close(); }
+
+int FrameMetricsWriter::open(const std::string &path) {
+  json_ = results_json(path);
+  file_ = fopen(path.c_str(), "w");
+  if (!file_) {
+    perror("fopen(frame metrics)");
+    return -1;
+  }
+  failed_ = false;
+  frames_ = 0;
+  if (!json_ &&
+      fprintf(file_,
+              "frame,timestamp_ns,bound,keypoints,tiles,decode_us,pack_us,"
+              "upload_us,wait_us,readback_us,output_us,upload_bytes,"
+              "readback_bytes,pixels,candidates,survivors,descriptors,"
+              "fifo_full_cycles,fifo_dropped,busy_dropped,"
+              "constructor_busy_cycles,stream_cycles,drain_cycles,cycles,"
+              "fifo_high_water\n") <
+          0) {
+    failed_ = true;
+  }
+  return failed_ ? -1 : 0;
+}
+
+int FrameMetricsWriter::write(uint64_t frame_id, int64_t timestamp_ns,
+                              const OrbFrameMetrics &metrics) {
+  if (!file_ || failed_) return -1;
+  const OrbPerfCounters &c = metrics.counters;
+  int written;
+  if (json_) {
+    written = fprintf(
+        file_,
+        "{\"frame\": %" PRIu64 ", \"timestamp_ns\": %" PRId64
+        ", \"bound\": \"%s\", \"keypoints\": %d, \"tiles\": %d"
+        ", \"decode_us\": %.1f, \"pack_us\": %.1f, \"upload_us\": %.1f"
+        ", \"wait_us\": %.1f, \"readback_us\": %.1f, \"output_us\": %.1f"
+        ", \"upload_bytes\": %" PRIu64 ", \"readback_bytes\": %" PRIu64,
+        frame_id, timestamp_ns, frame_bound(metrics), metrics.keypoints,
+        metrics.tiles, metrics.decode_us, metrics.pack_us, metrics.upload_us,
+        metrics.wait_us, metrics.readback_us, metrics.output_us,
+        metrics.upload_bytes, metrics.readback_bytes);
+    if (written >= 0 && metrics.has_counters) {
+      written = fprintf(
+          file_,
+          ", \"counters\": {\"pixels\": %" PRIu64 ", \"candidates\": %" PRIu64
+          ", \"survivors\": %" PRIu64 ", \"descriptors\": %" PRIu64
+          ", \"fifo_full_cycles\": %" PRIu64 ", \"fifo_dropped\": %" PRIu64
+          ", \"busy_dropped\": %" PRIu64
+          ", \"constructor_busy_cycles\": %" PRIu64
+          ", \"stream_cycles\": %" PRIu64 ", \"drain_cycles\": %" PRIu64
+          ", \"cycles\": %" PRIu64,
+          c.pixels, c.candidates, c.survivors, c.descriptors,
+          c.fifo_full_cycles, c.fifo_dropped, c.busy_dropped,
+          c.constructor_busy_cycles, c.stream_cycles, c.drain_cycles,
+          c.cycles);
+      if (written >= 0) {
+        written = write_levels(file_, "fifo_high_water", c.fifo_high_water);
+      }
+      if (written >= 0) {
+        written =
+            write_levels(file_, "level_fifo_dropped", c.level_fifo_dropped);
+      }
+      if (written >= 0) {
+        written =
+            write_levels(file_, "level_busy_dropped", c.level_busy_dropped);
+      }
+      if (written >= 0) written = fprintf(file_, "}");
+    }
+    if (written >= 0) written = fprintf(file_, "}\n");
+  } else {
+    written = fprintf(file_,
+                      "%" PRIu64 ",%" PRId64 ",%s,%d,%d,%.1f,%.1f,%.1f,%.1f,"
+                      "%.1f,%.1f,%" PRIu64 ",%" PRIu64,
+                      frame_id, timestamp_ns, frame_bound(metrics),
+                      metrics.keypoints, metrics.tiles, metrics.decode_us,
+                      metrics.pack_us, metrics.upload_us, metrics.wait_us,
+                      metrics.readback_us, metrics.output_us,
+                      metrics.upload_bytes, metrics.readback_bytes);
+    // Counter columns stay empty without orb_counters
+    if (written >= 0 && metrics.has_counters) {
+      written = fprintf(
+          file_,
+          ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+          ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+          ",%" PRIu64 ",%" PRIu32 "\n",
+          c.pixels, c.candidates, c.survivors, c.descriptors,
+          c.fifo_full_cycles, c.fifo_dropped, c.busy_dropped,
+          c.constructor_busy_cycles, c.stream_cycles, c.drain_cycles,
+          c.cycles,
+          *std::max_element(c.fifo_high_water,
+                            c.fifo_high_water + PERF_LEVELS));
+    } else if (written >= 0) {
+      written = fprintf(file_, ",,,,,,,,,,,,\n");
+    }
+  }
+  if (written < 0) {
+    perror("fprintf(frame metrics)");
+    failed_ = true;
+    return -1;
+  }
+  frames_++;
+  return 0;
+}
+
+int FrameMetricsWriter::close() {
+  if (!file_) return failed_ ? -1 : 0;
+  if (fclose(file_) != 0) {
+    perror("fclose(frame metrics)");
+    failed_ = true;
+  }
+  file_ = NULL;
+  return failed_ ? -1 : 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file frame_metrics.h
+ * @brief Per-frame record of OrbFrameMetrics, to find what a slow frame
+ *        waited on
+ *
+ * One line per frame: the host stage times and, with orb_counters in the
+ * bitstream, the fabric counters. A path ending in ".json" gives JSON
+ * Lines, one object per frame, with the FIFO high water and the drops of
+ * every level; any other path gives CSV with a header, with the highest
+ * FIFO high water of the levels.
+ */
+
+#ifndef FRAME_METRICS_H
+#define FRAME_METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+#include "orb_accelerator.h"
+
+/**
+ * @brief Fraction of the stream cycles with a pixel above which the fabric
+ *        is taken as the bound of a frame
+ */
+#define FRAME_FABRIC_BOUND 0.9
+
+/**
+ * @brief Stage that bounded a frame: "host", "bus" or "fabric"
+ *
+ * With counters, a fabric fed a pixel in nearly every stream cycle is the
+ * bound; otherwise it waited for pixels, on the bus if the DMA took longer
+ * than packing, else on the host. Without counters, the largest of the
+ * host stages (pack and readback), the DMA and the wait on the fabric.
+ */
+const char *frame_bound(const OrbFrameMetrics &metrics);
+
+class FrameMetricsWriter {
+ public:
+  FrameMetricsWriter();
+  ~FrameMetricsWriter();
+
+  /**
+   * @brief Create or truncate the file, CSV writes its header
+   * @return 0 on success, -1 on error
+   */
+  int open(const std::string &path);
+
+  /**
+   * @brief Append the line of a frame
+   * @return 0 on success, -1 on error
+   */
+  int write(uint64_t frame_id, int64_t timestamp_ns,
+            const OrbFrameMetrics &metrics);
+
+  /**
+   * @brief Flush and close the file
+   * @return 0 if every line was written, -1 otherwise
+   */
+  int close();
+
+  uint64_t frames() const { return frames_; }
+
+ private:
+  FILE *file_;
+  bool json_;
+  bool failed_;
+  uint64_t frames_;
+};
+
+#endif  // FRAME_METRICS_H
@@ -1 +1,48 @@
 bootgen -image gen_bin.bif -arch zynq -process_bitstream bin
+
+# Sidecar with the geometry of the bitstream, read by the host at start-up.
+# Taken from the block design the bitstream was built from.
+tcl=${1:-../ORB_sample_bd.tcl}
+config="ORB_writeDescriptHold.cfg"
+
+# generic <cell> <generic> <default>: value of a generic of a block design
+# cell, either a literal ({640}) or a variable set at the top ($theta_size)
+generic() {
+  value=$(tr -d '\r' < "$tcl" | awk -v cell="\$$1" -v key="CONFIG.$2" '
+    /set_property -dict/ { found = "" }
+    $1 == key { found = $2; gsub(/[{}]/, "", found) }
+    $1 == "]" && $2 == cell && found != "" { print found; exit }')
+  case "$value" in
+    \$*)
+      value=$(tr -d '\r' < "$tcl" | awk -v name="${value#\$}" '
+        $1 == "set" && $2 == name { print $3; exit }') ;;
+  esac
+  echo "${value:-$3}"
+}
+
+ping_pong=0
+if [ "$(generic get_pix_0 PING_PONG false)" = "true" ]; then ping_pong=1; fi
+chunk_irq=0
+if grep -q "get_pix_0/chunk_done" "$tcl"; then chunk_irq=1; fi
+perf_counters=0
+if grep -q "orb_counters_0" "$tcl"; then perf_counters=1; fi
+
+cat > "$config" <<END
+# Generated by gen_bit-bin.sh from $tcl
+line_size = $(generic orb_0 ACONF_LINE_SIZE 640)
+num_lines = $(generic orb_0 ACONF_NUM_LINES 480)
+num_scales = $(generic orb_0 ACONF_NUM_SCALES 3)
+theta_size = $(generic orb_0 ACONF_THETA_SIZE 3)
+fifo_size = $(generic orb_0 ACONF_FEATURE_FIFO_SIZE 256)
+constructors = $(generic orb_0 ACONF_NUM_CONSTRUCTORS 1)
+mem_size_pix = $(generic get_pix_0 MEM_SIZE 65528)
+ping_pong = $ping_pong
+chunk_irq = $chunk_irq
+feature_lines = $(generic write_descriptors_0 FEATURE_LINES 512)
+grid_cols = $(generic write_descriptors_0 GRID_X 1)
+grid_rows = $(generic write_descriptors_0 GRID_Y 1)
+cell_k = $(generic write_descriptors_0 CELL_K 512)
+match_refs = $(generic descriptor_match_0 MAX_REFS 0)
+match_queue = $(generic descriptor_match_0 QUEUE_DEPTH 16)
+perf_counters = $perf_counters
+END
@@ -0,0 +1,322 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file hamming_matcher.cpp
+ * @brief Brute-force Hamming matcher of 256-bit descriptors on the host
+ */
+
+#include "hamming_matcher.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define NO_DISTANCE (DESCRIPTOR_BYTES * 8 + 1)  // Above any distance
+
+// ============================================================================
+// DISTANCE KERNELS
+// ============================================================================
+
+#if defined(__ARM_NEON)
+
+/**
+ * @brief A descriptor in registers, two 16-byte halves
+ */
+struct LoadedDescriptor {
+  uint8x16_t lo;
+  uint8x16_t hi;
+};
+
+static inline LoadedDescriptor load_descriptor(const uint8_t *descriptor) {
+  LoadedDescriptor loaded = {vld1q_u8(descriptor),
+                             vld1q_u8(descriptor + 16)};
+  return loaded;
+}
+
+/**
+ * vcnt counts the bits of each byte, the halves add up to at most 16 per
+ * byte, and pairwise widening adds fold the 16 bytes into two lanes.
+ */
+static inline uint8x16_t byte_counts(const LoadedDescriptor &a,
+                                     const LoadedDescriptor &b) {
+  return vaddq_u8(vcntq_u8(veorq_u8(a.lo, b.lo)),
+                  vcntq_u8(veorq_u8(a.hi, b.hi)));
+}
+
+static inline int distance(const LoadedDescriptor &a,
+                           const LoadedDescriptor &b) {
+  uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(byte_counts(a, b))));
+  return static_cast<int>(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+}
+
+/**
+ * @brief Distances of a query to four trains, reduced together
+ *
+ * Each train folds to four 16-bit sums, and two rounds of pairwise adds
+ * leave one lane per train.
+ */
+static inline void distance4(const LoadedDescriptor &query,
+                             const LoadedDescriptor *trains, int *out) {
+  uint16x4_t sums[4];
+  for (int i = 0; i < 4; i++) {
+    uint16x8_t wide = vpaddlq_u8(byte_counts(query, trains[i]));
+    sums[i] = vadd_u16(vget_low_u16(wide), vget_high_u16(wide));
+  }
+  uint16x4_t total =
+      vpadd_u16(vpadd_u16(sums[0], sums[1]), vpadd_u16(sums[2], sums[3]));
+  uint16_t lanes[4];
+  vst1_u16(lanes, total);
+  for (int i = 0; i < 4; i++) out[i] = lanes[i];
+}
+
+#elif defined(__AVX2__)
+
+typedef __m256i LoadedDescriptor;
+
+static inline LoadedDescriptor load_descriptor(const uint8_t *descriptor) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(descriptor));
+}
+
+/**
+ * Bits of each nibble from a 16-entry table (vpshufb), then vpsadbw adds
+ * the bytes into four 64-bit lanes.
+ */
+static inline __m256i lane_counts(const LoadedDescriptor &a,
+                                  const LoadedDescriptor &b) {
+  const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3,
+                                         2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3,
+                                         1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  __m256i bits = _mm256_xor_si256(a, b);
+  __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(bits, nibble));
+  __m256i hi = _mm256_shuffle_epi8(
+      table, _mm256_and_si256(_mm256_srli_epi16(bits, 4), nibble));
+  return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+static inline int distance(const LoadedDescriptor &a,
+                           const LoadedDescriptor &b) {
+  __m256i sum = lane_counts(a, b);
+  return static_cast<int>(
+      _mm256_extract_epi64(sum, 0) + _mm256_extract_epi64(sum, 1) +
+      _mm256_extract_epi64(sum, 2) + _mm256_extract_epi64(sum, 3));
+}
+
+/**
+ * @brief Distances of a query to four trains, reduced together
+ *
+ * The four 64-bit sums of a train fit in 32 bits, so two trains share
+ * each lane; unpacks and two adds then leave one 32-bit lane per train.
+ */
+static inline void distance4(const LoadedDescriptor &query,
+                             const LoadedDescriptor *trains, int *out) {
+  __m256i ab = _mm256_or_si256(
+      lane_counts(query, trains[0]),
+      _mm256_slli_epi64(lane_counts(query, trains[1]), 32));
+  __m256i cd = _mm256_or_si256(
+      lane_counts(query, trains[2]),
+      _mm256_slli_epi64(lane_counts(query, trains[3]), 32));
+  __m256i halves = _mm256_add_epi32(_mm256_unpacklo_epi64(ab, cd),
+                                    _mm256_unpackhi_epi64(ab, cd));
+  __m128i total = _mm_add_epi32(_mm256_castsi256_si128(halves),
+                                _mm256_extracti128_si256(halves, 1));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), total);
+}
+
+#else
+
+/**
+ * @brief A descriptor as four 64-bit words, counted with the popcount
+ *        builtin (POPCNT with -mpopcnt)
+ */
+struct LoadedDescriptor {
+  uint64_t words[4];
+};
+
+static inline LoadedDescriptor load_descriptor(const uint8_t *descriptor) {
+  LoadedDescriptor loaded;
+  memcpy(loaded.words, descriptor, sizeof(loaded.words));
+  return loaded;
+}
+
+static inline int distance(const LoadedDescriptor &a,
+                           const LoadedDescriptor &b) {
+  return __builtin_popcountll(a.words[0] ^ b.words[0]) +
+         __builtin_popcountll(a.words[1] ^ b.words[1]) +
+         __builtin_popcountll(a.words[2] ^ b.words[2]) +
+         __builtin_popcountll(a.words[3] ^ b.words[3]);
+}
+
+static inline void distance4(const LoadedDescriptor &query,
+                             const LoadedDescriptor *trains, int *out) {
+  for (int i = 0; i < 4; i++) out[i] = distance(query, trains[i]);
+}
+
+#endif
+
+int hamming_distance(const uint8_t *a, const uint8_t *b) {
+  return distance(load_descriptor(a), load_descriptor(b));
+}
+
+// ============================================================================
+// BLOCKED SEARCH
+// ============================================================================
+
+/**
+ * @brief Nearest two trains of the queries [first, last)
+ *
+ * Trains are visited in index order and replace a neighbour only when
+ * strictly nearer, so ties keep the lower index.
+ */
+static void knn_block(const uint8_t *query, int first, int last,
+                      const uint8_t *train, int train_count,
+                      KeypointMatch *matches) {
+  LoadedDescriptor queries[MATCH_QUERY_BLOCK];
+  int n = last - first;
+  for (int q = 0; q < n; q++) {
+    queries[q] = load_descriptor(
+        query + static_cast<size_t>(first + q) * DESCRIPTOR_BYTES);
+    KeypointMatch &match = matches[first + q];
+    match.best = -1;
+    match.best_distance = NO_DISTANCE;
+    match.second = -1;
+    match.second_distance = NO_DISTANCE;
+  }
+
+  for (int block = 0; block < train_count; block += MATCH_TRAIN_BLOCK) {
+    int end = std::min(block + MATCH_TRAIN_BLOCK, train_count);
+    for (int t = block; t < end; t += 4) {
+      // Four trains at a time, the tail of the set one by one
+      int group = std::min(4, end - t);
+      LoadedDescriptor trains[4];
+      for (int i = 0; i < group; i++) {
+        trains[i] = load_descriptor(train + static_cast<size_t>(t + i) *
+                                                DESCRIPTOR_BYTES);
+      }
+      for (int q = 0; q < n; q++) {
+        int d[4] = {NO_DISTANCE, NO_DISTANCE, NO_DISTANCE, NO_DISTANCE};
+        if (group == 4) {
+          distance4(queries[q], trains, d);
+        } else {
+          for (int i = 0; i < group; i++) {
+            d[i] = distance(queries[q], trains[i]);
+          }
+        }
+        // Most groups hold nothing nearer than the second neighbour
+        KeypointMatch &match = matches[first + q];
+        int nearest = std::min(std::min(d[0], d[1]), std::min(d[2], d[3]));
+        if (nearest >= match.second_distance) continue;
+        for (int i = 0; i < group; i++) {
+          if (d[i] < match.best_distance) {
+            match.second = match.best;
+            match.second_distance = match.best_distance;
+            match.best = t + i;
+            match.best_distance = d[i];
+          } else if (d[i] < match.second_distance) {
+            match.second = t + i;
+            match.second_distance = d[i];
+          }
+        }
+      }
+    }
+  }
+
+  for (int q = 0; q < n; q++) {
+    KeypointMatch &match = matches[first + q];
+    if (match.best < 0) match.best_distance = 0;
+    if (match.second < 0) match.second_distance = 0;
+  }
+}
+
+// ============================================================================
+// MATCHER
+// ============================================================================
+
+HammingMatcher::HammingMatcher(const HammingMatcherConfig &config)
+    : config_(config) {
+  if (config_.threads <= 0) {
+    config_.threads =
+        std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  }
+}
+
+void HammingMatcher::knn(const uint8_t *query, int query_count,
+                         const uint8_t *train, int train_count,
+                         std::vector<KeypointMatch> *matches) {
+  matches->resize(query_count);
+  int blocks = (query_count + MATCH_QUERY_BLOCK - 1) / MATCH_QUERY_BLOCK;
+  int threads = config_.threads;
+  if (static_cast<int64_t>(query_count) * train_count <
+      MATCH_MIN_THREAD_PAIRS) {
+    threads = 1;
+  }
+  threads = std::max(std::min(threads, blocks), 1);
+
+  // Blocks of queries are taken in turn, so uneven threads still balance
+  std::atomic<int> next(0);
+  KeypointMatch *out = matches->data();
+  auto worker = [&]() {
+    for (int block = next++; block < blocks; block = next++) {
+      int first = block * MATCH_QUERY_BLOCK;
+      int last = std::min(first + MATCH_QUERY_BLOCK, query_count);
+      knn_block(query, first, last, train, train_count, out);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; i++) workers.push_back(std::thread(worker));
+  worker();
+  for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+}
+
+void HammingMatcher::knn(const KeypointBatch &query,
+                         const KeypointBatch &train,
+                         std::vector<KeypointMatch> *matches) {
+  knn(query.descriptors.data(), query.count, train.descriptors.data(),
+      train.count, matches);
+}
+
+int HammingMatcher::match(const uint8_t *query, int query_count,
+                          const uint8_t *train, int train_count,
+                          std::vector<DescriptorPair> *pairs) {
+  knn(query, query_count, train, train_count, &forward_);
+  if (config_.cross_check) {
+    knn(train, train_count, query, query_count, &backward_);
+  }
+
+  pairs->clear();
+  for (int q = 0; q < query_count; q++) {
+    const KeypointMatch &match = forward_[q];
+    if (match.best < 0 || match.best_distance > config_.max_distance) {
+      continue;
+    }
+    // Without a second neighbour there is nothing to be ambiguous with
+    if (config_.ratio > 0 && match.second >= 0 &&
+        !(match.best_distance < config_.ratio * match.second_distance)) {
+      continue;
+    }
+    if (config_.cross_check && backward_[match.best].best != q) continue;
+
+    DescriptorPair pair;
+    pair.query = q;
+    pair.train = match.best;
+    pair.distance = match.best_distance;
+    pairs->push_back(pair);
+  }
+  return static_cast<int>(pairs->size());
+}
+
+int HammingMatcher::match(const KeypointBatch &query,
+                          const KeypointBatch &train,
+                          std::vector<DescriptorPair> *pairs) {
+  return match(query.descriptors.data(), query.count,
+               train.descriptors.data(), train.count, pairs);
+}
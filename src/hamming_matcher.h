@@ -0,0 +1,94 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file hamming_matcher.h
+ * @brief Brute-force Hamming matcher of 256-bit descriptors on the host
+ *
+ * HammingMatcher finds the nearest two train descriptors of every query
+ * descriptor, the same result as descriptor_match.vhd: ties go to the lower
+ * train index. Queries are taken in blocks of MATCH_QUERY_BLOCK against
+ * blocks of MATCH_TRAIN_BLOCK train descriptors, which stay in L1 while the
+ * block of queries runs over them, and blocks of queries are shared out
+ * between threads. Distances use the vector popcount of the target: NEON
+ * vcnt on the Cortex-A9, AVX2 nibble lookups or POPCNT on x86, built with
+ * -mfpu=neon, -mavx2 or -mpopcnt; other targets use the scalar builtin.
+ *
+ * Descriptors are read in place from KeypointBatch::descriptors, the block
+ * that read_batch() fills from the descriptor windows.
+ */
+
+#ifndef HAMMING_MATCHER_H
+#define HAMMING_MATCHER_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "keypoint_batch.h"
+
+#define MATCH_QUERY_BLOCK 4    // Queries run together over a train block
+#define MATCH_TRAIN_BLOCK 256  // 8 KiB of train descriptors
+#define MATCH_MIN_THREAD_PAIRS 16384  // Fewer pairs run on the caller alone
+
+/**
+ * @brief Filters of HammingMatcher::match()
+ */
+struct HammingMatcherConfig {
+  float ratio;       // Lowe ratio, best < ratio * second; 0 disables it
+  bool cross_check;  // Keep a pair only if each is the other's nearest
+  int max_distance;  // Largest Hamming distance of a pair (0-256)
+  int threads;       // Worker threads, 0 for one per core
+
+  HammingMatcherConfig()
+      : ratio(0.8f), cross_check(false), max_distance(256), threads(0) {}
+};
+
+/**
+ * @brief One accepted match, indices into the query and train sets
+ */
+struct DescriptorPair {
+  int query;
+  int train;
+  int distance;
+};
+
+class HammingMatcher {
+ public:
+  explicit HammingMatcher(
+      const HammingMatcherConfig &config = HammingMatcherConfig());
+
+  /**
+   * @brief Nearest two train descriptors of every query descriptor
+   * @param query query_count * DESCRIPTOR_BYTES bytes
+   * @param train train_count * DESCRIPTOR_BYTES bytes
+   * @param matches One entry per query, -1 where there are too few trains
+   */
+  void knn(const uint8_t *query, int query_count, const uint8_t *train,
+           int train_count, std::vector<KeypointMatch> *matches);
+  void knn(const KeypointBatch &query, const KeypointBatch &train,
+           std::vector<KeypointMatch> *matches);
+
+  /**
+   * @brief Matches that pass max_distance, the ratio test and, if enabled,
+   *        the cross-check, by increasing query index
+   * @return Number of pairs
+   */
+  int match(const uint8_t *query, int query_count, const uint8_t *train,
+            int train_count, std::vector<DescriptorPair> *pairs);
+  int match(const KeypointBatch &query, const KeypointBatch &train,
+            std::vector<DescriptorPair> *pairs);
+
+  const HammingMatcherConfig &config() const { return config_; }
+
+ private:
+  HammingMatcherConfig config_;
+  std::vector<KeypointMatch> forward_;
+  std::vector<KeypointMatch> backward_;
+};
+
+/**
+ * @brief Hamming distance of two 32-byte descriptors
+ */
+int hamming_distance(const uint8_t *a, const uint8_t *b);
+
+#endif  // HAMMING_MATCHER_H
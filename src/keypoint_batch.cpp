@@ -0,0 +1,83 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file keypoint_batch.cpp
+ * @brief Keypoints of one frame in struct-of-arrays layout
+ */
+
+#include "keypoint_batch.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+void KeypointBatch::assign(const uint32_t *pos, const uint32_t *scr_angle,
+                           const uint32_t *descript0,
+                           const uint32_t *descript1, int count) {
+  this->count = count;
+  x.resize(count);
+  y.resize(count);
+  score.resize(count);
+  angle.resize(count);
+  scale.resize(count);
+  descriptors.resize(static_cast<size_t>(count) * DESCRIPTOR_BYTES);
+
+  for (int i = 0; i < count; i++) {
+    // "00000" & pos_y(11) & "00000" & pos_x(11)
+    x[i] = static_cast<uint16_t>(pos[i] & 0x0000FFFF);
+    y[i] = static_cast<uint16_t>(pos[i] >> 16);
+
+    // "0" & scale(3) & score(12) & zeros & quadrant & theta
+    score[i] = static_cast<uint16_t>((scr_angle[i] & 0x0FFF0000) >> 16);
+    angle[i] = static_cast<uint16_t>(scr_angle[i] & 0x0000FFFF);
+    scale[i] = static_cast<uint8_t>((scr_angle[i] & 0x70000000) >> 28);
+  }
+
+  // Both halves are little-endian words, so they are copied as bytes
+  for (int i = 0; i < count; i++) {
+    uint8_t *descriptor =
+        &descriptors[static_cast<size_t>(i) * DESCRIPTOR_BYTES];
+    memcpy(descriptor, descript0 + i * 4, DESCRIPTOR_BYTES / 2);
+    memcpy(descriptor + DESCRIPTOR_BYTES / 2, descript1 + i * 4,
+           DESCRIPTOR_BYTES / 2);
+  }
+}
+
+void KeypointBatch::push_back(const KeypointBatch &other, int i, int dx,
+                              int dy) {
+  x.push_back(static_cast<uint16_t>(other.x[i] + dx));
+  y.push_back(static_cast<uint16_t>(other.y[i] + dy));
+  score.push_back(other.score[i]);
+  angle.push_back(other.angle[i]);
+  scale.push_back(other.scale[i]);
+  descriptors.insert(descriptors.end(), other.descriptor(i),
+                     other.descriptor(i) + DESCRIPTOR_BYTES);
+  count++;
+}
+
+void KeypointBatch::sort_by_score() {
+  std::vector<int> order(count);
+  for (int i = 0; i < count; i++) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return score[a] > score[b];
+  });
+
+  KeypointBatch sorted;
+  sorted.theta_size = theta_size;
+  for (int i = 0; i < count; i++) sorted.push_back(*this, order[i], 0, 0);
+  std::swap(*this, sorted);
+}
+
+/**
+ * Sector theta of a quadrant spans 90 / 2^theta_size degrees from the x
+ * axis; quadrants 1 and 3 are mirrored (BRIEF_pattern_generator.py).
+ */
+float KeypointBatch::orientation(int i) const {
+  static const float offset[4] = {0, 180, 180, 360};
+  static const float invert[4] = {1, -1, 1, -1};
+
+  float step = 90.0f / static_cast<float>(1 << theta_size);
+  float degree = (static_cast<float>(theta(i)) + 0.5f) * step;
+  int q = quadrant(i);
+  return degree * invert[q] + offset[q];
+}
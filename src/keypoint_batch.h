@@ -0,0 +1,146 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file keypoint_batch.h
+ * @brief Keypoints of one frame in struct-of-arrays layout
+ *
+ * The descriptor BRAMs hold one keypoint per entry spread over four windows.
+ * KeypointBatch keeps each field in its own array and the descriptors in
+ * one contiguous, aligned block, ready for vectorised matching.
+ */
+
+#ifndef KEYPOINT_BATCH_H
+#define KEYPOINT_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <new>
+#include <vector>
+
+#define DESCRIPTOR_BYTES 32  // 256 BRIEF tests
+#define DESCRIPTOR_ALIGN 32  // One AVX2 load per descriptor
+
+// ============================================================================
+// ALIGNED STORAGE
+// ============================================================================
+
+/**
+ * @brief std::allocator with a minimum alignment, for C++11 containers
+ */
+template <typename T, size_t Align>
+struct AlignedAllocator {
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind {
+    typedef AlignedAllocator<U, Align> other;
+  };
+
+  AlignedAllocator() {}
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Align> &) {}
+
+  T *allocate(size_t n) {
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, Align, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(ptr);
+  }
+  void deallocate(T *ptr, size_t) { free(ptr); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Align> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Align> &) const {
+    return false;
+  }
+};
+
+// ============================================================================
+// KEYPOINT BATCH
+// ============================================================================
+
+/**
+ * @brief Keypoints of one frame, one array per field
+ *
+ * Entry i of every array belongs to keypoint i, in readback order (by
+ * decreasing score, see OrbAccelerator::read_batch()). Descriptor i
+ * starts at descriptor(i); bit k of the 256-bit descriptor (BRIEF test k) is
+ * bit k % 8 of byte k / 8, i.e. descriptor words 0-3 of _descripts_ptr[0]
+ * followed by words 0-3 of _descripts_ptr[1], little-endian.
+ *
+ * angle holds the orientation sector: 4 quadrants of 2^theta_size sectors
+ * each, as set by ACONF_THETA_SIZE. orientation() converts it to degrees.
+ */
+struct KeypointBatch {
+  int count;
+  int theta_size;  // log2 of the orientation sectors per quadrant
+  std::vector<uint16_t> x;      // Column, in scale 0 pixels
+  std::vector<uint16_t> y;      // Line, in scale 0 pixels
+  std::vector<uint16_t> score;  // FAST score, 12 bits
+  std::vector<uint16_t> angle;  // quadrant << THETA_SIZE | theta
+  std::vector<uint8_t> scale;   // Pyramid level, x and y are level 0
+  std::vector<uint8_t, AlignedAllocator<uint8_t, DESCRIPTOR_ALIGN> >
+      descriptors;  // count * DESCRIPTOR_BYTES
+
+  KeypointBatch() : count(0), theta_size(3) {}
+
+  /**
+   * @brief Decode raw BRAM words, as written by write_descriptors.vhd
+   * @param pos Position words, one per keypoint
+   * @param scr_angle Score, angle and scale words, one per keypoint
+   * @param descript0 Descriptor bits 0-127, four words per keypoint
+   * @param descript1 Descriptor bits 128-255, four words per keypoint
+   * @param count Number of keypoints
+   */
+  void assign(const uint32_t *pos, const uint32_t *scr_angle,
+              const uint32_t *descript0, const uint32_t *descript1,
+              int count);
+
+  void clear() { assign(NULL, NULL, NULL, NULL, 0); }
+
+  /**
+   * @brief Append keypoint i of another batch, moved by (dx, dy)
+   */
+  void push_back(const KeypointBatch &other, int i, int dx, int dy);
+
+  /**
+   * @brief Reorder by decreasing score, keypoints with equal scores keep
+   *        their order
+   */
+  void sort_by_score();
+
+  const uint8_t *descriptor(int i) const {
+    return &descriptors[static_cast<size_t>(i) * DESCRIPTOR_BYTES];
+  }
+
+  int quadrant(int i) const { return angle[i] >> theta_size; }
+  int theta(int i) const { return angle[i] & ((1 << theta_size) - 1); }
+
+  /**
+   * @brief Orientation of keypoint i in degrees (0-360), the centre of its
+   *        sector, as used to rotate the BRIEF pattern
+   */
+  float orientation(int i) const;
+};
+
+/**
+ * @brief Nearest two reference descriptors of a keypoint
+ *
+ * Indices are into the reference set given to
+ * OrbAccelerator::load_references(), -1 when there is no such reference or
+ * the keypoint was not matched.
+ */
+struct KeypointMatch {
+  int best;
+  int best_distance;  // Hamming distance, 0 to 256
+  int second;
+  int second_distance;
+};
+
+#endif  // KEYPOINT_BATCH_H
@@ -0,0 +1,311 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file keypoint_log.cpp
+ * @brief Binary log of the keypoints of a stream, for offline replay
+ */
+
+#include "keypoint_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(KeypointLogHeader) == KEYPOINT_LOG_ALIGN,
+              "log header must keep records aligned");
+static_assert(sizeof(KeypointLogFrameHeader) == KEYPOINT_LOG_ALIGN,
+              "frame header must keep the fields aligned");
+
+static size_t align_up(size_t bytes) {
+  return (bytes + KEYPOINT_LOG_ALIGN - 1) / KEYPOINT_LOG_ALIGN *
+         KEYPOINT_LOG_ALIGN;
+}
+
+/**
+ * @brief Offset of the descriptor block in a record, after the header and
+ *        four uint16 and one uint8 array
+ */
+static size_t descriptors_offset(int count) {
+  return align_up(sizeof(KeypointLogFrameHeader) +
+                  static_cast<size_t>(count) * 9);
+}
+
+size_t keypoint_log_record_bytes(int count) {
+  return descriptors_offset(count) +
+         static_cast<size_t>(count) * DESCRIPTOR_BYTES;
+}
+
+/**
+ * @brief Write all of a buffer, across short writes and signals
+ */
+static int write_all(int fd, const uint8_t *data, size_t bytes) {
+  while (bytes > 0) {
+    ssize_t written = ::write(fd, data, bytes);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      perror("write(keypoint log)");
+      return -1;
+    }
+    data += written;
+    bytes -= static_cast<size_t>(written);
+  }
+  return 0;
+}
+
+/**
+ * @brief Serialise the record of a frame
+ */
+static void encode_frame(uint64_t frame_id, int64_t timestamp_ns,
+                         const KeypointBatch &batch,
+                         std::vector<uint8_t> *record) {
+  size_t count = static_cast<size_t>(batch.count);
+  record->assign(keypoint_log_record_bytes(batch.count), 0);
+  uint8_t *out = record->data();
+
+  KeypointLogFrameHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = KEYPOINT_LOG_FRAME_MAGIC;
+  header.count = static_cast<uint32_t>(count);
+  header.frame_id = frame_id;
+  header.timestamp_ns = timestamp_ns;
+  header.record_bytes = static_cast<uint32_t>(record->size());
+  header.theta_size = static_cast<uint16_t>(batch.theta_size);
+  memcpy(out, &header, sizeof(header));
+
+  // The vectors may be empty, data() is then not to be copied from
+  if (count > 0) {
+    uint8_t *field = out + sizeof(header);
+    memcpy(field, batch.x.data(), count * 2);
+    memcpy(field + count * 2, batch.y.data(), count * 2);
+    memcpy(field + count * 4, batch.score.data(), count * 2);
+    memcpy(field + count * 6, batch.angle.data(), count * 2);
+    memcpy(field + count * 8, batch.scale.data(), count);
+    memcpy(out + descriptors_offset(batch.count), batch.descriptors.data(),
+           count * DESCRIPTOR_BYTES);
+  }
+}
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+KeypointLogWriter::KeypointLogWriter()
+    : fd_(-1),
+      async_(false),
+      frames_(0),
+      bytes_(0),
+      failed_(false),
+      free_(KEYPOINT_LOG_BUFFERS),
+      full_(KEYPOINT_LOG_BUFFERS) {}
+
+KeypointLogWriter::~KeypointLogWriter() { close(); }
+
+int KeypointLogWriter::open(const std::string &path, bool async) {
+  // The queues cannot be reopened once closed
+  if (fd_ != -1 || full_.closed()) return -1;
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ == -1) {
+    perror("open(keypoint log)");
+    return -1;
+  }
+
+  KeypointLogHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, KEYPOINT_LOG_MAGIC, sizeof(header.magic));
+  header.version = KEYPOINT_LOG_VERSION;
+  header.header_bytes = sizeof(header);
+  header.descriptor_bytes = DESCRIPTOR_BYTES;
+  if (write_all(fd_, reinterpret_cast<const uint8_t *>(&header),
+                sizeof(header)) < 0) {
+    ::close(fd_);
+    fd_ = -1;
+    return -1;
+  }
+
+  async_ = async;
+  bytes_ = sizeof(header);
+  buffers_.assign(async ? KEYPOINT_LOG_BUFFERS : 1, std::vector<uint8_t>());
+  if (async) {
+    for (size_t i = 0; i < buffers_.size(); i++) free_.push(&buffers_[i]);
+    writer_ = std::thread(&KeypointLogWriter::writer_loop, this);
+  }
+  return 0;
+}
+
+int KeypointLogWriter::write(uint64_t frame_id, int64_t timestamp_ns,
+                             const KeypointBatch &batch) {
+  if (fd_ == -1 || failed_) return -1;
+
+  std::vector<uint8_t> *record = &buffers_[0];
+  if (async_ && !free_.pop(&record)) return -1;
+  encode_frame(frame_id, timestamp_ns, batch, record);
+  frames_++;
+  bytes_ += record->size();
+
+  if (async_) return full_.push(record) ? 0 : -1;
+  if (write_all(fd_, record->data(), record->size()) < 0) {
+    failed_ = true;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Buffers go back to the free queue once written; after an error the rest
+ * are still taken so that write() does not wait for them forever.
+ */
+void KeypointLogWriter::writer_loop() {
+  std::vector<uint8_t> *record;
+  while (full_.pop(&record)) {
+    if (!failed_ && write_all(fd_, record->data(), record->size()) < 0) {
+      failed_ = true;
+    }
+    free_.push(record);
+  }
+}
+
+int KeypointLogWriter::close() {
+  if (fd_ == -1) return 0;
+  if (async_) {
+    full_.close();
+    writer_.join();
+  }
+  if (::close(fd_) == -1) {
+    perror("close(keypoint log)");
+    failed_ = true;
+  }
+  fd_ = -1;
+  return failed_ ? -1 : 0;
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+void KeypointLogFrame::copy_to(KeypointBatch *batch) const {
+  size_t n = static_cast<size_t>(count);
+  batch->count = count;
+  batch->theta_size = theta_size;
+  batch->x.assign(x, x + n);
+  batch->y.assign(y, y + n);
+  batch->score.assign(score, score + n);
+  batch->angle.assign(angle, angle + n);
+  batch->scale.assign(scale, scale + n);
+  batch->descriptors.assign(descriptors, descriptors + n * DESCRIPTOR_BYTES);
+}
+
+KeypointLogReader::KeypointLogReader()
+    : base_(NULL), size_(0), trailing_bytes_(0) {}
+
+KeypointLogReader::~KeypointLogReader() { close(); }
+
+int KeypointLogReader::open(const std::string &path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    perror("open(keypoint log)");
+    return -1;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == -1) {
+    perror("fstat(keypoint log)");
+    ::close(fd);
+    return -1;
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ < sizeof(KeypointLogHeader)) {
+    fprintf(stderr, "%s: not a keypoint log\n", path.c_str());
+    ::close(fd);
+    return -1;
+  }
+
+  // The mapping outlives the descriptor
+  void *ptr = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    perror("mmap(keypoint log)");
+    return -1;
+  }
+  base_ = static_cast<const uint8_t *>(ptr);
+  madvise(ptr, size_, MADV_SEQUENTIAL);
+
+  const KeypointLogHeader *header =
+      reinterpret_cast<const KeypointLogHeader *>(base_);
+  if (memcmp(header->magic, KEYPOINT_LOG_MAGIC, sizeof(header->magic)) !=
+          0 ||
+      header->version != KEYPOINT_LOG_VERSION ||
+      header->header_bytes != sizeof(KeypointLogHeader) ||
+      header->descriptor_bytes != DESCRIPTOR_BYTES) {
+    fprintf(stderr, "%s: not a version %d keypoint log\n", path.c_str(),
+            KEYPOINT_LOG_VERSION);
+    close();
+    return -1;
+  }
+
+  // Only the frame headers are read, one page per frame at most
+  size_t offset = sizeof(KeypointLogHeader);
+  while (size_ - offset >= sizeof(KeypointLogFrameHeader)) {
+    const KeypointLogFrameHeader *frame =
+        reinterpret_cast<const KeypointLogFrameHeader *>(base_ + offset);
+    if (frame->magic != KEYPOINT_LOG_FRAME_MAGIC ||
+        frame->record_bytes !=
+            keypoint_log_record_bytes(static_cast<int>(frame->count)) ||
+        frame->record_bytes > size_ - offset) {
+      break;
+    }
+    offsets_.push_back(offset);
+    offset += frame->record_bytes;
+  }
+  trailing_bytes_ = size_ - offset;
+  return 0;
+}
+
+void KeypointLogReader::close() {
+  if (base_ != NULL) munmap(const_cast<uint8_t *>(base_), size_);
+  base_ = NULL;
+  size_ = 0;
+  offsets_.clear();
+  trailing_bytes_ = 0;
+}
+
+KeypointLogFrame KeypointLogReader::frame(size_t index) const {
+  const uint8_t *record = base_ + offsets_[index];
+  const KeypointLogFrameHeader *header =
+      reinterpret_cast<const KeypointLogFrameHeader *>(record);
+  size_t count = header->count;
+  const uint8_t *field = record + sizeof(KeypointLogFrameHeader);
+
+  KeypointLogFrame frame;
+  frame.frame_id = header->frame_id;
+  frame.timestamp_ns = header->timestamp_ns;
+  frame.count = static_cast<int>(count);
+  frame.theta_size = header->theta_size;
+  frame.x = reinterpret_cast<const uint16_t *>(field);
+  frame.y = reinterpret_cast<const uint16_t *>(field + count * 2);
+  frame.score = reinterpret_cast<const uint16_t *>(field + count * 4);
+  frame.angle = reinterpret_cast<const uint16_t *>(field + count * 6);
+  frame.scale = field + count * 8;
+  frame.descriptors = record + descriptors_offset(frame.count);
+  return frame;
+}
+
+size_t KeypointLogReader::find(uint64_t frame_id) const {
+  size_t first = 0;
+  size_t last = offsets_.size();
+  while (first < last) {
+    size_t middle = first + (last - first) / 2;
+    const KeypointLogFrameHeader *header =
+        reinterpret_cast<const KeypointLogFrameHeader *>(base_ +
+                                                         offsets_[middle]);
+    if (header->frame_id < frame_id) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return first;
+}
@@ -0,0 +1,194 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file keypoint_log.h
+ * @brief Binary log of the keypoints of a stream, for offline replay
+ *
+ * A log is a 32-byte file header followed by one record per frame,
+ * appended in order. A record is a 32-byte frame header (frame id,
+ * timestamp, keypoint count), the fields of KeypointBatch one array after
+ * the other (x, y, score and angle as uint16, scale as uint8), padding to
+ * 32 bytes and the descriptor block, DESCRIPTOR_BYTES per keypoint. Every
+ * record is a multiple of 32 bytes, so in a mapped log each descriptor
+ * block is as aligned as in a KeypointBatch. Values are little-endian,
+ * the order of both the Cortex-A9 and x86.
+ *
+ * KeypointLogWriter appends records, from a writer thread when async so
+ * that the caller only copies the batch. KeypointLogReader maps a log and
+ * returns views into it without copying; a record cut short, e.g. by a
+ * crash while writing, ends the log.
+ */
+
+#ifndef KEYPOINT_LOG_H
+#define KEYPOINT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "keypoint_batch.h"
+#include "spsc_queue.h"
+
+#define KEYPOINT_LOG_MAGIC "ORBKPLOG"
+#define KEYPOINT_LOG_VERSION 1
+#define KEYPOINT_LOG_FRAME_MAGIC 0x4D52464B  // "KFRM"
+#define KEYPOINT_LOG_ALIGN 32    // Records and descriptor blocks
+#define KEYPOINT_LOG_BUFFERS 8   // Records queued for the writer thread
+
+/**
+ * @brief First bytes of a log
+ */
+struct KeypointLogHeader {
+  char magic[8];              // KEYPOINT_LOG_MAGIC
+  uint32_t version;           // KEYPOINT_LOG_VERSION
+  uint32_t header_bytes;      // sizeof(KeypointLogHeader)
+  uint32_t descriptor_bytes;  // DESCRIPTOR_BYTES
+  uint32_t reserved[3];
+};
+
+/**
+ * @brief Start of each frame record
+ */
+struct KeypointLogFrameHeader {
+  uint32_t magic;         // KEYPOINT_LOG_FRAME_MAGIC
+  uint32_t count;         // Keypoints
+  uint64_t frame_id;
+  int64_t timestamp_ns;   // As given to write(), e.g. since the epoch
+  uint32_t record_bytes;  // Whole record, header and padding included
+  uint16_t theta_size;    // KeypointBatch::theta_size
+  uint16_t reserved;
+};
+
+/**
+ * @brief Bytes of the record of a frame of count keypoints
+ */
+size_t keypoint_log_record_bytes(int count);
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+class KeypointLogWriter {
+ public:
+  KeypointLogWriter();
+  ~KeypointLogWriter();
+
+  /**
+   * @brief Create or truncate a log and write its header, once per writer
+   * @param async Write records from a thread, write() then only copies
+   * @return 0 on success, -1 on error
+   */
+  int open(const std::string &path, bool async);
+
+  /**
+   * @brief Append the record of a frame
+   *
+   * When async, blocks only while KEYPOINT_LOG_BUFFERS records are waiting
+   * for the disk.
+   * @return 0 on success, -1 if this or an earlier write failed
+   */
+  int write(uint64_t frame_id, int64_t timestamp_ns,
+            const KeypointBatch &batch);
+
+  /**
+   * @brief Write the queued records and close the log
+   * @return 0 if every record was written, -1 otherwise
+   */
+  int close();
+
+  uint64_t frames() const { return frames_; }
+  uint64_t bytes() const { return bytes_; }
+
+  /**
+   * @brief Time write() waited for a free buffer, the disk falling behind
+   */
+  double stall_us() const { return free_.stats().pop_stall_us; }
+
+ private:
+  void writer_loop();
+
+  int fd_;
+  bool async_;
+  uint64_t frames_;
+  uint64_t bytes_;
+  std::atomic<bool> failed_;
+  std::vector<std::vector<uint8_t> > buffers_;
+  SpscQueue<std::vector<uint8_t> *> free_;
+  SpscQueue<std::vector<uint8_t> *> full_;
+  std::thread writer_;
+};
+
+// ============================================================================
+// READER
+// ============================================================================
+
+/**
+ * @brief One frame of a mapped log, valid while the reader is open
+ *
+ * The arrays are those of KeypointBatch, pointing into the mapping.
+ */
+struct KeypointLogFrame {
+  uint64_t frame_id;
+  int64_t timestamp_ns;
+  int count;
+  int theta_size;
+  const uint16_t *x;
+  const uint16_t *y;
+  const uint16_t *score;
+  const uint16_t *angle;
+  const uint8_t *scale;
+  const uint8_t *descriptors;  // count * DESCRIPTOR_BYTES, 32-byte aligned
+
+  const uint8_t *descriptor(int i) const {
+    return descriptors + static_cast<size_t>(i) * DESCRIPTOR_BYTES;
+  }
+
+  /**
+   * @brief Copy the frame into a batch, for code that takes a KeypointBatch
+   */
+  void copy_to(KeypointBatch *batch) const;
+};
+
+class KeypointLogReader {
+ public:
+  KeypointLogReader();
+  ~KeypointLogReader();
+
+  /**
+   * @brief Map a log and index its frames
+   * @return 0 on success, -1 if it cannot be mapped or is not a log
+   */
+  int open(const std::string &path);
+
+  void close();
+
+  size_t frames() const { return offsets_.size(); }
+
+  /**
+   * @brief View of the frame at an index, 0 to frames() - 1
+   */
+  KeypointLogFrame frame(size_t index) const;
+
+  /**
+   * @brief Index of the first frame with an id of at least frame_id,
+   *        frames() if none; ids must increase through the log
+   */
+  size_t find(uint64_t frame_id) const;
+
+  /**
+   * @brief Bytes after the last whole record, ignored
+   */
+  size_t trailing_bytes() const { return trailing_bytes_; }
+
+ private:
+  const uint8_t *base_;
+  size_t size_;
+  std::vector<size_t> offsets_;  // Of each record
+  size_t trailing_bytes_;
+};
+
+#endif  // KEYPOINT_LOG_H
@@ -0,0 +1,154 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file keypoint_tracker.cpp
+ * @brief Frame-to-frame keypoint tracks with persistent IDs
+ */
+
+#include "keypoint_tracker.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "hamming_matcher.h"
+
+KeypointTracker::KeypointTracker(const KeypointTrackerConfig &config)
+    : config_(config), next_id_(0), comparisons_(0) {
+  config_.cell_size = std::max(config_.cell_size, 1);
+  config_.radius = std::max(config_.radius, 0);
+  build_grid();
+}
+
+void KeypointTracker::reset() {
+  previous_.clear();
+  previous_ids_.clear();
+  previous_lengths_.clear();
+  build_grid();
+}
+
+/**
+ * @brief Grid cell of a keypoint of the previous frame
+ */
+int KeypointTracker::cell_of(int level, int x, int y) const {
+  int side = config_.cell_size << level;
+  return grid_offset_[level] + y / side * grid_cols_[level] + x / side;
+}
+
+/**
+ * @brief Group the keypoints of the previous frame by level and grid cell
+ *
+ * A counting sort: cell c holds cell_points_[cell_start_[c]] up to
+ * cell_points_[cell_start_[c + 1]], in keypoint order.
+ */
+void KeypointTracker::build_grid() {
+  int max_x = 0;
+  int max_y = 0;
+  for (int i = 0; i < previous_.count; i++) {
+    max_x = std::max(max_x, static_cast<int>(previous_.x[i]));
+    max_y = std::max(max_y, static_cast<int>(previous_.y[i]));
+  }
+  int cells = 0;
+  for (int level = 0; level < TRACKER_LEVELS; level++) {
+    int side = config_.cell_size << level;
+    grid_cols_[level] = max_x / side + 1;
+    grid_rows_[level] = max_y / side + 1;
+    grid_offset_[level] = cells;
+    cells += grid_cols_[level] * grid_rows_[level];
+  }
+
+  cell_start_.assign(static_cast<size_t>(cells) + 1, 0);
+  for (int i = 0; i < previous_.count; i++) {
+    cell_start_[cell_of(previous_.scale[i], previous_.x[i], previous_.y[i]) +
+                1]++;
+  }
+  for (size_t c = 1; c < cell_start_.size(); c++) {
+    cell_start_[c] += cell_start_[c - 1];
+  }
+  cell_points_.resize(previous_.count);
+  std::vector<int> fill(cell_start_.begin(), cell_start_.end() - 1);
+  for (int i = 0; i < previous_.count; i++) {
+    int cell = cell_of(previous_.scale[i], previous_.x[i], previous_.y[i]);
+    cell_points_[fill[cell]++] = i;
+  }
+}
+
+int KeypointTracker::update(const KeypointBatch &batch) {
+  ids_.assign(batch.count, -1);
+  lengths_.assign(batch.count, 1);
+  candidates_.clear();
+  comparisons_ = 0;
+
+  for (int i = 0; i < batch.count && previous_.count > 0; i++) {
+    int level = batch.scale[i];
+    int x = batch.x[i];
+    int y = batch.y[i];
+    int radius = config_.radius << level;
+    int side = config_.cell_size << level;
+    int cols = grid_cols_[level];
+    int col_begin = std::max(x - radius, 0) / side;
+    int col_end = std::min((x + radius) / side, cols - 1);
+    int row_begin = std::max(y - radius, 0) / side;
+    int row_end = std::min((y + radius) / side, grid_rows_[level] - 1);
+
+    // Nearest two of the same level within the window
+    int best = -1;
+    int best_distance = 0;
+    int second_distance = -1;
+    for (int row = row_begin; row <= row_end; row++) {
+      for (int col = col_begin; col <= col_end; col++) {
+        int cell = grid_offset_[level] + row * cols + col;
+        for (int k = cell_start_[cell]; k < cell_start_[cell + 1]; k++) {
+          int p = cell_points_[k];
+          if (abs(previous_.x[p] - x) > radius ||
+              abs(previous_.y[p] - y) > radius) {
+            continue;
+          }
+          int distance =
+              hamming_distance(batch.descriptor(i), previous_.descriptor(p));
+          comparisons_++;
+          if (best < 0 || distance < best_distance) {
+            second_distance = best < 0 ? -1 : best_distance;
+            best = p;
+            best_distance = distance;
+          } else if (second_distance < 0 || distance < second_distance) {
+            second_distance = distance;
+          }
+        }
+      }
+    }
+
+    if (best < 0 || best_distance > config_.max_distance) continue;
+    if (config_.ratio > 0 && second_distance >= 0 &&
+        !(best_distance < config_.ratio * second_distance)) {
+      continue;
+    }
+    Candidate candidate = {best_distance, i, best};
+    candidates_.push_back(candidate);
+  }
+
+  // Each track continues once, nearest pairs first
+  std::stable_sort(candidates_.begin(), candidates_.end(),
+                   [](const Candidate &a, const Candidate &b) {
+                     return a.distance < b.distance;
+                   });
+  taken_.assign(previous_.count, 0);
+  int continued = 0;
+  for (size_t c = 0; c < candidates_.size(); c++) {
+    const Candidate &candidate = candidates_[c];
+    if (taken_[candidate.previous]) continue;
+    taken_[candidate.previous] = 1;
+    ids_[candidate.current] = previous_ids_[candidate.previous];
+    lengths_[candidate.current] = previous_lengths_[candidate.previous] + 1;
+    continued++;
+  }
+  for (int i = 0; i < batch.count; i++) {
+    if (ids_[i] < 0) ids_[i] = next_id_++;
+  }
+
+  previous_ = batch;
+  previous_ids_ = ids_;
+  previous_lengths_ = lengths_;
+  build_grid();
+  return continued;
+}
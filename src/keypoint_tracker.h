@@ -0,0 +1,105 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file keypoint_tracker.h
+ * @brief Frame-to-frame keypoint tracks with persistent IDs
+ *
+ * KeypointTracker keeps the keypoints of the previous frame in one uniform
+ * grid per pyramid level over their positions, of cell_size << level pixel
+ * cells. A keypoint of the new frame is only compared with the keypoints of
+ * its level in the cells around it, within radius << level pixels
+ * (positions of level s are multiples of 2^s, and so is the motion it can
+ * resolve), so the work per frame grows with the keypoints, not with their
+ * square as brute force does.
+ *
+ * A keypoint continues the track of its nearest candidate when the
+ * Hamming distance is within max_distance and passes the ratio test; each
+ * track is continued at most once, nearest pairs first. Other keypoints
+ * start new tracks.
+ */
+
+#ifndef KEYPOINT_TRACKER_H
+#define KEYPOINT_TRACKER_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "keypoint_batch.h"
+
+#define TRACKER_LEVELS 8  // Pyramid levels told apart by the 3-bit scale
+
+/**
+ * @brief Search window and acceptance of a match
+ */
+struct KeypointTrackerConfig {
+  int cell_size;     // Grid cell side at level 0 in pixels, about the radius
+  int radius;        // Largest motion between frames at level 0, in pixels
+  int max_distance;  // Largest Hamming distance of a continued track
+  float ratio;       // Lowe ratio within the window, 0 disables it
+
+  KeypointTrackerConfig()
+      : cell_size(32), radius(24), max_distance(64), ratio(0.8f) {}
+};
+
+class KeypointTracker {
+ public:
+  explicit KeypointTracker(
+      const KeypointTrackerConfig &config = KeypointTrackerConfig());
+
+  /**
+   * @brief Follow the tracks of the previous frame into a new one
+   * @param batch Keypoints of the frame, in any order
+   * @return Number of tracks continued from the previous frame
+   */
+  int update(const KeypointBatch &batch);
+
+  /**
+   * @brief Forget the previous frame, the next one starts new tracks
+   */
+  void reset();
+
+  /**
+   * @brief Track ID of each keypoint of the last frame, same order
+   */
+  const std::vector<int> &ids() const { return ids_; }
+
+  /**
+   * @brief Frames each track of the last frame has been followed for, 1 for
+   *        a new track
+   */
+  const std::vector<int> &lengths() const { return lengths_; }
+
+  /**
+   * @brief Candidates compared in the last update(), the work of the frame
+   */
+  int64_t comparisons() const { return comparisons_; }
+
+ private:
+  struct Candidate {
+    int distance;
+    int current;
+    int previous;
+  };
+
+  int cell_of(int level, int x, int y) const;
+  void build_grid();
+
+  KeypointTrackerConfig config_;
+  KeypointBatch previous_;
+  std::vector<int> previous_ids_;
+  std::vector<int> previous_lengths_;
+  int grid_cols_[TRACKER_LEVELS];
+  int grid_rows_[TRACKER_LEVELS];
+  int grid_offset_[TRACKER_LEVELS];  // First cell of each level
+  std::vector<int> cell_start_;  // Cells of all levels + 1, into cell_points_
+  std::vector<int> cell_points_;  // Previous keypoints grouped by cell
+  std::vector<Candidate> candidates_;
+  std::vector<char> taken_;
+  std::vector<int> ids_;
+  std::vector<int> lengths_;
+  int next_id_;
+  int64_t comparisons_;
+};
+
+#endif  // KEYPOINT_TRACKER_H
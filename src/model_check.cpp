@@ -0,0 +1,223 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file model_check.cpp
+ * @brief Regression check of the software model, without FPGA or OpenCV
+ *
+ * Runs OrbModel::process on a synthetic frame and compares the status word,
+ * the keypoint count and a few keypoints with recorded values, then decodes
+ * the BRAM images through KeypointBatch and checks every field against the
+ * model output. A change of the recorded values must be checked against the
+ * co-simulation of sim/. Exits with status 1 on the first mismatch.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "keypoint_batch.h"
+#include "orb_model.h"
+
+// ============================================================================
+// CONFIGURATION CONSTANTS
+// ============================================================================
+
+// Small geometry, two levels, so the check runs in well under a second
+#define CHECK_LINE_SIZE 160
+#define CHECK_NUM_LINES 120
+#define CHECK_NUM_SCALES 2
+#define CHECK_THRESHOLD 20
+#define CHECK_ENTRIES 64
+
+// Keypoints of the synthetic frame with CHECK_ENTRIES entries
+#define CHECK_KEYPOINTS 20
+// Entries of the overflow run, fewer than CHECK_KEYPOINTS
+#define CHECK_SMALL_ENTRIES 8
+
+/**
+ * @brief One recorded keypoint, as the BRAM entry of the model
+ */
+struct KnownKeypoint {
+  int index;  // Entry of the model output
+  OrbFeature feature;
+};
+
+static const KnownKeypoint kKnownKeypoints[] = {
+    {0,
+     {0x0015001e,
+      0x03ae001f,
+      {0x72c7a8f5, 0xd649a1ae, 0xdab013c2, 0x3bf9e133, 0x9c6ce22b, 0x318e679a,
+       0x787588d8, 0x20c2d9f5}}},
+    {7,
+     {0x00260048,
+      0x03190007,
+      {0x72fae97c, 0xc6c1f9df, 0x1aa4b5c3, 0xbe7ec903, 0x58c0ea09, 0x30fe6f1e,
+       0x7915c95b, 0xead699f7}}},
+    {13,
+     {0x00430015,
+      0x037e0019,
+      {0x72efa8f9, 0xd74da98c, 0x5ab4b3c2, 0x3bf0e133, 0x9c7ce229, 0x31ae6fbb,
+       0x78f5cbda, 0x28d2d8fd}}},
+    {19,
+     {0x0051008a,
+      0x03e00015,
+      {0x5a42eaf1, 0xd3488d2c, 0xdeb011c2, 0x3af0c033, 0x8c54a20d, 0x31ce6f9a,
+       0xf8b18818, 0x0852887d}}},
+};
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+/**
+ * @brief Checkerboard of bright cells in the middle of the frame, on a
+ *        gradient, with a texture that varies the orientations
+ */
+static std::vector<uint8_t> synthetic_frame() {
+  std::vector<uint8_t> frame(CHECK_LINE_SIZE * CHECK_NUM_LINES);
+  for (int y = 0; y < CHECK_NUM_LINES; y++) {
+    for (int x = 0; x < CHECK_LINE_SIZE; x++) {
+      int value = 40 + (x + y) / 4;
+      bool inside = x >= 20 && x < CHECK_LINE_SIZE - 20 && y >= 20 &&
+                    y < CHECK_NUM_LINES - 20;
+      if (inside && (x / 20 + y / 20) % 2 == 0) value = 200 - (x * y) % 37;
+      frame[y * CHECK_LINE_SIZE + x] = static_cast<uint8_t>(value);
+    }
+  }
+  return frame;
+}
+
+/**
+ * @brief Model of the check geometry with a single cell of entries
+ */
+static OrbModelConfig check_config(int entries) {
+  OrbModelConfig config;
+  config.line_size = CHECK_LINE_SIZE;
+  config.num_lines = CHECK_NUM_LINES;
+  config.num_scales = CHECK_NUM_SCALES;
+  config.feature_lines = entries;
+  config.cell_k = entries;
+  config.match_refs = 0;
+  return config;
+}
+
+/**
+ * @brief Compare an entry of the model with a recorded one
+ * @return 0 if equal, -1 otherwise
+ */
+static int check_feature(int index, const OrbFeature &got,
+                         const OrbFeature &want) {
+  if (got.pos != want.pos || got.scr_angle != want.scr_angle ||
+      memcmp(got.descriptor, want.descriptor, sizeof(want.descriptor)) !=
+          0) {
+    fprintf(stderr,
+            "Keypoint %d: pos %08x scr_angle %08x descriptor %08x..., "
+            "expected %08x %08x %08x...\n",
+            index, got.pos, got.scr_angle, got.descriptor[0], want.pos,
+            want.scr_angle, want.descriptor[0]);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Decode the BRAM images of the model and compare every field
+ * @return 0 if the batch matches the entries, -1 otherwise
+ */
+static int check_batch(const OrbModel &model,
+                       const std::vector<OrbFeature> &features) {
+  // The images cover every entry of the BRAMs, as in the window
+  int count = static_cast<int>(features.size());
+  int entries = model.config().feature_lines;
+  std::vector<uint32_t> pos(entries);
+  std::vector<uint32_t> scr_angle(entries);
+  std::vector<uint32_t> descript0(entries * 4);
+  std::vector<uint32_t> descript1(entries * 4);
+  model.store(features, pos.data(), scr_angle.data(), descript0.data(),
+              descript1.data());
+
+  KeypointBatch batch;
+  batch.assign(pos.data(), scr_angle.data(), descript0.data(),
+               descript1.data(), count);
+  if (batch.count != count) {
+    fprintf(stderr, "Batch of %d keypoints, expected %d\n", batch.count,
+            count);
+    return -1;
+  }
+  for (int i = 0; i < count; i++) {
+    const OrbFeature &feature = features[i];
+    // "00000" & pos_y(11) & "00000" & pos_x(11)
+    bool position = batch.x[i] == (feature.pos & 0x7FF) &&
+                    batch.y[i] == ((feature.pos >> 16) & 0x7FF);
+    // "0" & scale(3) & score(12) & zeros & quadrant & theta
+    bool fields = batch.score[i] == ((feature.scr_angle >> 16) & 0xFFF) &&
+                  batch.scale[i] == ((feature.scr_angle >> 28) & 0x7) &&
+                  batch.angle[i] == (feature.scr_angle & 0xFFFF);
+    // Bit k of the descriptor is bit k % 8 of byte k / 8
+    bool bits = true;
+    for (int k = 0; k < 256; k++) {
+      int word = (k / 32) % 4 + (k / 128) * 4;
+      int want = (feature.descriptor[word] >> (k % 32)) & 1;
+      bits &= ((batch.descriptor(i)[k / 8] >> (k % 8)) & 1) == want;
+    }
+    if (!position || !fields || !bits) {
+      fprintf(stderr, "Batch keypoint %d differs from entry %08x %08x\n", i,
+              feature.pos, feature.scr_angle);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+/**
+ * @brief Run the checks
+ * @return 0 if every check passed, 1 otherwise
+ */
+int main() {
+  std::vector<uint8_t> frame = synthetic_frame();
+  std::vector<OrbFeature> features;
+
+  OrbModel model(check_config(CHECK_ENTRIES));
+  int count = model.process(frame.data(), CHECK_LINE_SIZE, CHECK_THRESHOLD,
+                            -CHECK_THRESHOLD, &features);
+  if (count != CHECK_KEYPOINTS ||
+      static_cast<int>(features.size()) != CHECK_KEYPOINTS) {
+    fprintf(stderr, "%d keypoints, %zu entries, expected %d\n", count,
+            features.size(), CHECK_KEYPOINTS);
+    return 1;
+  }
+  if (model.status() != CHECK_KEYPOINTS) {
+    fprintf(stderr, "Status %08x, expected %08x\n", model.status(),
+            CHECK_KEYPOINTS);
+    return 1;
+  }
+  size_t known = sizeof(kKnownKeypoints) / sizeof(kKnownKeypoints[0]);
+  for (size_t k = 0; k < known; k++) {
+    const KnownKeypoint &keypoint = kKnownKeypoints[k];
+    if (check_feature(keypoint.index, features[keypoint.index],
+                      keypoint.feature) != 0) {
+      return 1;
+    }
+  }
+  if (check_batch(model, features) != 0) return 1;
+
+  // Fewer entries than keypoints: the best ones by score, and the overflow
+  OrbModel small(check_config(CHECK_SMALL_ENTRIES));
+  count = small.process(frame.data(), CHECK_LINE_SIZE, CHECK_THRESHOLD,
+                        -CHECK_THRESHOLD, &features);
+  uint32_t status = FEATURE_STATUS_OVERFLOW | CHECK_SMALL_ENTRIES;
+  if (count != CHECK_SMALL_ENTRIES || small.status() != status) {
+    fprintf(stderr, "%d keypoints, status %08x, expected %d and %08x\n",
+            count, small.status(), CHECK_SMALL_ENTRIES, status);
+    return 1;
+  }
+
+  printf("Model check passed: %d keypoints, %zu recorded ones\n",
+         CHECK_KEYPOINTS, known);
+  return 0;
+}
@@ -0,0 +1,1294 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file orb_accelerator.cpp
+ * @brief Accelerator backends behind a common interface
+ */
+
+#include "orb_accelerator.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Layout of the shm backend, one page aligned window after the other
+#define SHM_PIXELS_SIZE (BRAM_ADDR_HIGH + 1 - BRAM_BASE_ADDR)
+#define SHM_IN_BUFFER_SIZE (INPUT_BUFFER_ADDR_HIGH + 1 - INPUT_BUFFER_BASE_ADDR)
+#define SHM_DESCRIPT_SIZE \
+  (BRAM_DESCRIPT0_ADDR_HIGH + 1 - BRAM_DESCRIPT0_BASE_ADDR)
+#define SHM_POS_SIZE \
+  (BRAM_DESCRIPT_POS_ADDR_HIGH + 1 - BRAM_DESCRIPT_POS_BASE_ADDR)
+#define SHM_SCR_ANGLE_SIZE \
+  (BRAM_DESCRIPT_SCR_ANGLE_ADDR_HIGH + 1 - BRAM_DESCRIPT_SCR_ANGLE_BASE_ADDR)
+#define SHM_GPIO_SIZE 0x1000
+#define SHM_MATCH_SIZE (BRAM_MATCH_ADDR_HIGH + 1 - BRAM_MATCH_BASE_ADDR)
+#define SHM_PERF_SIZE (BRAM_PERF_ADDR_HIGH + 1 - BRAM_PERF_BASE_ADDR)
+
+// Polls of the handshake word before the device thread starts sleeping
+#define DEVICE_SPIN_POLLS 1000
+#define DEVICE_SLEEP_US 50
+
+// Backoff of the host waits without a completion event
+#define WAIT_SLEEP_MIN_US 10
+#define WAIT_SLEEP_MAX_US 500
+
+// Fabric clock of the block design (FCLK_CLK0)
+#define FABRIC_CLOCK_MHZ 100
+
+// Fabric clocks after the last pixel or descriptor by which the pipeline is
+// empty: pixel to orientation (13), start_constr to feature_ready (98), and
+// per level the hold on the shared output and a BRAM write (1 + 5)
+#define FRAME_QUIET_CYCLES (13 + 98 + PERF_LEVELS * (1 + 5))
+
+/**
+ * @brief Microseconds since a time point
+ */
+static double elapsed_us(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief Model generics matching an accelerator configuration
+ */
+static OrbModelConfig model_config(const OrbAcceleratorConfig &config) {
+  OrbModelConfig model;
+  model.line_size = config.line_size;
+  model.num_lines = config.num_lines;
+  model.num_scales = config.num_scales;
+  model.theta_size = config.theta_size;
+  model.fifo_size = config.fifo_size;
+  model.constructors = config.constructors;
+  model.feature_lines = config.feature_lines;
+  model.grid_cols = config.grid_cols;
+  model.grid_rows = config.grid_rows;
+  model.cell_k = config.cell_k;
+  model.match_refs = config.match_refs;
+  model.match_queue = config.match_queue;
+  return model;
+}
+
+/**
+ * @brief Run the model and store its output in the feature windows
+ */
+static void model_run(OrbModel *model, const OrbRegions &regions,
+                      const uint8_t *pixels, int stride) {
+  std::vector<OrbFeature> features;
+  if (regions.match) {
+    model->set_references(const_cast<const uint32_t *>(regions.match),
+                          static_cast<int>(regions.match[MATCH_COUNT_WORD]));
+  }
+  model->process(pixels, stride,
+                 static_cast<int32_t>(regions.corner_thresh[0]),
+                 static_cast<int32_t>(regions.corner_thresh[1]), &features);
+  model->store(features, const_cast<uint32_t *>(regions.pos),
+               const_cast<uint32_t *>(regions.scr_angle),
+               const_cast<uint32_t *>(regions.descripts[0]),
+               const_cast<uint32_t *>(regions.descripts[1]));
+  if (regions.status) regions.status[0] = model->status();
+  if (regions.match) {
+    model->store_matches(
+        const_cast<uint32_t *>(regions.match + MATCH_TABLE_WORD));
+    regions.match[MATCH_STATUS_WORD] = model->match_status();
+  }
+  if (regions.perf) model->store_counters(const_cast<uint32_t *>(regions.perf));
+}
+
+/**
+ * @brief Clear what the reset of descriptor_match.vhd clears: the match
+ *        table and the dropped count, not the references
+ */
+static void match_reset(const OrbRegions &regions, int feature_lines) {
+  if (!regions.match) return;
+  for (int i = 0; i < feature_lines * 2; i++) {
+    regions.match[MATCH_TABLE_WORD + i] = 0;
+  }
+  regions.match[MATCH_STATUS_WORD] = 0;
+}
+
+/**
+ * @brief Origins of the tiles along one axis of a frame
+ *
+ * The fewest tiles whose overlap stays above twice the margin, spread evenly
+ * and rounded down to the alignment. The last tile ends at the frame edge,
+ * aligned only if the frame exceeds the tile by a multiple of the alignment.
+ */
+static std::vector<int> tile_origins(int frame, int tile, int margin,
+                                     int align) {
+  std::vector<int> origins;
+  if (frame < tile) return origins;
+
+  int step = tile - 2 * margin - align;  // Longest step, after rounding
+  int n = 1 + (frame - tile + step - 1) / step;
+  for (int i = 0; i < n; i++) {
+    int origin = n == 1 ? 0 : (frame - tile) * i / (n - 1);
+    origins.push_back(i == n - 1 ? origin : origin / align * align);
+  }
+  return origins;
+}
+
+/**
+ * @brief Eight consecutive pixels as one pixel BRAM word
+ *
+ * The BRAM word holds the first pixel in its low byte, which is the memory
+ * order of a little-endian host (ARM and x86).
+ */
+static inline u64 load_word(const uint8_t *src) {
+  u64 word;
+  memcpy(&word, src, sizeof(word));
+  return word;
+}
+
+/**
+ * @brief Copy contiguous pixel words to a window
+ *
+ * Uses 16-byte stores where available; the window is 8-byte aligned, so
+ * one scalar store may be needed to reach 16-byte alignment.
+ */
+static void copy_words(volatile u64 *dst, const uint8_t *src, int words) {
+  int i = 0;
+#if defined(__ARM_NEON) || defined(__SSE2__)
+  if ((reinterpret_cast<uintptr_t>(dst) & 15) != 0 && words > 0) {
+    dst[0] = load_word(src);
+    i = 1;
+  }
+  for (; i + 2 <= words; i += 2) {
+    u64 *aligned = const_cast<u64 *>(dst + i);
+#if defined(__ARM_NEON)
+    vst1q_u64(aligned, vreinterpretq_u64_u8(vld1q_u8(src + i * 8)));
+#else
+    _mm_store_si128(reinterpret_cast<__m128i *>(aligned),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                        src + i * 8)));
+#endif
+  }
+#endif
+  for (; i < words; i++) {
+    dst[i] = load_word(src + i * 8);
+  }
+}
+
+/**
+ * @brief Pack words of a frame into a window
+ *
+ * Rows are read in place from the caller's buffer; with a line size that is
+ * a multiple of 8 every word lies within one row and rows are copied whole.
+ * @param dst First word of the window to fill
+ * @param pixels Frame, rows stride bytes apart
+ * @param word First word of the frame, counted in raster order
+ * @param words Number of words
+ */
+static void pack_words(volatile u64 *dst, const uint8_t *pixels, int stride,
+                       int line_size, int word, int words) {
+  if (line_size % MEM_LINE_SIZE_PIX == 0) {
+    int row_words = line_size / MEM_LINE_SIZE_PIX;
+    while (words > 0) {
+      int y = word / row_words;
+      int x = word % row_words;
+      int run = std::min(words, row_words - x);
+      copy_words(dst, pixels + static_cast<size_t>(y) * stride +
+                          x * MEM_LINE_SIZE_PIX,
+                 run);
+      dst += run;
+      word += run;
+      words -= run;
+    }
+    return;
+  }
+
+  // Words straddle rows, gather them pixel by pixel
+  for (int i = 0; i < words; i++) {
+    u64 mem_line = 0;
+    for (int p = 0; p < MEM_LINE_SIZE_PIX; p++) {
+      int pix = (word + i) * MEM_LINE_SIZE_PIX + p;
+      u64 value = pixels[static_cast<size_t>(pix / line_size) * stride +
+                         pix % line_size];
+      mem_line |= value << (p * 8);
+    }
+    dst[i] = mem_line;
+  }
+}
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+int orb_config_load(const std::string &path, OrbAcceleratorConfig *config) {
+  FILE *file = fopen(path.c_str(), "r");
+  if (!file) {
+    perror("fopen(config)");
+    return -1;
+  }
+
+  char line[256];
+  int result = 0;
+  while (result == 0 && fgets(line, sizeof(line), file)) {
+    char key[64];
+    char first;
+    long value;
+    if (sscanf(line, " %c", &first) != 1 || first == '#') continue;
+    if (sscanf(line, " %63[a-z_] = %li", key, &value) != 2) {
+      fprintf(stderr, "%s: bad line: %s", path.c_str(), line);
+      result = -1;
+      break;
+    }
+
+    std::string name = key;
+    if (name == "line_size") {
+      config->line_size = static_cast<int>(value);
+    } else if (name == "num_lines") {
+      config->num_lines = static_cast<int>(value);
+    } else if (name == "num_scales") {
+      config->num_scales = static_cast<int>(value);
+    } else if (name == "theta_size") {
+      config->theta_size = static_cast<int>(value);
+    } else if (name == "fifo_size") {
+      config->fifo_size = static_cast<int>(value);
+    } else if (name == "constructors") {
+      config->constructors = static_cast<int>(value);
+    } else if (name == "mem_size_pix") {
+      config->mem_size_pix = static_cast<int>(value);
+    } else if (name == "ping_pong") {
+      config->ping_pong = value != 0;
+    } else if (name == "chunk_irq") {
+      config->chunk_irq = value != 0;
+    } else if (name == "feature_lines") {
+      config->feature_lines = static_cast<int>(value);
+    } else if (name == "feature_status") {
+      config->feature_status = value != 0;
+    } else if (name == "grid_cols") {
+      config->grid_cols = static_cast<int>(value);
+    } else if (name == "grid_rows") {
+      config->grid_rows = static_cast<int>(value);
+    } else if (name == "cell_k") {
+      config->cell_k = static_cast<int>(value);
+    } else if (name == "match_refs") {
+      config->match_refs = static_cast<int>(value);
+    } else if (name == "match_queue") {
+      config->match_queue = static_cast<int>(value);
+    } else if (name == "perf_counters") {
+      config->perf_counters = value != 0;
+    } else {
+      fprintf(stderr, "%s: unknown key: %s\n", path.c_str(), key);
+      result = -1;
+    }
+  }
+  fclose(file);
+  return result;
+}
+
+void OrbPerfCounters::add(const volatile u32 *words) {
+  pixels += words[PERF_PIXELS];
+  candidates += words[PERF_CANDIDATES];
+  survivors += words[PERF_SURVIVORS];
+  descriptors += words[PERF_DESCRIPTORS];
+  fifo_full_cycles += words[PERF_FIFO_FULL];
+  fifo_dropped += words[PERF_FIFO_DROPPED];
+  busy_dropped += words[PERF_BUSY_DROPPED];
+  constructor_busy_cycles += words[PERF_CONSTRUCTOR_BUSY];
+  cycles += words[PERF_CYCLES];
+  for (int level = 0; level < PERF_LEVELS; level++) {
+    fifo_high_water[level] = std::max(
+        fifo_high_water[level],
+        static_cast<u32>(words[PERF_FIFO_HIGH_WATER + level]));
+    level_fifo_dropped[level] += words[PERF_LEVEL_FIFO_DROPPED + level];
+    level_busy_dropped[level] += words[PERF_LEVEL_BUSY_DROPPED + level];
+  }
+
+  // Stamps stay 0 until their event
+  u32 first_pixel = words[PERF_FIRST_PIXEL];
+  u32 last_pixel = words[PERF_LAST_PIXEL];
+  u32 last_descriptor = words[PERF_LAST_DESCRIPTOR];
+  if (words[PERF_PIXELS] != 0) stream_cycles += last_pixel - first_pixel + 1;
+  if (last_descriptor > last_pixel) {
+    drain_cycles += last_descriptor - last_pixel;
+  }
+}
+
+void OrbPerfCounters::add(const OrbPerfCounters &other) {
+  pixels += other.pixels;
+  candidates += other.candidates;
+  survivors += other.survivors;
+  descriptors += other.descriptors;
+  fifo_full_cycles += other.fifo_full_cycles;
+  fifo_dropped += other.fifo_dropped;
+  busy_dropped += other.busy_dropped;
+  constructor_busy_cycles += other.constructor_busy_cycles;
+  stream_cycles += other.stream_cycles;
+  drain_cycles += other.drain_cycles;
+  cycles += other.cycles;
+  for (int level = 0; level < PERF_LEVELS; level++) {
+    fifo_high_water[level] =
+        std::max(fifo_high_water[level], other.fifo_high_water[level]);
+    level_fifo_dropped[level] += other.level_fifo_dropped[level];
+    level_busy_dropped[level] += other.level_busy_dropped[level];
+  }
+}
+
+void OrbFrameMetrics::add(const OrbFrameMetrics &other) {
+  decode_us += other.decode_us;
+  pack_us += other.pack_us;
+  upload_us += other.upload_us;
+  wait_us += other.wait_us;
+  readback_us += other.readback_us;
+  output_us += other.output_us;
+  upload_bytes += other.upload_bytes;
+  readback_bytes += other.readback_bytes;
+  keypoints += other.keypoints;
+  tiles += other.tiles;
+  if (!other.has_counters) return;
+  has_counters = true;
+  counters.add(other.counters);
+}
+
+// ============================================================================
+// ACCELERATOR INTERFACE
+// ============================================================================
+
+OrbAccelerator::OrbAccelerator(const OrbAcceleratorConfig &config)
+    : config_(config),
+      overflowed_(false),
+      matches_dropped_(0),
+      dma_busy_(false) {
+  memset(&regions_, 0, sizeof(regions_));
+}
+
+int OrbAccelerator::reset() {
+  regions_.reset[0] = 0;  // Reset low
+  regions_.reset[0] = 1;  // Reset high (release)
+  return 0;
+}
+
+void OrbAccelerator::set_thresholds(int32_t corner_thresh,
+                                    int32_t corner_thresh_n) {
+  regions_.corner_thresh[0] = static_cast<uint64_t>(corner_thresh);
+  regions_.corner_thresh[1] = static_cast<uint64_t>(corner_thresh_n);
+}
+
+void OrbAccelerator::clear_features() {
+  for (int i = 0; i < config_.feature_lines - 1; i++) {
+    // Clear descriptor data (2 sections, 4 components each)
+    for (int section = 1; section >= 0; section--) {
+      for (int component = 3; component >= 0; component--) {
+        regions_.descripts[section][i * 4 + component] = 0;
+      }
+    }
+    // Clear position data
+    regions_.pos[i] = 0;
+  }
+}
+
+int OrbAccelerator::process_frame(const uint8_t *pixels, int stride) {
+  int chunk_words = config_.mem_size_pix / MEM_LINE_SIZE_PIX;
+  int frame_words = config_.line_size * config_.num_lines / MEM_LINE_SIZE_PIX;
+  int halves = config_.ping_pong ? 2 : 1;
+  int half = 0;  // Half of the pixel BRAM being filled
+  int word = 0;  // Next word of the frame
+  bool use_dma = regions_.dma != NULL;
+  std::chrono::steady_clock::time_point start;
+
+  dma_stats_ = OrbDmaStats();
+
+  // Initialize input buffer
+  regions_.in_buffer[0] = 0;
+
+  // Handshake words only, stale pixels after the frame are never used
+  for (int i = 0; i < halves; i++) {
+    regions_.pixels[i * (chunk_words + 1)] = 0;
+  }
+
+  // End markers of the previous frame, the BRAMs are written from 0 again
+  if (!regions_.status) {
+    for (int i = 0; i < config_.feature_lines - 1; i++) {
+      regions_.pos[i] = 0;
+    }
+  }
+
+  // Stream the frame in chunks, word 0 of each half is its handshake word.
+  // The chunk after the last full one is always triggered, even if empty,
+  // its stale pixels flush the pipeline.
+  while (true) {
+    int base = half * (chunk_words + 1);
+    volatile u64 *chunk = regions_.pixels + base;
+    int words = std::min(chunk_words, frame_words - word);
+
+    if (use_dma) {
+      // Pack into the input buffer, the DMA moves each burst while the
+      // next one is packed
+      for (int done = 0; done < words; done += BURST_SIZE) {
+        int beats = std::min(BURST_SIZE, words - done);
+        start = std::chrono::steady_clock::now();
+        pack_words(regions_.in_buffer + base + 1 + done, pixels, stride,
+                   config_.line_size, word + done, beats);
+        metrics_.pack_us += elapsed_us(start);
+        if (dma_upload(base + 1 + done, beats) != 0) return -1;
+      }
+      if (dma_finish() != 0) return -1;
+    } else {
+      start = std::chrono::steady_clock::now();
+      pack_words(chunk + 1, pixels, stride, config_.line_size, word, words);
+      metrics_.pack_us += elapsed_us(start);
+    }
+    word += words;
+    metrics_.upload_bytes += static_cast<uint64_t>(words + 1) * sizeof(u64);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    chunk[0] = 1;  // Trigger FPGA processing
+    if (words < chunk_words) break;
+
+    // Next half, wait until the FPGA is done with it (set to 0)
+    half = (half + 1) % halves;
+    chunk = regions_.pixels + half * (chunk_words + 1);
+    start = std::chrono::steady_clock::now();
+    int waited = wait_until([chunk]() { return chunk[0] != 1; }, true);
+    metrics_.wait_us += elapsed_us(start);
+    if (waited != 0) return -1;
+  }
+
+  // Wait for the FPGA to finish every half
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < halves; i++) {
+    volatile u64 *control = regions_.pixels + i * (chunk_words + 1);
+    if (wait_until([control]() { return control[0] != 1; }, true) != 0) {
+      return -1;
+    }
+  }
+
+  // Descriptors of the last lines are still in the pipeline. orb_counters
+  // tells when the fabric has been quiet for FRAME_QUIET_CYCLES. Without it
+  // the constructors may still have a full feature FIFO to empty, so the
+  // host clock waits that long, restarted whenever the keypoint count moves
+  volatile u32 *perf = regions_.perf;
+  int drained;
+  if (perf) {
+    drained = wait_until([perf]() {
+      u32 last = std::max(static_cast<u32>(perf[PERF_LAST_PIXEL]),
+                          static_cast<u32>(perf[PERF_LAST_DESCRIPTOR]));
+      return perf[PERF_CYCLES] - last >= FRAME_QUIET_CYCLES;
+    });
+  } else {
+    int backlog_cycles = FRAME_QUIET_CYCLES +
+                         config_.fifo_size *
+                             model_config(config_).constructor_busy /
+                             std::max(config_.constructors, 1);
+    std::chrono::microseconds backlog(backlog_cycles / FABRIC_CLOCK_MHZ + 1);
+    volatile u32 *status = regions_.status;
+    u32 count = status ? status[0] : 0;
+    std::chrono::steady_clock::time_point quiet =
+        std::chrono::steady_clock::now() + backlog;
+    drained = wait_until([status, backlog, &count, &quiet]() {
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now();
+      if (status && status[0] != count) {
+        count = status[0];
+        quiet = now + backlog;
+      }
+      return now >= quiet;
+    });
+  }
+  metrics_.wait_us += elapsed_us(start);
+  if (drained != 0) {
+    fprintf(stderr, "Timeout waiting for the last descriptors\n");
+    return -1;
+  }
+  metrics_.upload_us += dma_stats_.stall_us;
+  return 0;
+}
+
+int OrbAccelerator::wait_event(int) { return -1; }
+
+int OrbAccelerator::wait_until(const std::function<bool()> &done,
+                               bool event) {
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(config_.timeout_ms);
+  int sleep_us = WAIT_SLEEP_MIN_US;
+
+  for (int polls = 0; !done(); polls++) {
+    if (polls < config_.spin_polls) continue;
+
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      // The device may have finished while we were asleep
+      return done() ? 0 : -1;
+    }
+    int left_us = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(deadline - now)
+            .count());
+    if (!event || wait_event(std::min(left_us, WAIT_SLEEP_MAX_US)) != 0) {
+      usleep(std::min(left_us, sleep_us));
+      sleep_us = std::min(sleep_us * 2, WAIT_SLEEP_MAX_US);
+    }
+  }
+  return 0;
+}
+
+void OrbAccelerator::dma_issue(dma_instr_t instr) {
+  dma_start(regions_.dma, instr);
+}
+
+/**
+ * @brief Move words of the input buffer to the same words of the pixel BRAM
+ *
+ * Waits for the transfer in flight, if any, before starting the new one.
+ * @param word First word, counted from the start of both windows
+ * @param beats Number of words, at most 255
+ * @return 0 on success, -1 if the previous transfer timed out
+ */
+int OrbAccelerator::dma_upload(int word, int beats) {
+  dma_instr_t instruction;
+  u32 offset = static_cast<u32>(word) * sizeof(u64);
+
+  if (dma_finish() != 0) return -1;
+  dma_create_tx(&instruction, DMA_DRAM_TO_FPGA, INPUT_BUFFER_BASE_ADDR + offset,
+                config_.dma_pl_addr + offset, 0, beats, beats);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  dma_started_ = std::chrono::steady_clock::now();
+  dma_issue(instruction);
+  dma_busy_ = true;
+  dma_stats_.transfers++;
+  dma_stats_.bytes += static_cast<uint64_t>(beats) * sizeof(u64);
+  return 0;
+}
+
+/**
+ * @brief Wait for the transfer in flight and record its timing
+ * @return 0 on success, -1 on timeout
+ */
+int OrbAccelerator::dma_finish() {
+  if (!dma_busy_) return 0;
+
+  volatile u32 *dma = regions_.dma;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  int result = wait_until([dma]() { return dma_done(dma) != 0; });
+  std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+  dma_stats_.stall_us +=
+      std::chrono::duration<double, std::micro>(stop - start).count();
+  dma_stats_.transfer_us.push_back(
+      std::chrono::duration<double, std::micro>(stop - dma_started_).count());
+  dma_busy_ = false;
+  return result;
+}
+
+/**
+ * @brief Reset, process one frame and add its counters to the metrics
+ */
+int OrbAccelerator::run_frame(const uint8_t *pixels, int stride) {
+  if (reset() != 0) return -1;
+  if (process_frame(pixels, stride) != 0) return -1;
+  metrics_.tiles++;
+  if (regions_.perf) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    metrics_.counters.add(regions_.perf);
+    metrics_.has_counters = true;
+    metrics_.readback_us += elapsed_us(start);
+  }
+  return 0;
+}
+
+/**
+ * @brief run_frame() and read_batch(), adding to the metrics of the frame
+ */
+int OrbAccelerator::detect_batch(const uint8_t *pixels, int stride,
+                                 KeypointBatch *batch) {
+  if (run_frame(pixels, stride) != 0) return -1;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  int count = read_batch(batch);
+  metrics_.readback_us += elapsed_us(start);
+  return count;
+}
+
+int OrbAccelerator::detect(const uint8_t *pixels, int stride,
+                           std::vector<OrbFeature> *features) {
+  metrics_ = OrbFrameMetrics();
+  if (run_frame(pixels, stride) != 0) return -1;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  metrics_.keypoints = read_features(features);
+  metrics_.readback_us += elapsed_us(start);
+  return metrics_.keypoints;
+}
+
+int OrbAccelerator::detect(const uint8_t *pixels, int stride,
+                           KeypointBatch *batch) {
+  metrics_ = OrbFrameMetrics();
+  int count = detect_batch(pixels, stride, batch);
+  metrics_.keypoints = std::max(count, 0);
+  return count;
+}
+
+int OrbAccelerator::detect_tiled(const uint8_t *pixels, int stride,
+                                 int width, int height, KeypointBatch *batch) {
+  std::vector<OrbTile> grid = tiles(width, height);
+  bool overflowed = false;
+
+  metrics_ = OrbFrameMetrics();
+  if (grid.empty()) return -1;
+  batch->clear();
+  batch->theta_size = config_.theta_size;
+  for (size_t t = 0; t < grid.size(); t++) {
+    const OrbTile &tile = grid[t];
+    const uint8_t *origin =
+        pixels + static_cast<size_t>(tile.y) * stride + tile.x;
+    if (detect_batch(origin, stride, &tile_batch_) < 0) return -1;
+    overflowed = overflowed || overflowed_;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (int i = 0; i < tile_batch_.count; i++) {
+      int x = tile_batch_.x[i] + tile.x;
+      int y = tile_batch_.y[i] + tile.y;
+      if (x >= tile.x_begin && x < tile.x_end && y >= tile.y_begin &&
+          y < tile.y_end) {
+        batch->push_back(tile_batch_, i, tile.x, tile.y);
+      }
+    }
+    metrics_.readback_us += elapsed_us(start);
+  }
+  overflowed_ = overflowed;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  batch->sort_by_score();
+  metrics_.readback_us += elapsed_us(start);
+  metrics_.keypoints = batch->count;
+  return batch->count;
+}
+
+std::vector<OrbTile> OrbAccelerator::tiles(int width, int height) const {
+  int align = 1 << (config_.num_scales - 1);
+  int margin = TILE_MARGIN_PIX * align;
+  std::vector<int> xs = tile_origins(width, config_.line_size, margin, align);
+  std::vector<int> ys = tile_origins(height, config_.num_lines, margin, align);
+  std::vector<OrbTile> grid;
+
+  // Neighbours split their overlap in the middle
+  for (size_t j = 0; j < ys.size(); j++) {
+    for (size_t i = 0; i < xs.size(); i++) {
+      OrbTile tile;
+      tile.x = xs[i];
+      tile.y = ys[j];
+      tile.x_begin = i == 0 ? 0 : (xs[i - 1] + config_.line_size + xs[i]) / 2;
+      tile.x_end = i + 1 == xs.size()
+                       ? width
+                       : (xs[i] + config_.line_size + xs[i + 1]) / 2;
+      tile.y_begin = j == 0 ? 0 : (ys[j - 1] + config_.num_lines + ys[j]) / 2;
+      tile.y_end = j + 1 == ys.size()
+                       ? height
+                       : (ys[j] + config_.num_lines + ys[j + 1]) / 2;
+      grid.push_back(tile);
+    }
+  }
+  return grid;
+}
+
+int OrbAccelerator::read_features(std::vector<OrbFeature> *features) {
+  int count = fetch_features();
+
+  features->resize(count);
+  for (int i = 0; i < count; i++) {
+    OrbFeature &feature = (*features)[i];
+    feature.pos = pos_[i];
+    feature.scr_angle = scr_angle_[i];
+    for (int section = 0; section < 2; section++) {
+      memcpy(&feature.descriptor[section * 4], &descripts_[section][i * 4],
+             4 * sizeof(u32));
+    }
+  }
+  return count;
+}
+
+int OrbAccelerator::read_batch(KeypointBatch *batch) {
+  int count = fetch_features();
+  batch->theta_size = config_.theta_size;
+  batch->assign(pos_.data(), scr_angle_.data(), descripts_[0].data(),
+                descripts_[1].data(), count);
+  return count;
+}
+
+int OrbAccelerator::load_references(const uint8_t *descriptors, int count) {
+  if (!regions_.match) return -1;
+  count = std::min(std::max(count, 0), config_.match_refs);
+
+  std::vector<u32> words(static_cast<size_t>(count) * MATCH_REF_WORDS);
+  memcpy(words.data(), descriptors, words.size() * sizeof(u32));
+  for (size_t i = 0; i < words.size(); i++) regions_.match[i] = words[i];
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  regions_.match[MATCH_COUNT_WORD] = static_cast<u32>(count);
+  return count;
+}
+
+/**
+ * @brief Decode one match table word
+ */
+static void decode_match(u32 word, int *index, int *distance) {
+  bool valid = (word & MATCH_VALID) != 0;
+  *index = valid ? static_cast<int>(word & MATCH_INDEX_MASK) : -1;
+  *distance = valid ? static_cast<int>((word >> MATCH_DISTANCE_SHIFT) &
+                                       MATCH_DISTANCE_MASK)
+                    : 0;
+}
+
+int OrbAccelerator::read_matches(std::vector<KeypointMatch> *matches) {
+  if (!regions_.match) return -1;
+  volatile u32 *match = regions_.match;
+  if (wait_until([match]() {
+        return (match[MATCH_STATUS_WORD] & MATCH_STATUS_BUSY) == 0;
+      }) != 0) {
+    fprintf(stderr, "Timeout waiting for the descriptor matcher\n");
+    return -1;
+  }
+  matches_dropped_ =
+      static_cast<int>(match[MATCH_STATUS_WORD] & MATCH_STATUS_DROPPED);
+
+  matches->resize(order_.size());
+  for (size_t i = 0; i < order_.size(); i++) {
+    const volatile u32 *words = match + MATCH_TABLE_WORD + order_[i] * 2;
+    KeypointMatch &m = (*matches)[i];
+    decode_match(words[0], &m.best, &m.best_distance);
+    decode_match(words[1], &m.second, &m.second_distance);
+  }
+  return static_cast<int>(matches->size());
+}
+
+/**
+ * @brief Copy from a feature window
+ *
+ * The windows are uncached; memcpy turns the copy into multi-word loads
+ * (LDM/NEON on the Cortex-A9), i.e. AXI bursts instead of single beats.
+ * Sources and destinations are word aligned.
+ */
+static void copy_window(void *dst, const volatile void *src, size_t bytes) {
+  memcpy(dst, const_cast<const void *>(src), bytes);
+}
+
+/**
+ * @brief Bulk copy of the used part of the feature windows
+ *
+ * The keypoint count comes from the status word when there is one; with a
+ * grid the used entries are spread over the cells, so all of them are
+ * copied and the empty ones, pos == 0, skipped. Without a grid every
+ * counted entry is a keypoint, one on (0, 0) included. Without the status
+ * word the pos window is copied a block at a time until the pos == 0 end
+ * marker, which also ends the list at a keypoint on (0, 0).
+ * @return Number of keypoints
+ */
+int OrbAccelerator::fetch_features() {
+  const int block = 32;
+  int lines = config_.feature_lines;
+  int cells = config_.grid_cols * config_.grid_rows;
+  int count = 0;
+  int entries = 0;
+  bool sparse = false;  // Empty entries among the copied ones
+
+  pos_.resize(lines);
+  overflowed_ = false;
+  if (regions_.status) {
+    u32 status = regions_.status[0];
+    count = std::min(static_cast<int>(status & FEATURE_STATUS_COUNT), lines);
+    overflowed_ = (status & FEATURE_STATUS_OVERFLOW) != 0;
+    sparse = cells > 1;
+    entries = sparse ? std::min(cells * config_.cell_k, lines) : count;
+    copy_window(pos_.data(), regions_.pos, entries * sizeof(u32));
+    metrics_.readback_bytes += (entries + 1) * sizeof(u32);
+  } else {
+    lines--;  // The last entry is never cleared
+    while (count < lines) {
+      int n = std::min(block, lines - count);
+      copy_window(&pos_[count], regions_.pos + count, n * sizeof(u32));
+      metrics_.readback_bytes += n * sizeof(u32);
+
+      int end = count + n;
+      while (count < end && pos_[count] != 0) count++;
+      if (count < end) break;  // End of valid features
+    }
+    entries = count;
+  }
+
+  scr_angle_.resize(lines);
+  copy_window(scr_angle_.data(), regions_.scr_angle, entries * sizeof(u32));
+  for (int section = 0; section < 2; section++) {
+    descripts_[section].resize(lines * 4);
+    copy_window(descripts_[section].data(), regions_.descripts[section],
+                entries * 4 * sizeof(u32));
+  }
+  metrics_.readback_bytes += entries * 9 * sizeof(u32);
+  return sort_features(entries, sparse);
+}
+
+/**
+ * @brief Move the keypoints of the copied entries to the front of the
+ *        copies, by decreasing score, ties in BRAM order
+ *
+ * @param entries Copied entries
+ * @param sparse Whether empty cells are among them, as pos == 0 entries to
+ *               skip; otherwise every entry is a keypoint, (0, 0) included
+ * @return Number of keypoints
+ */
+int OrbAccelerator::sort_features(int entries, bool sparse) {
+  order_.clear();
+  for (int i = 0; i < entries; i++) {
+    if (!sparse || pos_[i] != 0) order_.push_back(i);
+  }
+  const std::vector<u32> &scr_angle = scr_angle_;
+  std::stable_sort(order_.begin(), order_.end(), [&scr_angle](int a, int b) {
+    return (scr_angle[a] & 0x0FFF0000) > (scr_angle[b] & 0x0FFF0000);
+  });
+
+  std::vector<u32> *windows[] = {&pos_, &scr_angle_, &descripts_[0],
+                                 &descripts_[1]};
+  const int words[] = {1, 1, 4, 4};
+  for (int w = 0; w < 4; w++) {
+    std::vector<u32> &window = *windows[w];
+    sorted_.resize(order_.size() * words[w]);
+    for (size_t i = 0; i < order_.size(); i++) {
+      memcpy(&sorted_[i * words[w]], &window[order_[i] * words[w]],
+             words[w] * sizeof(u32));
+    }
+    std::copy(sorted_.begin(), sorted_.end(), window.begin());
+  }
+  return static_cast<int>(order_.size());
+}
+
+std::unique_ptr<OrbAccelerator> orb_accelerator_create(
+    const std::string &backend, const OrbAcceleratorConfig &config) {
+  std::unique_ptr<OrbAccelerator> accelerator;
+  if (backend == "zynq") {
+    accelerator.reset(new ZynqAccelerator(config));
+  } else if (backend == "shm") {
+    accelerator.reset(new ShmAccelerator(config, true));
+  } else if (backend == "model") {
+    accelerator.reset(new ModelAccelerator(config));
+  }
+  return accelerator;
+}
+
+// ============================================================================
+// ZYNQ BACKEND
+// ============================================================================
+
+ZynqAccelerator::ZynqAccelerator(const OrbAcceleratorConfig &config)
+    : OrbAccelerator(config), fd_(-1), uio_fd_(-1) {}
+
+ZynqAccelerator::~ZynqAccelerator() { close(); }
+
+void *ZynqAccelerator::map(off_t base_addr, off_t addr_high) {
+  size_t size = static_cast<size_t>(addr_high + 1 - base_addr);
+  void *ptr =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, base_addr);
+  if (ptr == MAP_FAILED) {
+    perror("mmap(/dev/mem)");
+    return NULL;
+  }
+  mappings_.push_back(std::make_pair(ptr, size));
+  return ptr;
+}
+
+int ZynqAccelerator::open() {
+  if ((fd_ = ::open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
+    perror("open(/dev/mem)");
+    return -1;
+  }
+
+  regions_.pixels =
+      static_cast<volatile u64 *>(map(BRAM_BASE_ADDR, BRAM_ADDR_HIGH));
+  regions_.in_buffer = static_cast<volatile u64 *>(
+      map(INPUT_BUFFER_BASE_ADDR, INPUT_BUFFER_ADDR_HIGH));
+  regions_.descripts[0] = static_cast<volatile u32 *>(
+      map(BRAM_DESCRIPT0_BASE_ADDR, BRAM_DESCRIPT0_ADDR_HIGH));
+  regions_.descripts[1] = static_cast<volatile u32 *>(
+      map(BRAM_DESCRIPT1_BASE_ADDR, BRAM_DESCRIPT1_ADDR_HIGH));
+  regions_.pos = static_cast<volatile u32 *>(
+      map(BRAM_DESCRIPT_POS_BASE_ADDR, BRAM_DESCRIPT_POS_ADDR_HIGH));
+  regions_.scr_angle = static_cast<volatile u32 *>(map(
+      BRAM_DESCRIPT_SCR_ANGLE_BASE_ADDR, BRAM_DESCRIPT_SCR_ANGLE_ADDR_HIGH));
+  regions_.reset =
+      static_cast<volatile u64 *>(map(RESET_BASE_ADDR, RESET_ADDR_HIGH));
+  if (config_.feature_status && regions_.reset) {
+    // GPIO2_DATA register of axi_gpio_reset_fast
+    regions_.status = reinterpret_cast<volatile u32 *>(regions_.reset) + 2;
+  }
+  regions_.corner_thresh = static_cast<volatile u64 *>(
+      map(CORNER_THRESH_BASE_ADDR, CORNER_THRESH_ADDR_HIGH));
+  if (config_.dma_base_addr != 0) {
+    regions_.dma = static_cast<volatile u32 *>(
+        map(config_.dma_base_addr,
+            config_.dma_base_addr + DMA_ADDR_SPAN - 1));
+    if (!regions_.dma) {
+      close();
+      return -1;
+    }
+  }
+  if (config_.match_refs > 0) {
+    regions_.match = static_cast<volatile u32 *>(
+        map(BRAM_MATCH_BASE_ADDR, BRAM_MATCH_ADDR_HIGH));
+    if (!regions_.match) {
+      close();
+      return -1;
+    }
+  }
+  if (config_.perf_counters) {
+    regions_.perf = static_cast<volatile u32 *>(
+        map(BRAM_PERF_BASE_ADDR, BRAM_PERF_ADDR_HIGH));
+    if (!regions_.perf) {
+      close();
+      return -1;
+    }
+  }
+
+  if (!regions_.pixels || !regions_.in_buffer || !regions_.descripts[0] ||
+      !regions_.descripts[1] || !regions_.pos || !regions_.scr_angle ||
+      !regions_.reset || !regions_.corner_thresh) {
+    close();
+    return -1;
+  }
+
+  if (!config_.uio_path.empty() &&
+      (uio_fd_ = ::open(config_.uio_path.c_str(), O_RDWR)) == -1) {
+    perror("open(uio_path)");
+    close();
+    return -1;
+  }
+  return 0;
+}
+
+void ZynqAccelerator::close() {
+  for (size_t i = 0; i < mappings_.size(); i++) {
+    munmap(mappings_[i].first, mappings_[i].second);
+  }
+  mappings_.clear();
+  memset(&regions_, 0, sizeof(regions_));
+  if (uio_fd_ != -1) {
+    ::close(uio_fd_);
+    uio_fd_ = -1;
+  }
+  if (fd_ != -1) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+/**
+ * @brief Block on the chunk_done interrupt
+ *
+ * The UIO interrupt is re-enabled before blocking; one that fired before is
+ * still pending and returns at once.
+ */
+int ZynqAccelerator::wait_event(int timeout_us) {
+  if (uio_fd_ == -1) return -1;
+
+  u32 enable = 1;
+  if (write(uio_fd_, &enable, sizeof(enable)) != sizeof(enable)) return -1;
+
+  struct timespec timeout = {timeout_us / 1000000,
+                             (timeout_us % 1000000) * 1000L};
+  struct pollfd event = {uio_fd_, POLLIN, 0};
+  if (ppoll(&event, 1, &timeout, NULL) > 0) {
+    u32 count;
+    if (read(uio_fd_, &count, sizeof(count)) != sizeof(count)) return -1;
+  }
+  return 0;
+}
+
+// ============================================================================
+// SHARED MEMORY BACKEND
+// ============================================================================
+
+ShmAccelerator::ShmAccelerator(const OrbAcceleratorConfig &config,
+                               bool emulate_device)
+    : OrbAccelerator(config),
+      emulate_device_(emulate_device),
+      fd_(-1),
+      event_fd_(-1),
+      base_(NULL),
+      size_(0),
+      model_(model_config(config)),
+      running_(false),
+      reset_seen_(false) {}
+
+ShmAccelerator::~ShmAccelerator() { close(); }
+
+int ShmAccelerator::open() {
+  const size_t sizes[] = {SHM_PIXELS_SIZE,   SHM_IN_BUFFER_SIZE,
+                          SHM_DESCRIPT_SIZE, SHM_DESCRIPT_SIZE,
+                          SHM_POS_SIZE,      SHM_SCR_ANGLE_SIZE,
+                          SHM_GPIO_SIZE,     SHM_GPIO_SIZE,
+                          DMA_ADDR_SPAN,     SHM_MATCH_SIZE,
+                          SHM_PERF_SIZE};
+  size_t offsets[11];
+  size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+  size_ = 0;
+  for (int i = 0; i < 11; i++) {
+    offsets[i] = size_;
+    size_ += (sizes[i] + page - 1) / page * page;
+  }
+
+  fd_ = ::open(config_.shm_path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (fd_ == -1) {
+    perror("open(shm_path)");
+    return -1;
+  }
+  if (ftruncate(fd_, static_cast<off_t>(size_)) == -1) {
+    perror("ftruncate(shm_path)");
+    close();
+    return -1;
+  }
+  void *ptr = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (ptr == MAP_FAILED) {
+    perror("mmap(shm_path)");
+    close();
+    return -1;
+  }
+  base_ = static_cast<uint8_t *>(ptr);
+
+  regions_.pixels = reinterpret_cast<volatile u64 *>(base_ + offsets[0]);
+  regions_.in_buffer = reinterpret_cast<volatile u64 *>(base_ + offsets[1]);
+  regions_.descripts[0] = reinterpret_cast<volatile u32 *>(base_ + offsets[2]);
+  regions_.descripts[1] = reinterpret_cast<volatile u32 *>(base_ + offsets[3]);
+  regions_.pos = reinterpret_cast<volatile u32 *>(base_ + offsets[4]);
+  regions_.scr_angle = reinterpret_cast<volatile u32 *>(base_ + offsets[5]);
+  regions_.reset = reinterpret_cast<volatile u64 *>(base_ + offsets[6]);
+  regions_.corner_thresh =
+      reinterpret_cast<volatile u64 *>(base_ + offsets[7]);
+  if (config_.feature_status) {
+    regions_.status = reinterpret_cast<volatile u32 *>(base_ + offsets[6]) + 2;
+  }
+  if (config_.dma_base_addr != 0) {
+    regions_.dma = reinterpret_cast<volatile u32 *>(base_ + offsets[8]);
+    regions_.dma[0] = 0;
+  }
+  if (config_.match_refs > 0) {
+    regions_.match = reinterpret_cast<volatile u32 *>(base_ + offsets[9]);
+  }
+  if (config_.perf_counters) {
+    regions_.perf = reinterpret_cast<volatile u32 *>(base_ + offsets[10]);
+  }
+
+  if (emulate_device_) {
+    if ((event_fd_ = eventfd(0, EFD_NONBLOCK)) == -1) {
+      perror("eventfd");
+      close();
+      return -1;
+    }
+    running_ = true;
+    device_ = std::thread(&ShmAccelerator::device_loop, this);
+  }
+  return 0;
+}
+
+void ShmAccelerator::close() {
+  if (device_.joinable()) {
+    running_ = false;
+    device_.join();
+  }
+  if (base_) {
+    munmap(base_, size_);
+    base_ = NULL;
+  }
+  memset(&regions_, 0, sizeof(regions_));
+  if (event_fd_ != -1) {
+    ::close(event_fd_);
+    event_fd_ = -1;
+  }
+  if (fd_ != -1) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+/**
+ * @brief Hold the reset low until the device thread has seen it
+ *
+ * The GPIO pulse of the board lasts long enough for the fabric, a thread
+ * polling the window could miss it.
+ */
+int ShmAccelerator::reset() {
+  int result = 0;
+  regions_.reset[0] = 0;  // Reset low
+  if (device_.joinable()) {
+    reset_seen_ = false;
+    if (wait_until([this]() { return reset_seen_.load(); }) != 0) {
+      fprintf(stderr, "Timeout waiting for the device thread to reset\n");
+      result = -1;
+    }
+  }
+  regions_.reset[0] = 1;  // Reset high (release)
+  return result;
+}
+
+/**
+ * @brief Clear the status register on start, as the DMA controller does
+ */
+void ShmAccelerator::dma_issue(dma_instr_t instr) {
+  regions_.dma[1] = 0;
+  OrbAccelerator::dma_issue(instr);
+}
+
+int ShmAccelerator::wait_event(int timeout_us) {
+  if (event_fd_ == -1) return -1;
+
+  struct timespec timeout = {timeout_us / 1000000,
+                             (timeout_us % 1000000) * 1000L};
+  struct pollfd event = {event_fd_, POLLIN, 0};
+  if (ppoll(&event, 1, &timeout, NULL) > 0) {
+    eventfd_t count;
+    eventfd_read(event_fd_, &count);
+  }
+  return 0;
+}
+
+/**
+ * @brief Serve a pending DRAM to FPGA transfer of the DMA window
+ */
+void ShmAccelerator::device_dma() {
+  u32 opcode = regions_.dma[0];
+  if (opcode == 0) return;
+
+  if ((opcode & DMA_DRAM_TO_FPGA) != 0) {
+    size_t beats = (opcode & 0x000000FF) + 1;
+    size_t ib = (regions_.dma[2] - INPUT_BUFFER_BASE_ADDR) / sizeof(u64);
+    size_t pl = (regions_.dma[3] - config_.dma_pl_addr) / sizeof(u64);
+    for (size_t i = 0; i < beats; i++) {
+      regions_.pixels[pl + i] = regions_.in_buffer[ib + i];
+    }
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  regions_.dma[0] = 0;
+  regions_.dma[1] = 1;  // Done
+  eventfd_write(event_fd_, 1);
+}
+
+/**
+ * @brief FPGA side of the pixel handshake (get_pix.vhd)
+ *
+ * Each trigger streams a whole chunk. Pixels left in the chunk after the
+ * last line of the frame are dropped, as the host resets the core before
+ * the next frame. With ping_pong the halves are consumed alternately,
+ * starting from half 0 after a reset. Transfers of the DMA window are
+ * served in between.
+ */
+void ShmAccelerator::device_loop() {
+  size_t frame_size =
+      static_cast<size_t>(config_.line_size) * config_.num_lines;
+  size_t chunk_words = config_.mem_size_pix / MEM_LINE_SIZE_PIX;
+  std::vector<uint8_t> frame(frame_size);
+  size_t filled = 0;
+  int half = 0;
+  int idle = 0;
+
+  while (running_) {
+    if (regions_.dma && regions_.dma[0] != 0) {
+      device_dma();
+      idle = 0;
+    }
+
+    if (regions_.reset[0] == 0) {
+      filled = 0;
+      half = 0;
+      if (regions_.status) regions_.status[0] = 0;
+      match_reset(regions_, config_.feature_lines);
+      for (int i = 0; regions_.perf && i < PERF_WORDS; i++) {
+        regions_.perf[i] = 0;
+      }
+      reset_seen_ = true;
+    }
+
+    volatile u64 *chunk = regions_.pixels + half * (chunk_words + 1);
+    if (chunk[0] != 1) {
+      if (++idle > DEVICE_SPIN_POLLS) usleep(DEVICE_SLEEP_US);
+      continue;
+    }
+    idle = 0;
+
+    for (size_t i = 1; i <= chunk_words && filled < frame_size; i++) {
+      u64 word = chunk[i];
+      for (int p = 0; p < MEM_LINE_SIZE_PIX && filled < frame_size; p++) {
+        frame[filled++] = static_cast<uint8_t>(word >> (p * 8));
+      }
+    }
+
+    if (filled == frame_size) {
+      model_run(&model_, regions_, frame.data(), config_.line_size);
+      // The fabric counts on after its last event, and the emulated one
+      // has drained by the time it releases the chunk
+      if (regions_.perf) regions_.perf[PERF_CYCLES] += FRAME_QUIET_CYCLES;
+      filled = 0;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    chunk[0] = 0;  // Chunk consumed
+    eventfd_write(event_fd_, 1);
+    if (config_.ping_pong) half ^= 1;
+  }
+}
+
+// ============================================================================
+// SOFTWARE MODEL BACKEND
+// ============================================================================
+
+ModelAccelerator::ModelAccelerator(const OrbAcceleratorConfig &config)
+    : OrbAccelerator(config), model_(model_config(config)) {}
+
+int ModelAccelerator::open() {
+  size_t lines = static_cast<size_t>(config_.feature_lines);
+  words_.assign(4, 0);
+  brams_.assign(lines * 10, 0);
+
+  // Same register offsets as the GPIO windows of the block design
+  regions_.reset = &words_[0];
+  regions_.corner_thresh = &words_[2];
+  if (config_.feature_status) {
+    regions_.status = reinterpret_cast<volatile u32 *>(&words_[1]);
+  }
+  regions_.pos = &brams_[0];
+  regions_.scr_angle = &brams_[lines];
+  regions_.descripts[0] = &brams_[lines * 2];
+  regions_.descripts[1] = &brams_[lines * 6];
+  if (config_.match_refs > 0) {
+    match_.assign(MATCH_WINDOW_WORDS, 0);
+    regions_.match = &match_[0];
+  }
+  if (config_.perf_counters) {
+    perf_.assign(PERF_WORDS, 0);
+    regions_.perf = &perf_[0];
+  }
+  return 0;
+}
+
+void ModelAccelerator::close() {
+  memset(&regions_, 0, sizeof(regions_));
+  words_.clear();
+  brams_.clear();
+  match_.clear();
+  perf_.clear();
+}
+
+/**
+ * The model stands in for the fabric, its run is the wait of the frame.
+ */
+int ModelAccelerator::process_frame(const uint8_t *pixels, int stride) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  model_run(&model_, regions_, pixels, stride);
+  metrics_.wait_us += elapsed_us(start);
+  return 0;
+}
@@ -0,0 +1,587 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file orb_accelerator.h
+ * @brief Accelerator backends behind a common interface
+ *
+ * The host code talks to the ORB accelerator through the memory windows of
+ * the block design (pixel BRAM, descriptor BRAMs and GPIOs). OrbAccelerator
+ * owns one set of windows and implements streaming and readback on top of
+ * them, so the same code runs on every backend:
+ *
+ * - zynq:  windows mapped from /dev/mem on the Zybo
+ * - shm:   windows in a shared file (default /dev/shm), served by an
+ *          emulated device thread running the software model
+ * - model: the software model called directly, no pixel upload
+ *
+ * Several instances may coexist in one process.
+ */
+
+#ifndef ORB_ACCELERATOR_H
+#define ORB_ACCELERATOR_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dma_zcu.h"
+#include "keypoint_batch.h"
+#include "orb_model.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+/**
+ * @brief Geometry of the bitstream and backend options
+ *
+ * The defaults are those ORB_sample_bd.tcl builds, for a bitstream without a
+ * sidecar file.
+ */
+struct OrbAcceleratorConfig {
+  int line_size;         // Image width in pixels
+  int num_lines;         // Image height in pixels
+  int num_scales;        // Pyramid levels (orb.vhd ACONF_NUM_SCALES)
+  int theta_size;        // log2 of the sectors per quadrant (ACONF_THETA_SIZE)
+  int fifo_size;         // Feature FIFO entries (ACONF_FEATURE_FIFO_SIZE)
+  int constructors;      // Constructors per level (ACONF_NUM_CONSTRUCTORS)
+  int mem_size_pix;      // Pixels per upload chunk (get_pix MEM_SIZE)
+  bool ping_pong;        // Two chunks in the pixel BRAM (get_pix PING_PONG)
+  bool chunk_irq;        // get_pix chunk_done wired to IRQ_F2P
+  u32 dma_base_addr;     // DMA controller registers, 0 uploads with the CPU
+  u32 dma_pl_addr;       // Pixel BRAM as addressed by the DMA
+  int feature_lines;     // Entries of the descriptor BRAMs
+  bool feature_status;   // Keypoint count from write_descriptors status
+  int grid_cols;         // Selection cells per line (write_descriptors GRID_X)
+  int grid_rows;         // Selection cells per column (GRID_Y)
+  int cell_k;            // Keypoints kept per cell (CELL_K)
+  int match_refs;        // References of descriptor_match, 0 without it
+  int match_queue;       // Keypoints descriptor_match queues (QUEUE_DEPTH)
+  bool perf_counters;    // Event counters of orb_counters in the fabric
+  int timeout_ms;        // Longest wait for the accelerator, then an error
+  int spin_polls;        // Polls before a wait starts to sleep or block
+  std::string uio_path;  // UIO device of the get_pix chunk_done interrupt
+  std::string shm_path;  // Backing file of the shm backend
+
+  OrbAcceleratorConfig()
+      : line_size(640),
+        num_lines(480),
+        num_scales(3),
+        theta_size(3),
+        fifo_size(256),
+        constructors(1),
+        mem_size_pix(32760),  // MEM_SIZE_PIX_PING_PONG
+        ping_pong(true),
+        chunk_irq(true),
+        dma_base_addr(0),
+        dma_pl_addr(BRAM_BASE_ADDR),
+        feature_lines(512),
+        feature_status(true),
+        grid_cols(1),
+        grid_rows(1),
+        cell_k(512),
+        match_refs(512),
+        match_queue(16),
+        perf_counters(true),
+        timeout_ms(1000),
+        spin_polls(1000),
+        shm_path("/dev/shm/orb_accelerator") {}
+};
+
+/**
+ * @brief Read the geometry of a bitstream from its sidecar file
+ *
+ * One "key = value" per line, keys named after the fields of
+ * OrbAcceleratorConfig: line_size, num_lines, num_scales, theta_size,
+ * fifo_size, constructors, mem_size_pix, ping_pong, chunk_irq,
+ * feature_lines, feature_status, grid_cols, grid_rows, cell_k, match_refs,
+ * match_queue and perf_counters.
+ * Lines starting with '#' are comments; keys not in the file keep their
+ * value.
+ * gen_bit-bin.sh writes the file from the generics of the block design.
+ * @return 0 on success, -1 if the file cannot be read or has an unknown key
+ */
+int orb_config_load(const std::string &path, OrbAcceleratorConfig *config);
+
+#define MEM_LINE_SIZE_PIX 8  // Pixels per pixel BRAM word
+// Pixels per chunk when the 64 KiB pixel BRAM is split in two halves
+#define MEM_SIZE_PIX_PING_PONG 32760
+#define BURST_SIZE 254  // Pixel BRAM words per DMA transfer
+// Keypoint-free border of a frame at each scale: half the 37x37 orientation
+// window, which also covers the 7x7 FAST and the BRIEF patch
+#define TILE_MARGIN_PIX 18
+
+/**
+ * @brief Memory windows of one accelerator instance
+ *
+ * Pointers are null when the backend has no such window.
+ */
+struct OrbRegions {
+  volatile u64 *pixels;         // Pixel BRAM, word 0 is the handshake word
+  volatile u64 *in_buffer;      // DDR input buffer
+  volatile u32 *dma;            // DMA controller registers
+  volatile u32 *descripts[2];   // Descriptor bits 0-127 and 128-255
+  volatile u32 *pos;            // Keypoint positions
+  volatile u32 *scr_angle;      // Keypoint score, angle and scale
+  volatile u64 *corner_thresh;  // FAST thresholds, [0] darker, [1] brighter
+  volatile u64 *reset;          // Active low reset
+  volatile u32 *status;         // Keypoint count and overflow, GPIO2 of reset
+  volatile u32 *match;          // descriptor_match window
+  volatile u32 *perf;           // orb_counters window, PERF_WORDS words
+};
+
+/**
+ * @brief One tile of a frame larger than the bitstream
+ *
+ * The tile is the line_size x num_lines window at (x, y). Neighbouring tiles
+ * overlap by at least twice the keypoint-free border, and each keeps only the
+ * keypoints of its own part of the overlap, [x_begin, x_end) x
+ * [y_begin, y_end) in frame pixels, so every keypoint is found once with
+ * its whole window inside a tile.
+ */
+struct OrbTile {
+  int x;
+  int y;
+  int x_begin;
+  int x_end;
+  int y_begin;
+  int y_end;
+};
+
+/**
+ * @brief DMA upload statistics of the last frame
+ *
+ * Transfer times go from the start of a transfer to the moment the host sees
+ * it done, which is checked before the next transfer is started.
+ */
+struct OrbDmaStats {
+  int transfers;                    // Transfers issued
+  uint64_t bytes;                   // Bytes moved to the pixel BRAM
+  double stall_us;                  // Host time spent waiting on the DMA
+  std::vector<double> transfer_us;  // Duration of each transfer
+
+  OrbDmaStats() : transfers(0), bytes(0), stall_us(0) {}
+};
+
+/**
+ * @brief Events counted by orb_counters in the fabric, summed over tiles
+ *
+ * Counts add up the pyramid levels, and the per level arrays split the FIFO
+ * state and the drops by level. The fabric is clocked at 100 MHz and takes
+ * one level 0 pixel per clock, so a stream_cycles well above pixels means
+ * the fabric waited for pixels, i.e. on the host or the bus. A level whose
+ * FIFO reached fifo_size - 1 entries dropped on a full FIFO; one that drops
+ * on a busy constructor needs more constructors, not a deeper FIFO.
+ */
+struct OrbPerfCounters {
+  uint64_t pixels;                   // Pixels into level 0
+  uint64_t candidates;               // FAST corners before the NMS
+  uint64_t survivors;                // Corners left by the NMS
+  uint64_t descriptors;              // Descriptors out of orb.vhd
+  uint64_t fifo_full_cycles;         // Clocks a feature FIFO was full
+  uint64_t fifo_dropped;             // Features dropped on a full FIFO
+  uint64_t busy_dropped;             // Dropped on a busy constructor
+  uint64_t constructor_busy_cycles;  // Clocks all constructors were busy
+  uint64_t stream_cycles;            // First to last pixel
+  uint64_t drain_cycles;             // Last pixel to last descriptor
+  uint64_t cycles;                   // Reset to readback
+  // Most features queued in the FIFO of each level, the highest of the tiles
+  u32 fifo_high_water[PERF_LEVELS];
+  uint64_t level_fifo_dropped[PERF_LEVELS];  // fifo_dropped of each level
+  uint64_t level_busy_dropped[PERF_LEVELS];  // busy_dropped of each level
+
+  OrbPerfCounters()
+      : pixels(0),
+        candidates(0),
+        survivors(0),
+        descriptors(0),
+        fifo_full_cycles(0),
+        fifo_dropped(0),
+        busy_dropped(0),
+        constructor_busy_cycles(0),
+        stream_cycles(0),
+        drain_cycles(0),
+        cycles(0) {
+    std::fill(fifo_high_water, fifo_high_water + PERF_LEVELS, 0);
+    std::fill(level_fifo_dropped, level_fifo_dropped + PERF_LEVELS, 0);
+    std::fill(level_busy_dropped, level_busy_dropped + PERF_LEVELS, 0);
+  }
+
+  /**
+   * @brief Add the counters of one run, PERF_WORDS words of the window
+   */
+  void add(const volatile u32 *words);
+
+  /**
+   * @brief Add another sum: counts add up, the FIFO high water is the
+   *        highest of both
+   */
+  void add(const OrbPerfCounters &other);
+};
+
+/**
+ * @brief Where the time of the last frame went, in microseconds
+ *
+ * detect() and detect_tiled() fill the accelerator stages, summed over
+ * tiles; decode_us and output_us are left to the caller, whose stages they
+ * are.
+ */
+struct OrbFrameMetrics {
+  double decode_us;    // Caller: decoding and conversion of the frame
+  double pack_us;      // Packing pixels into the BRAM or the DMA buffer
+  double upload_us;    // Waiting on the DMA
+  double wait_us;      // Waiting on the fabric: handshakes and drain
+  double readback_us;  // Copying, sorting and merging the keypoints
+  double output_us;    // Caller: consuming the keypoints
+  uint64_t upload_bytes;    // Pixel and handshake words written
+  uint64_t readback_bytes;  // Status, keypoint and descriptor words read
+  int keypoints;
+  int tiles;
+  bool has_counters;  // counters holds the window of the bitstream
+  OrbPerfCounters counters;
+
+  OrbFrameMetrics()
+      : decode_us(0),
+        pack_us(0),
+        upload_us(0),
+        wait_us(0),
+        readback_us(0),
+        output_us(0),
+        upload_bytes(0),
+        readback_bytes(0),
+        keypoints(0),
+        tiles(0),
+        has_counters(false) {}
+
+  /**
+   * @brief Add the metrics of another frame, e.g. into a run total
+   */
+  void add(const OrbFrameMetrics &other);
+};
+
+// ============================================================================
+// ACCELERATOR INTERFACE
+// ============================================================================
+
+class OrbAccelerator {
+ public:
+  explicit OrbAccelerator(const OrbAcceleratorConfig &config);
+  virtual ~OrbAccelerator() {}
+
+  /**
+   * @brief Map the memory windows
+   * @return 0 on success, -1 on error
+   */
+  virtual int open() = 0;
+
+  /**
+   * @brief Unmap the memory windows, safe to call more than once
+   */
+  virtual void close() = 0;
+
+  /**
+   * @brief Backend name, as accepted by orb_accelerator_create()
+   */
+  virtual const char *name() const = 0;
+
+  /**
+   * @brief Pulse the accelerator reset
+   * @return 0 on success, -1 if the device did not see it in timeout_ms
+   */
+  virtual int reset();
+
+  /**
+   * @brief Program the FAST thresholds
+   */
+  void set_thresholds(int32_t corner_thresh, int32_t corner_thresh_n);
+
+  /**
+   * @brief Zero the feature BRAMs so the pos == 0 end marker holds
+   *
+   * Only needed without feature_status, i.e. on bitstreams whose
+   * write_descriptors has no status output.
+   */
+  void clear_features();
+
+  /**
+   * @brief Run one grayscale frame through the accelerator
+   *
+   * The frame is uploaded in chunks of mem_size_pix pixels. With ping_pong
+   * the chunks alternate between the two halves of the pixel BRAM, and the
+   * next chunk is packed while the accelerator streams the previous one.
+   * Call reset() first, so host and accelerator both start at half 0; the
+   * reset also clears the keypoint count. Without feature_status the pos
+   * entries of the previous frame are cleared, so the end marker holds.
+   * Returns once the last descriptors are written: with perf_counters when
+   * the fabric cycle count shows no pixel or descriptor for as long as the
+   * pipeline takes, otherwise once the keypoint count has not moved for as
+   * long as the constructors take to empty a full feature FIFO.
+   *
+   * With a DMA window the CPU only packs words into the DDR input buffer,
+   * and the DMA moves them to the pixel BRAM in BURST_SIZE transfers while
+   * the next words are packed.
+   * @param pixels Frame of line_size x num_lines pixels
+   * @param stride Distance in bytes between consecutive lines
+   * @return 0 on success, -1 on error or timeout
+   */
+  virtual int process_frame(const uint8_t *pixels, int stride);
+
+  /**
+   * @brief Reset, process one frame and read its keypoints
+   *
+   * Per frame entry point of a session: the windows stay mapped and the
+   * thresholds programmed between frames.
+   * @return Number of keypoints, -1 on error or timeout
+   */
+  int detect(const uint8_t *pixels, int stride,
+             std::vector<OrbFeature> *features);
+  int detect(const uint8_t *pixels, int stride, KeypointBatch *batch);
+
+  /**
+   * @brief Detect the keypoints of a frame larger than the bitstream
+   *
+   * The frame is processed as overlapping tiles (see tiles()) and their
+   * keypoints are merged, in frame coordinates and by decreasing score.
+   * Each tile keeps its own best keypoints, up to cell_k per cell.
+   * @param width Frame width, at least line_size
+   * @param height Frame height, at least num_lines
+   * @return Number of keypoints, -1 on error, timeout or a frame smaller
+   *         than the bitstream
+   */
+  int detect_tiled(const uint8_t *pixels, int stride, int width, int height,
+                   KeypointBatch *batch);
+
+  /**
+   * @brief Tiles covering a frame, in raster order
+   *
+   * Tile origins are multiples of 2^(num_scales-1), so the downscaled grids
+   * of a tile and of the frame line up, except that the last tile of a row
+   * or column ends at the frame edge. Empty if the frame is smaller than
+   * the bitstream.
+   */
+  std::vector<OrbTile> tiles(int width, int height) const;
+
+  /**
+   * @brief Read the keypoints of the last frame
+   *
+   * write_descriptors keeps the best cell_k keypoints by FAST score in each
+   * cell of a grid_cols x grid_rows grid. They are returned by decreasing
+   * score, ties in BRAM order, so the list is bounded by the cells times
+   * cell_k and its head holds the strongest keypoints.
+   * @param features Output keypoints
+   * @return Number of keypoints read
+   */
+  int read_features(std::vector<OrbFeature> *features);
+
+  /**
+   * @brief Read the keypoints of the last frame into a batch
+   *
+   * The used part of each feature window is copied in one bulk pass, so the
+   * cost follows the number of keypoints; with a grid it is the whole
+   * grid_cols * grid_rows * cell_k entries. Same order as read_features().
+   * @return Number of keypoints read
+   */
+  int read_batch(KeypointBatch *batch);
+
+  /**
+   * @brief Load the reference set of the descriptor matcher
+   *
+   * The references stay loaded across resets and frames; each keypoint
+   * written from then on is matched against them in the fabric.
+   * @param descriptors count * DESCRIPTOR_BYTES bytes, KeypointBatch layout
+   * @param count References, at most match_refs
+   * @return Number of references loaded, -1 without the matcher
+   */
+  int load_references(const uint8_t *descriptors, int count);
+
+  /**
+   * @brief Read the matches of the keypoints of the last read
+   *
+   * Waits for the matcher to drain, then returns the match of each keypoint
+   * of the last read_features() or read_batch(), in the same order. Not
+   * available after detect_tiled(). Keypoints dropped because the matcher
+   * queue was full have no match; matches_dropped() counts them.
+   * @return Number of matches, -1 without the matcher or on timeout
+   */
+  int read_matches(std::vector<KeypointMatch> *matches);
+
+  /**
+   * @brief Keypoints of the last read_matches() the matcher had to drop
+   */
+  int matches_dropped() const { return matches_dropped_; }
+
+  const OrbAcceleratorConfig &config() const { return config_; }
+  const OrbRegions &regions() const { return regions_; }
+  const OrbDmaStats &dma_stats() const { return dma_stats_; }
+
+  /**
+   * @brief Stage times and fabric counters of the last detect() or
+   *        detect_tiled()
+   */
+  const OrbFrameMetrics &metrics() const { return metrics_; }
+
+  /**
+   * @brief Whether the last frame read had more keypoints than a cell keeps
+   *
+   * The weakest keypoints of the full cells were then dropped; with tiles,
+   * in any tile. Only known with feature_status, false otherwise.
+   */
+  bool overflowed() const { return overflowed_; }
+
+ protected:
+  /**
+   * @brief Start one transfer on the DMA window
+   */
+  virtual void dma_issue(dma_instr_t instr);
+
+  /**
+   * @brief Block until the device signals progress
+   * @param timeout_us Longest time to block
+   * @return 0 after blocking (signalled or not), -1 if the backend has no
+   *         completion event and the caller has to sleep instead
+   */
+  virtual int wait_event(int timeout_us);
+
+  /**
+   * @brief Wait until a device condition holds
+   *
+   * Polls spin_polls times, then sleeps with an exponential backoff until
+   * done() or timeout_ms. Only a pixel chunk handshake, which the chunk_done
+   * interrupt signals, blocks on wait_event() instead of sleeping.
+   * @param done Condition to wait for
+   * @param event Whether wait_event() signals the condition
+   * @return 0 once done() holds, -1 on timeout
+   */
+  int wait_until(const std::function<bool()> &done, bool event = false);
+
+  OrbAcceleratorConfig config_;
+  OrbRegions regions_;
+  OrbFrameMetrics metrics_;
+
+ private:
+  int run_frame(const uint8_t *pixels, int stride);
+  int detect_batch(const uint8_t *pixels, int stride, KeypointBatch *batch);
+  int dma_upload(int word, int beats);
+  int dma_finish();
+  int fetch_features();
+  int sort_features(int entries, bool sparse);
+
+  OrbDmaStats dma_stats_;
+  // Bulk copies of the feature windows, reused across frames
+  std::vector<u32> pos_, scr_angle_, descripts_[2];
+  std::vector<u32> sorted_;  // Scratch of sort_features()
+  std::vector<int> order_;
+  KeypointBatch tile_batch_;
+  bool overflowed_;
+  int matches_dropped_;
+  bool dma_busy_;
+  std::chrono::steady_clock::time_point dma_started_;
+};
+
+/**
+ * @brief Create a backend by name ("zynq", "shm" or "model")
+ * @return The backend, not yet opened, or null for an unknown name
+ */
+std::unique_ptr<OrbAccelerator> orb_accelerator_create(
+    const std::string &backend,
+    const OrbAcceleratorConfig &config = OrbAcceleratorConfig());
+
+// ============================================================================
+// BACKENDS
+// ============================================================================
+
+/**
+ * @brief Zybo accelerator, windows mapped from /dev/mem
+ *
+ * With uio_path set, waits block on the chunk_done interrupt of get_pix
+ * through the UIO device instead of sleeping.
+ */
+class ZynqAccelerator : public OrbAccelerator {
+ public:
+  explicit ZynqAccelerator(const OrbAcceleratorConfig &config);
+  ~ZynqAccelerator();
+
+  int open();
+  void close();
+  const char *name() const { return "zynq"; }
+
+ protected:
+  int wait_event(int timeout_us);
+
+ private:
+  void *map(off_t base_addr, off_t addr_high);
+
+  int fd_;
+  int uio_fd_;
+  std::vector<std::pair<void *, size_t> > mappings_;
+};
+
+/**
+ * @brief Stand-in for /dev/mem backed by a shared file
+ *
+ * The windows keep the sizes of the block design, at page aligned offsets of
+ * the file. Unless disabled, a device thread plays the FPGA side of the
+ * handshake: it consumes each pixel chunk, runs the software model once the
+ * frame is complete and fills the feature BRAMs. With the device thread
+ * disabled another process can serve the same file; it has to poll the
+ * reset window to notice reset(). Completions of the device thread are
+ * signalled on an eventfd, the way the chunk_done interrupt is on the board.
+ */
+class ShmAccelerator : public OrbAccelerator {
+ public:
+  ShmAccelerator(const OrbAcceleratorConfig &config, bool emulate_device);
+  ~ShmAccelerator();
+
+  int open();
+  void close();
+  const char *name() const { return "shm"; }
+  int reset();
+
+ protected:
+  void dma_issue(dma_instr_t instr);
+  int wait_event(int timeout_us);
+
+ private:
+  void device_loop();
+  void device_dma();
+
+  bool emulate_device_;
+  int fd_;
+  int event_fd_;  // Signalled by the device thread, stands in for the IRQ
+  uint8_t *base_;
+  size_t size_;
+  OrbModel model_;
+  std::thread device_;
+  std::atomic<bool> running_;
+  std::atomic<bool> reset_seen_;  // Device thread saw the reset low
+};
+
+/**
+ * @brief Software model, frames are processed without any upload
+ */
+class ModelAccelerator : public OrbAccelerator {
+ public:
+  explicit ModelAccelerator(const OrbAcceleratorConfig &config);
+
+  int open();
+  void close();
+  const char *name() const { return "model"; }
+  int process_frame(const uint8_t *pixels, int stride);
+
+ private:
+  OrbModel model_;
+  std::vector<u64> words_;  // Backing store of the GPIO windows
+  std::vector<u32> brams_;  // Backing store of the feature BRAMs
+  std::vector<u32> match_;  // Backing store of the matcher window
+  std::vector<u32> perf_;   // Backing store of the counters window
+};
+
+#endif  // ORB_ACCELERATOR_H
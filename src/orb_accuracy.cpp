@@ -0,0 +1,548 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file orb_accuracy.cpp
+ * @brief Accuracy of the accelerator against OpenCV's FAST and ORB
+ *
+ * Runs the accelerator, or its model, and OpenCV on the same frames and
+ * reports:
+ * - FAST position agreement: level 0 keypoints against
+ *   cv::FastFeatureDetector with the same threshold, as precision and
+ *   recall within ACCURACY_POSITION_RADIUS and the mean offset
+ * - Orientation error against cv::ORB at the same keypoints, in degrees,
+ *   and the share within half a sector of KeypointBatch::orientation,
+ *   90 / 2^theta_size degrees wide
+ * - Under synthetic rotations and scalings of each frame, for both the
+ *   accelerator and cv::ORB: keypoint repeatability, descriptor matching
+ *   precision and recall, and the error of the orientation change against
+ *   the applied rotation
+ *
+ * cv::ORB runs with the pyramid of the bitstream (num_scales levels of
+ * scale factor 2) and the FAST score, so both sides find the same kind of
+ * keypoints. Every speed change to the pyramid, sectors, top-N or tiling
+ * shows here as a change of these numbers; --min-repeatability and
+ * --min-precision turn them into a pass/fail gate.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <sstream>
+
+#include "hamming_matcher.h"
+#include "orb_accelerator.h"
+#include "tool_common.h"
+
+// ============================================================================
+// CONFIGURATION CONSTANTS
+// ============================================================================
+
+// Level 0 pixels around a frame in which neither side is scored, covering
+// the orientation window and Gaussian border of fast_brief_coordinator
+#define ACCURACY_BORDER 24
+
+// Largest offset of a FAST keypoint and an OpenCV one taken as the same
+#define ACCURACY_POSITION_RADIUS 1.0
+
+// Largest offset, in pixels of the keypoint's level, of a keypoint and the
+// transformed position of another taken as repeated
+#define ACCURACY_TOLERANCE 3.0
+
+// ============================================================================
+// FEATURES
+// ============================================================================
+
+/**
+ * @brief Keypoints of either detector, in level 0 pixels
+ */
+struct FeatureSet {
+  std::vector<cv::Point2f> points;
+  std::vector<int> levels;
+  std::vector<float> angles;         // Degrees
+  std::vector<uint8_t> descriptors;  // DESCRIPTOR_BYTES per keypoint
+
+  int size() const { return static_cast<int>(points.size()); }
+};
+
+static void from_batch(const KeypointBatch &batch, FeatureSet *set) {
+  set->points.resize(batch.count);
+  set->levels.resize(batch.count);
+  set->angles.resize(batch.count);
+  for (int i = 0; i < batch.count; i++) {
+    set->points[i] = cv::Point2f(batch.x[i], batch.y[i]);
+    set->levels[i] = batch.scale[i];
+    set->angles[i] = batch.orientation(i);
+  }
+  set->descriptors.assign(batch.descriptors.begin(),
+                          batch.descriptors.begin() +
+                              static_cast<size_t>(batch.count) *
+                                  DESCRIPTOR_BYTES);
+}
+
+static void from_opencv(const std::vector<cv::KeyPoint> &keypoints,
+                        const cv::Mat &descriptors, FeatureSet *set) {
+  size_t count = keypoints.size();
+  set->points.resize(count);
+  set->levels.resize(count);
+  set->angles.resize(count);
+  set->descriptors.resize(count * DESCRIPTOR_BYTES);
+  for (size_t i = 0; i < count; i++) {
+    set->points[i] = keypoints[i].pt;
+    set->levels[i] = keypoints[i].octave;
+    set->angles[i] = keypoints[i].angle;
+    memcpy(&set->descriptors[i * DESCRIPTOR_BYTES],
+           descriptors.ptr<uint8_t>(static_cast<int>(i)), DESCRIPTOR_BYTES);
+  }
+}
+
+/**
+ * @brief Whether a level 0 point is scored, away from the frame border by
+ *        ACCURACY_BORDER pixels of its level
+ */
+static bool inside(cv::Point2f point, int level, cv::Size size) {
+  float border = static_cast<float>(ACCURACY_BORDER << level);
+  return point.x >= border && point.y >= border &&
+         point.x < size.width - border && point.y < size.height - border;
+}
+
+/**
+ * @brief Nearest keypoint of a set to a point, -1 if the set is empty
+ * @param level Only keypoints of this level, -1 for any level
+ */
+static int nearest(const FeatureSet &set, cv::Point2f point, int level,
+                   double *distance) {
+  int best = -1;
+  double best_distance = 0;
+  for (int i = 0; i < set.size(); i++) {
+    if (level >= 0 && set.levels[i] != level) continue;
+    double dx = set.points[i].x - point.x;
+    double dy = set.points[i].y - point.y;
+    double d = sqrt(dx * dx + dy * dy);
+    if (best < 0 || d < best_distance) {
+      best = i;
+      best_distance = d;
+    }
+  }
+  *distance = best_distance;
+  return best;
+}
+
+/**
+ * @brief Absolute difference of two angles in degrees, 0 to 180
+ */
+static double angle_error(double a, double b) {
+  double d = fmod(fabs(a - b), 360.0);
+  return d > 180.0 ? 360.0 - d : d;
+}
+
+// ============================================================================
+// TALLIES
+// ============================================================================
+
+/**
+ * @brief Counts of one test summed over the frames, and its results
+ */
+struct Tally {
+  std::string detector;
+  std::string test;
+  long samples;        // Keypoints scored
+  long found;          // Of them, with a counterpart
+  long pairs;          // Descriptor matches, or reference keypoints
+  long correct;        // Of them, correct or found
+  double offset_sum;   // Position offset of the counterparts, pixels
+  long angle_pairs;
+  double angle_sum;    // Orientation error, degrees
+  long within_sector;  // Orientation errors within half a sector
+
+  Tally(const std::string &d, const std::string &t)
+      : detector(d),
+        test(t),
+        samples(0),
+        found(0),
+        pairs(0),
+        correct(0),
+        offset_sum(0),
+        angle_pairs(0),
+        angle_sum(0),
+        within_sector(0) {}
+};
+
+/**
+ * @brief Level 0 accelerator keypoints against cv::FastFeatureDetector
+ *
+ * samples/found give the precision, pairs/correct the recall.
+ */
+static void score_position(const FeatureSet &accel,
+                           const std::vector<cv::KeyPoint> &fast,
+                           cv::Size size, Tally *tally) {
+  FeatureSet reference;
+  for (size_t i = 0; i < fast.size(); i++) {
+    if (!inside(fast[i].pt, 0, size)) continue;
+    reference.points.push_back(fast[i].pt);
+    reference.levels.push_back(0);
+  }
+
+  double distance;
+  for (int i = 0; i < accel.size(); i++) {
+    if (accel.levels[i] != 0 || !inside(accel.points[i], 0, size)) continue;
+    tally->samples++;
+    if (nearest(reference, accel.points[i], 0, &distance) >= 0 &&
+        distance <= ACCURACY_POSITION_RADIUS) {
+      tally->found++;
+      tally->offset_sum += distance;
+    }
+  }
+  for (int i = 0; i < reference.size(); i++) {
+    tally->pairs++;
+    if (nearest(accel, reference.points[i], 0, &distance) >= 0 &&
+        distance <= ACCURACY_POSITION_RADIUS) {
+      tally->correct++;
+    }
+  }
+}
+
+/**
+ * @brief Accelerator orientations against cv::ORB at the same keypoints
+ */
+static void score_orientation(const FeatureSet &accel, const FeatureSet &orb,
+                              cv::Size size, double sector, Tally *tally) {
+  double distance;
+  for (int i = 0; i < accel.size(); i++) {
+    int level = accel.levels[i];
+    if (!inside(accel.points[i], level, size)) continue;
+    tally->samples++;
+    int j = nearest(orb, accel.points[i], level, &distance);
+    if (j < 0 || distance > ACCURACY_POSITION_RADIUS * (1 << level)) continue;
+    tally->found++;
+    double error = angle_error(accel.angles[i], orb.angles[j]);
+    tally->angle_pairs++;
+    tally->angle_sum += error;
+    if (error <= sector / 2) tally->within_sector++;
+  }
+}
+
+/**
+ * @brief A frame against its transformed copy
+ *
+ * A keypoint of the frame whose transformed position is scored in the copy
+ * is a sample; it is repeated (found) if the copy has a keypoint of its
+ * level within ACCURACY_TOLERANCE. Descriptor matches (pairs) are correct
+ * when they pair such positions. The orientation of a repeated keypoint
+ * must change by minus the rotation: image angles grow clockwise, the
+ * rotation of getRotationMatrix2D counter-clockwise.
+ */
+static void score_transform(const FeatureSet &frame, const FeatureSet &copy,
+                            const cv::Mat &transform, double rotation,
+                            cv::Size size, HammingMatcher *matcher,
+                            Tally *tally) {
+  std::vector<cv::Point2f> moved;
+  cv::transform(frame.points, moved, transform);
+
+  double distance;
+  for (int i = 0; i < frame.size(); i++) {
+    int level = frame.levels[i];
+    if (!inside(frame.points[i], level, size) ||
+        !inside(moved[i], level, size)) {
+      continue;
+    }
+    tally->samples++;
+    int j = nearest(copy, moved[i], level, &distance);
+    if (j < 0 || distance > ACCURACY_TOLERANCE * (1 << level)) continue;
+    tally->found++;
+    tally->offset_sum += distance;
+    tally->angle_pairs++;
+    tally->angle_sum +=
+        angle_error(copy.angles[j] - frame.angles[i], -rotation);
+  }
+
+  std::vector<DescriptorPair> pairs;
+  matcher->match(frame.descriptors.data(), frame.size(),
+                 copy.descriptors.data(), copy.size(), &pairs);
+  for (size_t p = 0; p < pairs.size(); p++) {
+    int i = pairs[p].query;
+    int level = frame.levels[i];
+    if (!inside(frame.points[i], level, size) ||
+        !inside(moved[i], level, size)) {
+      continue;
+    }
+    tally->pairs++;
+    cv::Point2f offset = copy.points[pairs[p].train] - moved[i];
+    if (sqrt(offset.dot(offset)) <= ACCURACY_TOLERANCE * (1 << level)) {
+      tally->correct++;
+    }
+  }
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+static double ratio(long a, long b) {
+  return b > 0 ? static_cast<double>(a) / b : NAN;
+}
+
+/**
+ * @brief Results of a tally: repeatability, precision, recall, offset and
+ *        orientation error; NAN where they do not apply
+ */
+struct Scores {
+  double repeatability;
+  double precision;
+  double recall;
+  double offset;
+  double angle;
+  double within_sector;
+};
+
+static Scores scores(const Tally &t) {
+  Scores s;
+  s.repeatability = s.precision = s.recall = s.offset = s.within_sector = NAN;
+  s.angle = t.angle_pairs > 0 ? t.angle_sum / t.angle_pairs : NAN;
+  if (t.test == "fast_position") {
+    s.precision = ratio(t.found, t.samples);
+    s.recall = ratio(t.correct, t.pairs);
+    s.offset = t.found > 0 ? t.offset_sum / t.found : NAN;
+  } else if (t.test == "orb_orientation") {
+    s.recall = ratio(t.found, t.samples);
+    s.within_sector = ratio(t.within_sector, t.angle_pairs);
+  } else {
+    s.repeatability = ratio(t.found, t.samples);
+    s.precision = ratio(t.correct, t.pairs);
+    s.recall = ratio(t.correct, t.found);
+    s.offset = t.found > 0 ? t.offset_sum / t.found : NAN;
+  }
+  return s;
+}
+
+static void write_tally(RecordWriter *out, const Tally &t) {
+  Scores s = scores(t);
+  out->text("detector", t.detector);
+  out->text("test", t.test);
+  out->integer("samples", t.samples);
+  out->number("repeatability", s.repeatability, 4);
+  out->number("precision", s.precision, 4);
+  out->number("recall", s.recall, 4);
+  out->number("offset_px", s.offset, 4);
+  out->number("angle_error_deg", s.angle, 4);
+  out->number("within_sector", s.within_sector, 4);
+  out->end_record();
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+/**
+ * @brief Score the accelerator and OpenCV over the frames
+ * @return 0 on success, 1 on error or if a gate failed
+ */
+int main(int argc, char const *argv[]) {
+  std::string backend = "model";
+  std::string config_path;
+  std::string out_path;
+  std::string rotations = "10,30,45,90";
+  std::string scalings = "0.8,1.25";
+  int threshold = 20;
+  double min_repeatability = 0;
+  double min_precision = 0;
+
+  int arg = 1;
+  while (argc > arg + 1 && std::string(argv[arg]).compare(0, 2, "--") == 0) {
+    std::string option = argv[arg];
+    std::string value = argv[arg + 1];
+    if (option == "--backend") {
+      backend = value;
+    } else if (option == "--config") {
+      config_path = value;
+    } else if (option == "--out") {
+      out_path = value;
+    } else if (option == "--threshold") {
+      threshold = static_cast<int>(strtol(value.c_str(), nullptr, 10));
+    } else if (option == "--rotations") {
+      rotations = value;
+    } else if (option == "--scalings") {
+      scalings = value;
+    } else if (option == "--min-repeatability") {
+      min_repeatability = strtod(value.c_str(), nullptr);
+    } else if (option == "--min-precision") {
+      min_precision = strtod(value.c_str(), nullptr);
+    } else {
+      break;
+    }
+    arg += 2;
+  }
+
+  if (argc < arg + 1 || std::string(argv[arg]).compare(0, 2, "--") == 0) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--backend zynq|shm|model] [--config file] "
+                 "[--threshold t] [--rotations deg,...] [--scalings s,...] "
+                 "[--out file] [--min-repeatability r] [--min-precision p] "
+                 "<image|directory|glob>..."
+              << std::endl;
+    std::cerr << "  --backend: Accelerator backend (default: model)"
+              << std::endl;
+    std::cerr << "  --threshold: FAST threshold of both sides (default: 20)"
+              << std::endl;
+    std::cerr << "  --rotations, --scalings: Synthetic transforms of each "
+                 "frame (default: 10,30,45,90 degrees and 0.8,1.25)"
+              << std::endl;
+    std::cerr << RESULTS_OUT_USAGE << std::endl;
+    std::cerr << "  --min-repeatability, --min-precision: Fail if the "
+                 "accelerator falls below these under any transform"
+              << std::endl;
+    return 1;
+  }
+
+  OrbAcceleratorConfig config;
+  if (load_bitstream_config(&config_path, &config) != 0) return 1;
+  config.match_refs = 0;
+
+  std::unique_ptr<OrbAccelerator> accelerator =
+      orb_accelerator_create(backend, config);
+  if (!accelerator) {
+    std::cerr << "Unknown backend: " << backend << std::endl;
+    return 1;
+  }
+  if (accelerator->open() != 0) {
+    std::cerr << "Could not open the " << backend << " backend" << std::endl;
+    return 1;
+  }
+  accelerator->set_thresholds(threshold, -threshold);
+
+  cv::Size size(config.line_size, config.num_lines);
+  cv::Point2f centre(size.width / 2.0f, size.height / 2.0f);
+  double sector = 90.0 / (1 << config.theta_size);
+  cv::Ptr<cv::FastFeatureDetector> fast =
+      cv::FastFeatureDetector::create(threshold, true);
+  cv::Ptr<cv::ORB> orb = cv::ORB::create(
+      config.feature_lines, 2.0f, config.num_scales, ACCURACY_BORDER, 0, 2,
+      cv::ORB::FAST_SCORE, 31, threshold);
+  HammingMatcher matcher;
+
+  // Transforms: rotations about the centre, then scalings
+  std::vector<cv::Mat> transforms;
+  std::vector<double> angles;
+  std::vector<Tally> tallies;
+  tallies.push_back(Tally("accelerator", "fast_position"));
+  tallies.push_back(Tally("accelerator", "orb_orientation"));
+  std::vector<std::string> rotation_list = split_list(rotations);
+  std::vector<std::string> scaling_list = split_list(scalings);
+  for (size_t i = 0; i < rotation_list.size() + scaling_list.size(); i++) {
+    bool rotation = i < rotation_list.size();
+    const std::string &value =
+        rotation ? rotation_list[i] : scaling_list[i - rotation_list.size()];
+    double angle = rotation ? strtod(value.c_str(), nullptr) : 0;
+    double scale = rotation ? 1 : strtod(value.c_str(), nullptr);
+    std::ostringstream name;
+    name << (rotation ? "rotate_" : "scale_") << (rotation ? angle : scale);
+    transforms.push_back(cv::getRotationMatrix2D(centre, angle, scale));
+    angles.push_back(angle);
+    tallies.push_back(Tally("accelerator", name.str()));
+    tallies.push_back(Tally("opencv_orb", name.str()));
+  }
+
+  // ========================================================================
+  // FRAMES
+  // ========================================================================
+
+  int frames = 0;
+  struct stat info;
+  for (; arg < argc; arg++) {
+    std::vector<cv::String> paths;
+    std::string input = argv[arg];
+    if (stat(input.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+      cv::glob(input + "/*", paths);
+    } else {
+      cv::glob(input, paths);
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for (size_t p = 0; p < paths.size(); p++) {
+      cv::Mat gray = cv::imread(paths[p], cv::IMREAD_GRAYSCALE);
+      if (gray.empty()) continue;
+      if (gray.size() != size) cv::resize(gray, gray, size);
+
+      KeypointBatch batch;
+      FeatureSet accel;
+      FeatureSet reference;
+      std::vector<cv::KeyPoint> keypoints;
+      cv::Mat descriptors;
+      if (accelerator->detect(gray.ptr<uint8_t>(0),
+                              static_cast<int>(gray.step), &batch) < 0) {
+        std::cerr << "Accelerator failed on: " << paths[p] << std::endl;
+        return 1;
+      }
+      from_batch(batch, &accel);
+      fast->detect(gray, keypoints);
+      score_position(accel, keypoints, size, &tallies[0]);
+      orb->detectAndCompute(gray, cv::noArray(), keypoints, descriptors);
+      from_opencv(keypoints, descriptors, &reference);
+      score_orientation(accel, reference, size, sector, &tallies[1]);
+
+      for (size_t t = 0; t < transforms.size(); t++) {
+        cv::Mat copy;
+        cv::warpAffine(gray, copy, transforms[t], size);
+        FeatureSet accel_copy;
+        FeatureSet reference_copy;
+        if (accelerator->detect(copy.ptr<uint8_t>(0),
+                                static_cast<int>(copy.step), &batch) < 0) {
+          std::cerr << "Accelerator failed on: " << paths[p] << std::endl;
+          return 1;
+        }
+        from_batch(batch, &accel_copy);
+        orb->detectAndCompute(copy, cv::noArray(), keypoints, descriptors);
+        from_opencv(keypoints, descriptors, &reference_copy);
+        score_transform(accel, accel_copy, transforms[t], angles[t], size,
+                        &matcher, &tallies[2 + 2 * t]);
+        score_transform(reference, reference_copy, transforms[t], angles[t],
+                        size, &matcher, &tallies[3 + 2 * t]);
+      }
+      frames++;
+    }
+  }
+  accelerator->close();
+  if (frames == 0) {
+    std::cerr << "No frames to score" << std::endl;
+    return 1;
+  }
+
+  // ========================================================================
+  // RESULTS
+  // ========================================================================
+
+  int result = 0;
+  printf("%d frames, %dx%d, threshold %d, %.2f degree sectors\n", frames,
+         size.width, size.height, threshold, sector);
+  printf("%-12s %-16s %8s %7s %7s %7s %7s %7s %7s\n", "detector", "test",
+         "samples", "repeat", "prec", "recall", "off px", "ang deg",
+         "in sect");
+  for (size_t i = 0; i < tallies.size(); i++) {
+    const Tally &t = tallies[i];
+    Scores s = scores(t);
+    printf("%-12s %-16s %8ld %7.3f %7.3f %7.3f %7.2f %7.2f %7.3f\n",
+           t.detector.c_str(), t.test.c_str(), t.samples, s.repeatability,
+           s.precision, s.recall, s.offset, s.angle, s.within_sector);
+    if (i < 2 || t.detector != "accelerator") continue;
+    if ((min_repeatability > 0 && !(s.repeatability >= min_repeatability)) ||
+        (min_precision > 0 && !(s.precision >= min_precision))) {
+      std::cerr << "Gate failed on " << t.test << std::endl;
+      result = 1;
+    }
+  }
+
+  if (!out_path.empty()) {
+    RecordWriter out;
+    if (out.open(out_path) != 0) return 1;
+    for (size_t i = 0; i < tallies.size(); i++) {
+      write_tally(&out, tallies[i]);
+    }
+    if (out.close() != 0) return 1;
+  }
+  return result;
+}
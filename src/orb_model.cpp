@@ -0,0 +1,690 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file orb_model.cpp
+ * @brief Bit-exact software model of the ORB accelerator
+ */
+
+#include "orb_model.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <deque>
+
+#include "brief_pattern.h"
+
+// ============================================================================
+// RTL CONSTANTS
+// ============================================================================
+
+// FAST window (fast_detector.vhd)
+#define FAST_WINDOW_MIDDLE 3  // 7x7 window, Bresenham circle of radius 3
+#define FAST_CIRCLE_SIZE 16   // Pixels on the circle
+#define FAST_MIN_ARC 9        // Contiguous pixels needed for a corner
+#define NMS_BORDER 4          // FAST border plus the NMS 3x3 window
+
+// Orientation and patch windows (orientation_module*.vhd)
+#define GAUSSIAN_MIDDLE 3      // 7x7 binomial kernel, sum 4096
+#define ORIENTATION_MIDDLE 18  // 37x37 intensity centroid window
+#define TAN_FRACTION_BITS 5    // Spiral multipliers work on x/32 constants
+#define PATCH_ROW_OFFSET 15    // Patch row 15 is the window centre
+#define PATCH_COL_OFFSET 16    // Column written 13 cycles after the window
+
+// BRIEF pattern (BRIEF_pattern_generator.py)
+#define PATTERN_RADIUS 15.0  // Test points are clamped to this radius
+#define PATTERN_CENTRE 15.5  // Offset applied before rounding to the patch
+
+// write_descriptors.vhd and descriptor_match.vhd
+#define DESCRIPTOR_WRITE_CYCLES 5  // Clocks between two we_descriptor pulses
+#define MATCH_EXTRA_CYCLES 5       // Pipeline and table write of a keypoint
+#define MATCH_EMPTY_CYCLES 2       // Keypoint matched against no reference
+
+// constructor_supervisor.vhd and orb.vhd
+#define DESCRIPTOR_READY_CYCLES 98  // start_constr to feature_ready
+
+// Bresenham circle as (row, column) inside the 7x7 window, clockwise from
+// the top, in the order used by fast_detector.vhd
+static const int fast_circle[FAST_CIRCLE_SIZE][2] = {
+    {0, 2}, {0, 3}, {0, 4}, {1, 5}, {2, 6}, {3, 6}, {4, 6}, {5, 5},
+    {6, 4}, {6, 3}, {6, 2}, {5, 1}, {4, 0}, {3, 0}, {2, 0}, {1, 1}};
+
+// Binomial coefficients of the 7x7 Gaussian
+static const int gaussian_kernel[2 * GAUSSIAN_MIDDLE + 1] = {1,  6, 15, 20,
+                                                              15, 6, 1};
+
+// tan() thresholds of each sector, scaled by 32 (tan_multiplier_*.v and the
+// shift-and-add trees of the 4 and 8 sector modules)
+static const uint32_t tan_4_sec[4] = {6, 21, 47, 160};
+static const uint32_t tan_8_sec[8] = {5, 11, 18, 26, 38, 55, 87, 181};
+static const uint32_t tan_16_sec[16] = {2,  5,  9,  12, 15, 19,  24,  29,
+                                        35, 42, 51, 64, 82, 112, 171, 345};
+static const uint32_t tan_32_sec[32] = {
+    1,  3,  4,  6,  7,  9,  11, 12,  14,  16,  18,  20,  22,  25,  27,  30,
+    33, 36, 40, 44, 49, 55, 62, 70, 79, 92, 108, 131, 166, 222, 335, 671};
+
+// ============================================================================
+// PIPELINE STAGES
+// ============================================================================
+
+/**
+ * @brief Sign extend a threshold register to the 9-bit comparator width
+ */
+static int32_t threshold_9b(int32_t value) {
+  int32_t masked = value & 0x1FF;
+  return (masked & 0x100) ? masked - 0x200 : masked;
+}
+
+/**
+ * @brief 2x2 box average of scalar.vhd
+ * @return Image with half the width and height
+ */
+static std::vector<uint8_t> downscale(const std::vector<uint8_t> &image,
+                                      int width, int height) {
+  int out_width = width / 2;
+  int out_height = height / 2;
+  std::vector<uint8_t> out(static_cast<size_t>(out_width) * out_height);
+
+  for (int y = 0; y < out_height; y++) {
+    const uint8_t *row_0 = &image[static_cast<size_t>(2 * y) * width];
+    const uint8_t *row_1 = row_0 + width;
+    for (int x = 0; x < out_width; x++) {
+      int sum = row_0[2 * x] + row_0[2 * x + 1] + row_1[2 * x] +
+                row_1[2 * x + 1];
+      out[static_cast<size_t>(y) * out_width + x] =
+          static_cast<uint8_t>(sum >> 2);
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief FAST segment test and score of fast_detector.vhd
+ *
+ * Scores are zero for pixels that are not corners and for the 3 pixel
+ * border the detector never evaluates.
+ */
+static std::vector<uint16_t> fast_scores(const std::vector<uint8_t> &image,
+                                         int width, int height, int32_t thr,
+                                         int32_t thr_n) {
+  std::vector<uint16_t> scores(image.size(), 0);
+
+  for (int y = FAST_WINDOW_MIDDLE; y < height - FAST_WINDOW_MIDDLE; y++) {
+    for (int x = FAST_WINDOW_MIDDLE; x < width - FAST_WINDOW_MIDDLE; x++) {
+      int centre = image[static_cast<size_t>(y) * width + x];
+      uint32_t darker = 0;
+      uint32_t brighter = 0;
+      int score = 0;
+
+      for (int i = 0; i < FAST_CIRCLE_SIZE; i++) {
+        int py = y + fast_circle[i][0] - FAST_WINDOW_MIDDLE;
+        int px = x + fast_circle[i][1] - FAST_WINDOW_MIDDLE;
+        int diff = centre - image[static_cast<size_t>(py) * width + px];
+        if (diff > thr) darker |= 1u << i;
+        if (diff < thr_n) brighter |= 1u << i;
+        score += abs(diff);
+      }
+
+      // Look for an arc of FAST_MIN_ARC pixels on the circular bit vector
+      uint32_t darker_arc = darker | (darker << FAST_CIRCLE_SIZE);
+      uint32_t brighter_arc = brighter | (brighter << FAST_CIRCLE_SIZE);
+      for (int i = 1; i < FAST_MIN_ARC; i++) {
+        darker_arc &= darker_arc >> 1;
+        brighter_arc &= brighter_arc >> 1;
+      }
+
+      if (darker_arc != 0 || brighter_arc != 0) {
+        scores[static_cast<size_t>(y) * width + x] =
+            static_cast<uint16_t>(score & 0xFFF);
+      }
+    }
+  }
+  return scores;
+}
+
+/**
+ * @brief 7x7 Gaussian of the orientation module, truncated to 8 bits
+ *
+ * Only pixels with a complete window are valid, the rest stay at zero.
+ */
+static std::vector<uint8_t> gaussian_blur(const std::vector<uint8_t> &image,
+                                          int width, int height) {
+  std::vector<uint8_t> out(image.size(), 0);
+
+  for (int y = GAUSSIAN_MIDDLE; y < height - GAUSSIAN_MIDDLE; y++) {
+    for (int x = GAUSSIAN_MIDDLE; x < width - GAUSSIAN_MIDDLE; x++) {
+      uint32_t sum = 0;
+      for (int i = 0; i < 2 * GAUSSIAN_MIDDLE + 1; i++) {
+        const uint8_t *row =
+            &image[static_cast<size_t>(y + i - GAUSSIAN_MIDDLE) * width];
+        uint32_t line = 0;
+        for (int j = 0; j < 2 * GAUSSIAN_MIDDLE + 1; j++) {
+          line += gaussian_kernel[j] * row[x + j - GAUSSIAN_MIDDLE];
+        }
+        sum += gaussian_kernel[i] * line;
+      }
+      out[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(sum >> 12);
+    }
+  }
+  return out;
+}
+
+// ============================================================================
+// FEATURE SELECTION
+// ============================================================================
+
+/**
+ * @brief Tournament trees of feature_select.vhd, one per cell
+ *
+ * Node 1 of a cell is the root and nodes k to 2k - 1 its leaves, one per
+ * entry. Leaves hold the key of their entry ('1' & score, 0 while empty),
+ * other nodes the smaller key of their children and the entry it came from.
+ */
+class CellTrees {
+ public:
+  CellTrees(int cells, int k)
+      : k_(k), keys_(static_cast<size_t>(cells) * 2 * k, 0),
+        slots_(keys_.size(), 0) {
+    for (size_t i = 0; i < slots_.size(); i++) {
+      int node = static_cast<int>(i % (2 * k));
+      if (node == 0) continue;
+      while (node < k) node *= 2;
+      slots_[i] = node - k;
+    }
+  }
+
+  /**
+   * @brief Offer a keypoint to a cell
+   * @param was_empty Set when the keypoint took an empty entry
+   * @return BRAM entry taken by the keypoint, -1 if it is dropped
+   */
+  int insert(int cell, uint32_t key, bool *was_empty) {
+    size_t base = static_cast<size_t>(cell) * 2 * k_;
+    if (key <= keys_[base + 1]) return -1;
+
+    int slot = slots_[base + 1];
+    *was_empty = keys_[base + 1] == 0;
+    int node = k_ + slot;
+    keys_[base + node] = key;
+    int min_slot = slot;
+    while (node > 1) {
+      // Left child wins ties
+      int sibling = node ^ 1;
+      bool take_sibling = (node & 1) ? keys_[base + sibling] <= key
+                                     : keys_[base + sibling] < key;
+      if (take_sibling) {
+        key = keys_[base + sibling];
+        min_slot = slots_[base + sibling];
+      }
+      node /= 2;
+      keys_[base + node] = key;
+      slots_[base + node] = min_slot;
+    }
+    return cell * k_ + slot;
+  }
+
+ private:
+  int k_;
+  std::vector<uint32_t> keys_;
+  std::vector<int> slots_;
+};
+
+// ============================================================================
+// MODEL
+// ============================================================================
+
+OrbModel::OrbModel(const OrbModelConfig &config)
+    : config_(config),
+      sectors_(1 << config.theta_size),
+      status_(0),
+      match_status_(0) {
+  std::fill(counters_, counters_ + PERF_WORDS, 0);
+  switch (config_.theta_size) {
+    case 2:
+      tan_constants_.assign(tan_4_sec, tan_4_sec + 4);
+      break;
+    case 3:
+      tan_constants_.assign(tan_8_sec, tan_8_sec + 8);
+      break;
+    case 4:
+      tan_constants_.assign(tan_16_sec, tan_16_sec + 16);
+      break;
+    default:
+      config_.theta_size = 5;
+      sectors_ = 32;
+      tan_constants_.assign(tan_32_sec, tan_32_sec + 32);
+      break;
+  }
+  if (config_.num_scales < 1) config_.num_scales = 1;
+  if (config_.num_scales > MAX_SCALES) config_.num_scales = MAX_SCALES;
+  // feature_select.vhd asserts a power of two that fits the BRAMs
+  config_.grid_cols = std::max(config_.grid_cols, 1);
+  config_.grid_rows = std::max(config_.grid_rows, 1);
+  int cells = config_.grid_cols * config_.grid_rows;
+  int cell_limit = std::min(config_.cell_k, config_.feature_lines / cells);
+  int cell_k = 1;
+  while (cell_k * 2 <= cell_limit) cell_k *= 2;
+  config_.cell_k = cell_k;
+  config_.match_refs = std::min(std::max(config_.match_refs, 0),
+                                MATCH_MAX_REFS);
+  config_.match_queue = std::max(config_.match_queue, 1);
+  build_patterns();
+}
+
+/**
+ * @brief Rotate the BRIEF pattern to every sector, as the ROM generator does
+ *
+ * Sector q * 2^THETA_SIZE + theta is rotated by the centre angle of theta,
+ * mirrored into quadrant q. Rounding is half to even, like np.round.
+ */
+void OrbModel::build_patterns() {
+  double step = 90.0 / sectors_;
+  patterns_.assign(static_cast<size_t>(4 * sectors_) * BRIEF_PATTERN_SIZE * 4,
+                   0);
+
+  for (int quad = 0; quad < 4; quad++) {
+    for (int section = 0; section < sectors_; section++) {
+      double angle = step / 2 + step * section;
+      double offset = (quad == 0) ? 0 : (quad == 3) ? 360 : 180;
+      double conv_angle = offset + angle * ((quad & 1) ? -1 : 1);
+      double rad = conv_angle * (M_PI / 180.0);
+      double cos_a = cos(rad);
+      double sin_a = sin(rad);
+
+      uint8_t *table = &patterns_[static_cast<size_t>(quad * sectors_ +
+                                                      section) *
+                                  BRIEF_PATTERN_SIZE * 4];
+      for (int k = 0; k < BRIEF_PATTERN_SIZE; k++) {
+        for (int p = 0; p < 2; p++) {
+          double x = brief_pattern[k][p][0];
+          double y = brief_pattern[k][p][1];
+          double distance = sqrt(x * x + y * y);
+          if (distance > PATTERN_RADIUS) {
+            double scaling = PATTERN_RADIUS / distance;
+            x *= scaling;
+            y *= scaling;
+          }
+          double x_rot = x * cos_a - y * sin_a;
+          double y_rot = x * sin_a + y * cos_a;
+          table[k * 4 + p * 2] =
+              static_cast<uint8_t>(nearbyint(x_rot + PATTERN_CENTRE));
+          table[k * 4 + p * 2 + 1] =
+              static_cast<uint8_t>(nearbyint(y_rot + PATTERN_CENTRE));
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Scale 0 pixel clock at which pixel (y, x) of a scale is produced
+ */
+int64_t OrbModel::pixel_clock(int scale, int y, int x) const {
+  int64_t last = (1 << scale) - 1;
+  return ((static_cast<int64_t>(y) << scale) + last) * config_.line_size +
+         (static_cast<int64_t>(x) << scale) + last;
+}
+
+void OrbModel::run_scale(const std::vector<uint8_t> &image, int width,
+                         int height, int scale, int32_t thr, int32_t thr_n,
+                         std::vector<Keypoint> *keypoints,
+                         uint32_t *counters) const {
+  std::vector<uint16_t> scores = fast_scores(image, width, height, thr, thr_n);
+  for (size_t i = 0; i < scores.size(); i++) {
+    if (scores[i] != 0) counters[PERF_CANDIDATES]++;
+  }
+
+  // Non-maximum suppression, candidates come out in raster order
+  std::vector<Candidate> candidates;
+  for (int y = NMS_BORDER; y < height - NMS_BORDER; y++) {
+    for (int x = NMS_BORDER; x < width - NMS_BORDER; x++) {
+      const uint16_t *centre = &scores[static_cast<size_t>(y) * width + x];
+      uint16_t score = *centre;
+      if (score == 0) continue;
+      if (score > centre[-width - 1] && score > centre[-width] &&
+          score > centre[-width + 1] && score > centre[-1] &&
+          score > centre[1] && score > centre[width - 1] &&
+          score > centre[width] && score > centre[width + 1]) {
+        Candidate candidate = {y, x, score};
+        candidates.push_back(candidate);
+      }
+    }
+  }
+  counters[PERF_SURVIVORS] += static_cast<uint32_t>(candidates.size());
+
+  // Coordinator window: the 37x37 orientation window and the Gaussian border
+  // must fit (fast_brief_coordinator.vhd)
+  int min_x = ORIENTATION_MIDDLE + GAUSSIAN_MIDDLE;
+  int max_x = width - ORIENTATION_MIDDLE - GAUSSIAN_MIDDLE - 1;
+  int min_y = ORIENTATION_MIDDLE + GAUSSIAN_MIDDLE;
+  int max_y = height - ORIENTATION_MIDDLE - GAUSSIAN_MIDDLE - 3;
+
+  std::vector<uint8_t> blurred = gaussian_blur(image, width, height);
+  std::deque<int64_t> fifo;  // Pop time of every queued feature
+  int64_t pop_time = 0;
+  // Clock at which each constructor of the level is available again
+  std::vector<int64_t> constructor_free(config_.constructors, 0);
+  uint32_t &high_water = counters[PERF_FIFO_HIGH_WATER + scale];
+  int last_y = -1;
+  int last_x = -1;
+
+  for (size_t c = 0; c < candidates.size(); c++) {
+    const Candidate &cand = candidates[c];
+
+    // is_feature is held for two cycles and the FIFO pushes on its rising
+    // edge, so a maximum two pixels after another one merges with it
+    bool merged = (cand.y == last_y && cand.x - last_x == 2);
+    last_y = cand.y;
+    last_x = cand.x;
+    if (merged) continue;
+
+    int64_t push_time = pixel_clock(scale, cand.y + 1 + FAST_WINDOW_MIDDLE,
+                                    cand.x + 1 + FAST_WINDOW_MIDDLE);
+    while (!fifo.empty() && fifo.front() <= push_time) fifo.pop_front();
+    if (static_cast<int>(fifo.size()) >= config_.fifo_size - 1) {
+      counters[PERF_FIFO_DROPPED]++;
+      counters[PERF_LEVEL_FIFO_DROPPED + scale]++;
+      continue;
+    }
+
+    bool inside = cand.x >= min_x && cand.x <= max_x && cand.y >= min_y &&
+                  cand.y <= max_y;
+    if (!inside) {
+      // Popped as soon as it reaches the head of the FIFO
+      pop_time = std::max(pop_time, push_time);
+    } else {
+      // Popped when the orientation window is centred on it
+      pop_time =
+          pixel_clock(scale, cand.y + ORIENTATION_MIDDLE + GAUSSIAN_MIDDLE,
+                      cand.x + ORIENTATION_MIDDLE + GAUSSIAN_MIDDLE);
+    }
+    fifo.push_back(pop_time);
+    high_water = std::max(high_water, static_cast<uint32_t>(fifo.size()));
+    // Pops are in order and nothing is pushed while full, so the FIFO stays
+    // full until its head pops
+    if (static_cast<int>(fifo.size()) >= config_.fifo_size - 1) {
+      counters[PERF_FIFO_FULL] +=
+          static_cast<uint32_t>(fifo.front() - push_time);
+    }
+    if (!inside) continue;
+    // An available constructor takes it; with equal latencies which one
+    // does not matter to the ones that follow
+    std::vector<int64_t>::iterator constructor =
+        std::find_if(constructor_free.begin(), constructor_free.end(),
+                     [pop_time](int64_t free) { return free <= pop_time; });
+    if (constructor == constructor_free.end()) {
+      counters[PERF_BUSY_DROPPED]++;
+      counters[PERF_LEVEL_BUSY_DROPPED + scale]++;
+      continue;
+    }
+    *constructor = pop_time + config_.constructor_busy;
+    // The level is busy until its first constructor is free again; it was
+    // not before this start, so the intervals do not overlap
+    int64_t all_busy =
+        *std::min_element(constructor_free.begin(), constructor_free.end());
+    if (all_busy > pop_time) {
+      counters[PERF_CONSTRUCTOR_BUSY] +=
+          static_cast<uint32_t>(all_busy - pop_time);
+    }
+
+    // Intensity centroid: x grows to the right, y grows upwards
+    int32_t m10 = 0;
+    int32_t m01 = 0;
+    for (int i = -ORIENTATION_MIDDLE; i <= ORIENTATION_MIDDLE; i++) {
+      const uint8_t *row =
+          &blurred[static_cast<size_t>(cand.y + i) * width + cand.x];
+      int32_t line_sum = 0;
+      for (int j = -ORIENTATION_MIDDLE; j <= ORIENTATION_MIDDLE; j++) {
+        line_sum += row[j];
+        m10 -= j * row[j];
+      }
+      m01 -= i * line_sum;
+    }
+
+    // Quadrant encoding of the orientation module: "00"->2, "01"->1,
+    // "10"->3, "11"->0 on (m10 <= 0, m01 > 0)
+    static const int quadrant_map[4] = {2, 1, 3, 0};
+    int quadrant = quadrant_map[((m10 <= 0) << 1) | (m01 > 0)];
+    uint32_t m10_abs = static_cast<uint32_t>(abs(m10));
+    uint32_t m01_abs = static_cast<uint32_t>(abs(m01));
+    int theta = sectors_ - 1;
+    for (int k = 0; k < sectors_; k++) {
+      if (((tan_constants_[k] * static_cast<uint64_t>(m10_abs)) >>
+           TAN_FRACTION_BITS) > m01_abs) {
+        theta = k;
+        break;
+      }
+    }
+
+    Keypoint keypoint;
+    keypoint.start = pop_time;
+    keypoint.scale = scale;
+    OrbFeature &feature = keypoint.feature;
+    feature.pos = ((static_cast<uint32_t>(cand.y << scale) & 0x7FF) << 16) |
+                  (static_cast<uint32_t>(cand.x << scale) & 0x7FF);
+    uint32_t angle = (static_cast<uint32_t>(quadrant) << config_.theta_size) |
+                     static_cast<uint32_t>(theta);
+    feature.scr_angle = (static_cast<uint32_t>(scale) << 28) |
+                        (static_cast<uint32_t>(cand.score & 0xFFF) << 16) |
+                        angle;
+
+    // Binary tests on the blurred patch: pattern x is the row, y the column
+    const uint8_t *pattern =
+        &patterns_[static_cast<size_t>(quadrant * sectors_ + theta) *
+                   BRIEF_PATTERN_SIZE * 4];
+    const uint8_t *patch =
+        &blurred[static_cast<size_t>(cand.y - PATCH_ROW_OFFSET) * width +
+                 cand.x - PATCH_COL_OFFSET];
+    for (int w = 0; w < 8; w++) feature.descriptor[w] = 0;
+    for (int k = 0; k < BRIEF_PATTERN_SIZE; k++) {
+      const uint8_t *test = &pattern[k * 4];
+      int p1 = patch[test[0] * width + test[1]];
+      int p2 = patch[test[2] * width + test[3]];
+      if (p1 < p2) feature.descriptor[k / 32] |= 1u << (k % 32);
+    }
+
+    keypoints->push_back(keypoint);
+  }
+}
+
+int OrbModel::process(const uint8_t *pixels, int stride, int32_t corner_thresh,
+                      int32_t corner_thresh_n,
+                      std::vector<OrbFeature> *features) {
+  int width = config_.line_size;
+  int height = config_.num_lines;
+  int32_t thr = threshold_9b(corner_thresh);
+  int32_t thr_n = threshold_9b(corner_thresh_n);
+
+  std::vector<uint8_t> image(static_cast<size_t>(width) * height);
+  for (int y = 0; y < height; y++) {
+    std::copy(pixels + static_cast<size_t>(y) * stride,
+              pixels + static_cast<size_t>(y) * stride + width,
+              image.begin() + static_cast<size_t>(y) * width);
+  }
+
+  std::vector<Keypoint> keypoints;
+  std::fill(counters_, counters_ + PERF_WORDS, 0);
+  for (int scale = 0; scale < config_.num_scales; scale++) {
+    if (scale > 0) {
+      image = downscale(image, width, height);
+      width /= 2;
+      height /= 2;
+    }
+    run_scale(image, width, height, scale, thr, thr_n, &keypoints,
+              counters_);
+  }
+
+  // One pixel per clock from clock 0
+  int64_t last_pixel =
+      static_cast<int64_t>(config_.line_size) * config_.num_lines - 1;
+  int64_t last_descriptor = 0;
+  for (size_t i = 0; i < keypoints.size(); i++) {
+    last_descriptor = std::max(last_descriptor,
+                               keypoints[i].start + DESCRIPTOR_READY_CYCLES);
+  }
+  counters_[PERF_PIXELS] = static_cast<uint32_t>(last_pixel + 1);
+  counters_[PERF_DESCRIPTORS] = static_cast<uint32_t>(keypoints.size());
+  counters_[PERF_LAST_PIXEL] = static_cast<uint32_t>(last_pixel);
+  counters_[PERF_LAST_DESCRIPTOR] = static_cast<uint32_t>(last_descriptor);
+  counters_[PERF_CYCLES] =
+      static_cast<uint32_t>(std::max(last_pixel, last_descriptor) + 1);
+
+  // write_descriptors.vhd stores descriptors in completion order
+  std::stable_sort(keypoints.begin(), keypoints.end(),
+                   [](const Keypoint &a, const Keypoint &b) {
+                     if (a.start != b.start) return a.start < b.start;
+                     return a.scale < b.scale;
+                   });
+
+  // feature_select.vhd keeps the best cell_k keypoints of each cell
+  int cells = config_.grid_cols * config_.grid_rows;
+  CellTrees trees(cells, config_.cell_k);
+  int cell_width = (config_.line_size + config_.grid_cols - 1) /
+                   config_.grid_cols;
+  int cell_height = (config_.num_lines + config_.grid_rows - 1) /
+                    config_.grid_rows;
+  int count = 0;
+  std::vector<EntryWrite> writes;
+  int64_t last_write = -DESCRIPTOR_WRITE_CYCLES;
+
+  OrbFeature empty = OrbFeature();
+  features->assign(static_cast<size_t>(cells) * config_.cell_k, empty);
+  status_ = 0;
+  for (size_t i = 0; i < keypoints.size(); i++) {
+    const OrbFeature &feature = keypoints[i].feature;
+    int x = static_cast<int>(feature.pos & 0x7FF);
+    int y = static_cast<int>((feature.pos >> 16) & 0x7FF);
+    int cell = std::min(y / cell_height, config_.grid_rows - 1) *
+                   config_.grid_cols +
+               std::min(x / cell_width, config_.grid_cols - 1);
+    uint32_t key = 0x1000 | ((feature.scr_angle >> 16) & 0xFFF);
+
+    bool was_empty = false;
+    int slot = trees.insert(cell, key, &was_empty);
+    if (slot >= 0) {
+      (*features)[slot] = feature;
+      EntryWrite write;
+      write.time = std::max(keypoints[i].start,
+                            last_write + DESCRIPTOR_WRITE_CYCLES);
+      write.slot = slot;
+      writes.push_back(write);
+      last_write = write.time;
+    }
+    if (slot >= 0 && was_empty) {
+      count++;
+    } else {
+      status_ = FEATURE_STATUS_OVERFLOW;
+    }
+  }
+  if (config_.match_refs > 0) match_entries(writes, *features);
+  // A single cell fills its entries in order
+  if (cells == 1) features->resize(count);
+  status_ |= static_cast<uint32_t>(count);
+  return count;
+}
+
+void OrbModel::set_references(const uint32_t *words, int count) {
+  count = std::min(std::max(count, 0), config_.match_refs);
+  references_.assign(words, words + static_cast<size_t>(count) *
+                                        MATCH_REF_WORDS);
+}
+
+/**
+ * @brief Replay descriptor_match.vhd over the descriptor writes of a frame
+ *
+ * Keypoints are served in write order, each for the reference count plus
+ * MATCH_EXTRA_CYCLES clocks; one written while match_queue others wait is
+ * dropped. The last write of an entry decides it: a drop leaves it
+ * invalid, a match the nearest two references of that keypoint.
+ */
+void OrbModel::match_entries(const std::vector<EntryWrite> &writes,
+                             const std::vector<OrbFeature> &features) {
+  int refs = static_cast<int>(references_.size() / MATCH_REF_WORDS);
+  int64_t service = refs > 0 ? refs + MATCH_EXTRA_CYCLES : MATCH_EMPTY_CYCLES;
+  matches_.assign(static_cast<size_t>(config_.feature_lines) * 2, 0);
+  std::vector<int64_t> waiting;  // Pop clock of every accepted keypoint
+  size_t served = 0;
+  int64_t free = 0;
+  int dropped = 0;
+
+  for (size_t i = 0; i < writes.size(); i++) {
+    const EntryWrite &write = writes[i];
+    while (served < waiting.size() && waiting[served] < write.time) served++;
+    uint32_t *table = &matches_[static_cast<size_t>(write.slot) * 2];
+    if (static_cast<int>(waiting.size() - served) >= config_.match_queue) {
+      table[0] = 0;
+      table[1] = 0;
+      dropped++;
+      continue;
+    }
+    int64_t pop = std::max(write.time + 1, free);
+    waiting.push_back(pop);
+    free = pop + service;
+
+    // Nearest two, the lower index on ties
+    const uint32_t *descriptor = features[write.slot].descriptor;
+    int best = -1;
+    int second = -1;
+    int best_distance = 0;
+    int second_distance = 0;
+    for (int r = 0; r < refs; r++) {
+      const uint32_t *reference = &references_[r * MATCH_REF_WORDS];
+      int distance = 0;
+      for (int w = 0; w < MATCH_REF_WORDS; w++) {
+        distance += __builtin_popcount(descriptor[w] ^ reference[w]);
+      }
+      if (best < 0 || distance < best_distance) {
+        second = best;
+        second_distance = best_distance;
+        best = r;
+        best_distance = distance;
+      } else if (second < 0 || distance < second_distance) {
+        second = r;
+        second_distance = distance;
+      }
+    }
+    table[0] = best < 0 ? 0
+                        : MATCH_VALID |
+                              (static_cast<uint32_t>(best_distance)
+                               << MATCH_DISTANCE_SHIFT) |
+                              static_cast<uint32_t>(best);
+    table[1] = second < 0 ? 0
+                          : MATCH_VALID |
+                                (static_cast<uint32_t>(second_distance)
+                                 << MATCH_DISTANCE_SHIFT) |
+                                static_cast<uint32_t>(second);
+  }
+  match_status_ = static_cast<uint32_t>(dropped) & MATCH_STATUS_DROPPED;
+}
+
+void OrbModel::store_matches(uint32_t *table) const {
+  size_t words = static_cast<size_t>(config_.feature_lines) * 2;
+  for (size_t i = 0; i < words; i++) {
+    table[i] = i < matches_.size() ? matches_[i] : 0;
+  }
+}
+
+void OrbModel::store_counters(uint32_t *words) const {
+  std::copy(counters_, counters_ + PERF_WORDS, words);
+}
+
+void OrbModel::store(const std::vector<OrbFeature> &features, uint32_t *pos,
+                     uint32_t *scr_angle, uint32_t *descript0,
+                     uint32_t *descript1) const {
+  for (int i = 0; i < config_.feature_lines; i++) {
+    bool valid = i < static_cast<int>(features.size());
+    if (pos) pos[i] = valid ? features[i].pos : 0;
+    if (scr_angle) scr_angle[i] = valid ? features[i].scr_angle : 0;
+    for (int component = 0; component < 4; component++) {
+      if (descript0) {
+        descript0[i * 4 + component] =
+            valid ? features[i].descriptor[component] : 0;
+      }
+      if (descript1) {
+        descript1[i * 4 + component] =
+            valid ? features[i].descriptor[4 + component] : 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,266 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file orb_model.h
+ * @brief Bit-exact software model of the ORB accelerator
+ *
+ * Reference implementation of the hardware pipeline in hdl/ for hosts without
+ * the FPGA. Every stage follows the integer arithmetic of the RTL:
+ *
+ * - fast_detector.vhd: 16 pixel Bresenham circle, 9 contiguous pixels, score
+ *   is the 12-bit sum of the absolute differences, strict 3x3 NMS
+ * - scalar.vhd: 2x2 box average (truncated) for every extra scale
+ * - orientation_module*.vhd: 7x7 binomial blur (>> 12), 37x37 intensity
+ *   centroid, quadrant plus tangent comparisons against the Spiral constants
+ * - descriptor_construct.vhd: 256 tests of BRIEF_pattern.txt rotated to the
+ *   sector of the feature, sampled on the blurred 32x32 patch
+ * - fast_brief_coordinator.vhd / feature_fifo.vhd: border filtering, FIFO
+ *   capacity and the descriptor constructors of each scale, started
+ *   round-robin (constructor_dispatcher.vhd)
+ * - write_descriptors.vhd / feature_select.vhd: the best cell_k keypoints
+ *   by score in each cell of the grid, with the same tie breaking and the
+ *   same BRAM entries
+ * - descriptor_match.vhd: nearest and second nearest reference descriptor
+ *   of every entry, by Hamming distance, and its queue
+ * - orb_counters.vhd: event counts and stamps of the frame on the same
+ *   timeline
+ *
+ * The model produces the words written by write_descriptors.vhd, so the
+ * output can be decoded with exactly the same code used for the BRAMs.
+ */
+
+#ifndef ORB_MODEL_H
+#define ORB_MODEL_H
+
+#include <stdint.h>
+
+#include <vector>
+
+// ============================================================================
+// MODEL CONFIGURATION
+// ============================================================================
+
+#define MAX_SCALES 8  // Pyramid levels the 3-bit feature_scale can tell apart
+
+/**
+ * @brief Generics of the modelled bitstream
+ *
+ * Defaults match the orb_0 instance of ORB_sample_bd.tcl, at the root of
+ * the repository.
+ */
+struct OrbModelConfig {
+  int line_size;      // ACONF_LINE_SIZE, image width in pixels
+  int num_lines;      // ACONF_NUM_LINES, image height in pixels
+  int num_scales;     // ACONF_NUM_SCALES, pyramid levels (1 to 8)
+  int theta_size;     // ACONF_THETA_SIZE, log2 of the sectors per quadrant
+  int fifo_size;      // ACONF_FEATURE_FIFO_SIZE, FAST to BRIEF queue depth
+  int constructors;   // Descriptor constructors per level
+  int feature_lines;  // Entries available in the descriptor BRAMs
+  int grid_cols;      // write_descriptors GRID_X, selection cells per line
+  int grid_rows;      // write_descriptors GRID_Y, selection cells per column
+  int cell_k;         // write_descriptors CELL_K, keypoints kept per cell
+  int match_refs;     // descriptor_match MAX_REFS, 0 without the matcher
+  int match_queue;    // descriptor_match QUEUE_DEPTH
+  /**
+   * Clock cycles during which the descriptor constructor of one scale is
+   * unavailable after starting: constructor_delay (46 * 2 + 5) plus the 49
+   * cycles needed to refill the patch window (constructor_supervisor.vhd).
+   * Expressed in scale 0 pixel periods, i.e. assuming one pixel per clock.
+   */
+  int constructor_busy;
+
+  OrbModelConfig()
+      : line_size(640),
+        num_lines(480),
+        num_scales(3),
+        theta_size(3),
+        fifo_size(256),
+        constructors(1),
+        feature_lines(512),
+        grid_cols(1),
+        grid_rows(1),
+        cell_k(512),
+        match_refs(512),
+        match_queue(16),
+        constructor_busy(46 * 2 + 5 + 49) {}
+};
+
+// ============================================================================
+// MODEL OUTPUT
+// ============================================================================
+
+/**
+ * @brief One keypoint as written to the descriptor BRAMs
+ *
+ * Field layout is the one of write_descriptors.vhd:
+ * - pos:       "00000" & pos_y(11) & "00000" & pos_x(11)
+ * - scr_angle: "0" & scale(3) & score(12) & zeros & quadrant & theta
+ * - descriptor[0..3] is section 0 (_descripts_ptr[0]), descriptor[4..7] is
+ *   section 1 (_descripts_ptr[1]); bit k of the 256-bit word is BRIEF test k
+ */
+struct OrbFeature {
+  uint32_t pos;
+  uint32_t scr_angle;
+  uint32_t descriptor[8];
+};
+
+// Status word of write_descriptors.vhd, cleared by the reset
+#define FEATURE_STATUS_COUNT 0x0000FFFF     // Entries used this frame
+#define FEATURE_STATUS_OVERFLOW 0x80000000  // A keypoint found its cell full
+
+// Window of descriptor_match.vhd, in 32-bit words
+#define MATCH_REF_WORDS 8       // Words per reference, as descript0|1
+#define MATCH_TABLE_WORD 4096   // Best and second best word of each entry
+#define MATCH_COUNT_WORD 6144   // References in use, written by the host
+#define MATCH_STATUS_WORD 6145  // Busy and dropped keypoints
+#define MATCH_WINDOW_WORDS 8192
+#define MATCH_MAX_REFS 512
+
+// Match table word: valid, Hamming distance (0-256) and reference index
+#define MATCH_VALID 0x80000000
+#define MATCH_DISTANCE_SHIFT 16
+#define MATCH_DISTANCE_MASK 0x1FF
+#define MATCH_INDEX_MASK 0xFFFF
+
+// Status word of descriptor_match.vhd, the dropped count cleared by reset
+#define MATCH_STATUS_BUSY 0x80000000     // Keypoints queued or in progress
+#define MATCH_STATUS_DROPPED 0x0000FFFF  // Keypoints that found it full
+
+// Window of orb_counters.vhd, in 32-bit words, cleared by the reset. Counts
+// add up the levels; stamps are clocks since the reset was released.
+#define PERF_PIXELS 0            // Pixels pushed into level 0
+#define PERF_CANDIDATES 1        // FAST corners before the NMS
+#define PERF_SURVIVORS 2         // Corners left by the NMS
+#define PERF_DESCRIPTORS 3       // Descriptors out of orb.vhd
+#define PERF_FIFO_FULL 4         // Clocks a feature FIFO was full
+#define PERF_FIFO_DROPPED 5      // Features dropped on a full FIFO
+#define PERF_BUSY_DROPPED 6      // Features dropped on a busy constructor
+#define PERF_CONSTRUCTOR_BUSY 7  // Clocks all constructors were busy
+#define PERF_FIRST_PIXEL 8       // Stamp of the first pixel
+#define PERF_LAST_PIXEL 9        // Stamp of the last pixel
+#define PERF_LAST_DESCRIPTOR 10  // Stamp of the last descriptor
+#define PERF_CYCLES 11           // Clocks since the reset
+// Per level, PERF_LEVELS words each, level s at word + s
+#define PERF_FIFO_HIGH_WATER 12      // Most features queued in the FIFO
+#define PERF_LEVEL_FIFO_DROPPED 20   // Dropped on a full FIFO
+#define PERF_LEVEL_BUSY_DROPPED 28   // Dropped on a busy constructor
+#define PERF_LEVELS 8
+#define PERF_WORDS 36
+
+// ============================================================================
+// MODEL
+// ============================================================================
+
+/**
+ * @brief Functional, bit-exact model of the ORB accelerator
+ *
+ * Per keypoint values (position, score, orientation, descriptor) are exact.
+ * Which keypoints survive the FIFO and the constructor arbitration depends on
+ * the clock relation between the stages; the model replays it on a one pixel
+ * per clock timeline, which is how get_pix.vhd feeds scale 0.
+ */
+class OrbModel {
+ public:
+  explicit OrbModel(const OrbModelConfig &config = OrbModelConfig());
+
+  /**
+   * @brief Run one frame through the model
+   * @param pixels Grayscale frame, line_size x num_lines
+   * @param stride Distance in bytes between consecutive lines
+   * @param corner_thresh FAST darker threshold (signed 9-bit register)
+   * @param corner_thresh_n FAST brighter threshold (signed 9-bit register)
+   * @param features Output BRAM entries, grid_cols * grid_rows * cell_k
+   *        of them with a grid (empty entries are zero), only the used ones
+   *        with a single cell
+   * @return Number of keypoints kept
+   */
+  int process(const uint8_t *pixels, int stride, int32_t corner_thresh,
+              int32_t corner_thresh_n, std::vector<OrbFeature> *features);
+
+  /**
+   * @brief Copy keypoints into BRAM images with the accelerator layout
+   *
+   * Entries without a keypoint are cleared, as the reset of
+   * write_descriptors.vhd does, so pos == 0 marks them for the host. Any
+   * pointer may be null.
+   */
+  void store(const std::vector<OrbFeature> &features, uint32_t *pos,
+             uint32_t *scr_angle, uint32_t *descript0,
+             uint32_t *descript1) const;
+
+  /**
+   * @brief Status word of the last frame, as write_descriptors.vhd sets it
+   */
+  uint32_t status() const { return status_; }
+
+  /**
+   * @brief Load the reference set of the matcher, used from the next frame
+   * @param words MATCH_REF_WORDS words per reference, as in the window
+   * @param count References, at most match_refs
+   */
+  void set_references(const uint32_t *words, int count);
+
+  /**
+   * @brief Write the match table of the last frame, two words per entry
+   *
+   * Entries without a matched keypoint are zero, as after the reset of
+   * descriptor_match.vhd.
+   * @param table feature_lines * 2 words, from MATCH_TABLE_WORD
+   */
+  void store_matches(uint32_t *table) const;
+
+  /**
+   * @brief Status word of the matcher after the last frame, never busy
+   */
+  uint32_t match_status() const { return match_status_; }
+
+  /**
+   * @brief Write the orb_counters.vhd window of the last frame
+   *
+   * The model streams one pixel per clock from clock 0 and stops the cycle
+   * count at the last event, so the stream never waits on the host.
+   * @param words PERF_WORDS words
+   */
+  void store_counters(uint32_t *words) const;
+
+  const OrbModelConfig &config() const { return config_; }
+
+ private:
+  struct Candidate {
+    int y;
+    int x;
+    int score;
+  };
+
+  struct Keypoint {
+    int64_t start;  // Pixel clock at which the constructor starts
+    int scale;
+    OrbFeature feature;
+  };
+
+  struct EntryWrite {
+    int64_t time;  // Clock of we_descriptor
+    int slot;
+  };
+
+  void build_patterns();
+  void match_entries(const std::vector<EntryWrite> &writes,
+                     const std::vector<OrbFeature> &features);
+  void run_scale(const std::vector<uint8_t> &image, int width, int height,
+                 int scale, int32_t thr, int32_t thr_n,
+                 std::vector<Keypoint> *keypoints, uint32_t *counters) const;
+  int64_t pixel_clock(int scale, int y, int x) const;
+
+  OrbModelConfig config_;
+  int sectors_;
+  std::vector<uint32_t> tan_constants_;
+  // Rotated pattern per sector: [sector][test][x0, y0, x1, y1]
+  std::vector<uint8_t> patterns_;
+  uint32_t status_;
+  std::vector<uint32_t> references_;  // MATCH_REF_WORDS per reference
+  std::vector<uint32_t> matches_;     // Two words per entry
+  uint32_t match_status_;
+  uint32_t counters_[PERF_WORDS];
+};
+
+#endif  // ORB_MODEL_H
@@ -0,0 +1,173 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file spsc_queue.h
+ * @brief Bounded single producer, single consumer queue between host stages
+ *
+ * A ring of fixed capacity with one atomic index per side, so neither side
+ * takes a lock. A blocked side spins for a while, then sleeps with an
+ * increasing backoff; the time spent blocked is accumulated per side, next
+ * to the queue depth, to show which stage of a pipeline holds it back.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define SPSC_SPIN_POLLS 100    // Polls before a blocked side starts to sleep
+#define SPSC_SLEEP_MAX_US 200  // Longest sleep of a blocked side
+#define SPSC_CACHE_LINE 64     // Keeps the two indices on separate lines
+
+/**
+ * @brief Queue statistics, each field written by one side only
+ *
+ * Read them once both sides are done, e.g. after joining the threads.
+ */
+struct SpscQueueStats {
+  uint64_t pushes;          // Items pushed
+  uint64_t depth_sum;       // Depth seen by each push, item included
+  size_t max_depth;         // Highest depth seen by a push
+  double push_stall_us;     // Producer time blocked on a full queue
+  double pop_stall_us;      // Consumer time blocked on an empty queue
+
+  SpscQueueStats()
+      : pushes(0), depth_sum(0), max_depth(0), push_stall_us(0),
+        pop_stall_us(0) {}
+
+  double mean_depth() const {
+    return pushes > 0 ? static_cast<double>(depth_sum) / pushes : 0;
+  }
+};
+
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(size_t capacity)
+      : items_(capacity), head_(0), tail_(0), closed_(false) {}
+
+  size_t capacity() const { return items_.size(); }
+
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Push without blocking, producer side
+   * @return false if the queue is full
+   */
+  bool try_push(const T &item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t depth = tail - head_.load(std::memory_order_acquire);
+    if (depth == items_.size()) return false;
+
+    items_[tail % items_.size()] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    stats_.pushes++;
+    stats_.depth_sum += depth + 1;
+    stats_.max_depth = std::max(stats_.max_depth, depth + 1);
+    return true;
+  }
+
+  /**
+   * @brief Pop without blocking, consumer side
+   * @return false if the queue is empty
+   */
+  bool try_pop(T *item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+
+    *item = items_[head % items_.size()];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Push, blocking while the queue is full
+   * @return false if the queue was closed, the item is then dropped
+   */
+  bool push(const T &item) {
+    if (closed()) return false;
+    if (try_push(item)) return true;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    bool pushed = false;
+    Backoff backoff;
+    while (!closed() && !(pushed = try_push(item))) backoff.wait();
+    stats_.push_stall_us += elapsed_us(start);
+    return pushed;
+  }
+
+  /**
+   * @brief Pop, blocking while the queue is empty
+   * @return false once the queue is closed and drained
+   */
+  bool pop(T *item) {
+    if (try_pop(item)) return true;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    bool popped = false;
+    Backoff backoff;
+    while (!(popped = try_pop(item))) {
+      // An item pushed just before close() is still delivered
+      if (closed()) {
+        popped = try_pop(item);
+        break;
+      }
+      backoff.wait();
+    }
+    stats_.pop_stall_us += elapsed_us(start);
+    return popped;
+  }
+
+  /**
+   * @brief End the stream, either side may call it
+   *
+   * Blocked and later pushes fail; pops return the items left, then fail.
+   */
+  void close() { closed_.store(true, std::memory_order_release); }
+
+  bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+  const SpscQueueStats &stats() const { return stats_; }
+
+ private:
+  class Backoff {
+   public:
+    Backoff() : polls_(0), sleep_us_(1) {}
+
+    void wait() {
+      if (++polls_ < SPSC_SPIN_POLLS) return;
+      std::this_thread::sleep_for(std::chrono::microseconds(sleep_us_));
+      sleep_us_ = std::min(sleep_us_ * 2, SPSC_SLEEP_MAX_US);
+    }
+
+   private:
+    int polls_;
+    int sleep_us_;
+  };
+
+  static double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  }
+
+  std::vector<T> items_;
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> head_;  // Next item to pop
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> tail_;  // Next slot to push
+  std::atomic<bool> closed_;
+  SpscQueueStats stats_;
+};
+
+#endif  // SPSC_QUEUE_H
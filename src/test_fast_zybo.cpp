@@ -7,35 +7,44 @@
  * This program tests the hardware-accelerated ORB (Oriented FAST and Rotated
  * BRIEF) feature detection implementation on the Zynq 7020 platform. It
  * processes input images through the FPGA accelerator and extracts keypoints
- * with descriptors.
+ * with descriptors. Videos, image directories and globs are streamed back to
+ * back through one session, reporting throughput and latency.
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <time.h>
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <opencv2/opencv.hpp>
+#include <thread>
 
-#include "dma_zcu.h"
+#include "frame_metrics.h"
+#include "hamming_matcher.h"
+#include "keypoint_log.h"
+#include "keypoint_tracker.h"
+#include "orb_accelerator.h"
+#include "spsc_queue.h"
+#include "threshold_control.h"
+#include "tool_common.h"
 
 // ============================================================================
 // CONFIGURATION CONSTANTS
 // ============================================================================
 
-// Image dimensions
-#define LINE_SIZE 640  // Image width in pixels
-#define NUM_LINES 480  // Image height in pixels
+// Frames in flight between the stages of a stream
+#define PIPELINE_FRAMES 4
 
-// Feature detection parameters
-#define MAX_FEATURES 600    // Maximum number of features to detect
-#define FEAT_MEM_LINES 512  // Feature memory buffer size
+// Runs of a single image while the automatic threshold settles
+#define THRESHOLD_SETTLE_RUNS 8
 
-// Memory configuration
-#define MEM_SIZE_PIX 65528   // Total pixel memory size
-#define MEM_LINE_SIZE_PIX 8  // Pixels per memory line
-#define BURST_SIZE 254       // DMA burst transfer size
+// Largest Hamming distance of a keypoint counted as matched by --match
+#define MATCH_MAX_DISTANCE 64
 
 // ============================================================================
 // GLOBAL VARIABLES
@@ -45,26 +54,158 @@
 int32_t corner_thresh = 15;     // Positive threshold for corner detection
 int32_t corner_thresh_n = -15;  // Negative threshold for corner detection
 
+// Keypoints per frame of the automatic threshold, 0 keeps the thresholds
+// fixed; set by --target-features
+int target_features = 0;
+
+// Annotated image of single image runs, disabled by --no-output
+bool write_output = true;
+
+// Split frames larger than the bitstream into tiles, enabled by --tile
+bool tile_frames = false;
+
+// Match each frame of a stream against the previous one in the fabric,
+// enabled by --match
+bool match_frames = false;
+
+// Match each frame of a stream against the previous one on the host, in the
+// consumer thread, enabled by --host-match
+bool host_match = false;
+
+// Follow keypoints from frame to frame with persistent track IDs, in the
+// consumer thread, enabled by --track
+bool track_keypoints = false;
+
+// Binary keypoint log written instead of the keypoint text, set by --log
+std::string log_path;
+
+// Per-frame stage times and fabric counters, JSON Lines or CSV, set by
+// --metrics
+std::string metrics_path;
+
 // ============================================================================
 // FUNCTION DECLARATIONS
 // ============================================================================
 
 /**
  * @brief Process a single image frame through the ORB accelerator
+ * @param accelerator Opened accelerator backend
  * @param imagePath Path to the input image file
- * @param index Pointer to current buffer index
- * @param index_offset Pointer to index offset
  * @return 0 on success, 1 on error
  */
-int process_frame(std::string imagePath, uint32_t *index, u32 *index_offset);
+int process_frame(OrbAccelerator *accelerator, std::string imagePath);
+
+/**
+ * @brief Stream a video, an image directory or a glob through the accelerator
+ *
+ * Frames are converted to grayscale and resized to the size of the
+ * bitstream, unless they are larger and tiled.
+ * Decoding, the accelerator (upload, wait and readback) and the keypoint
+ * consumer run as three threads linked by SPSC queues, over a pool of
+ * PIPELINE_FRAMES frames. Prints the keypoint count and latency of every
+ * frame, then steady-state fps, latency percentiles and per queue depth and
+ * stall times.
+ * @param accelerator Opened accelerator backend
+ * @param input Video file or camera device, directory or glob pattern
+ * @return 0 on success, 1 on error
+ */
+int process_stream(OrbAccelerator *accelerator, const std::string &input);
+
+/**
+ * @brief One frame of a stream and its keypoints, recycled between stages
+ */
+struct StreamFrame {
+  cv::Mat frame;        // As decoded
+  cv::Mat gray;         // Grayscale to process, may share frame
+  KeypointBatch batch;  // Keypoints read back
+  int count;            // Keypoints, -1 if the accelerator failed
+  bool overflowed;      // A selection cell was full
+  int threshold;        // FAST threshold the frame was processed with
+  double accel_us;      // Time spent in detect()
+  int64_t timestamp_ns;  // Decoded, since the epoch
+  std::vector<KeypointMatch> matches;  // Against the previous frame
+  int matched;  // Matches within MATCH_MAX_DISTANCE, -1 if not matched
+  OrbFrameMetrics metrics;  // Of detect(), with the decode time
+};
+
+/**
+ * @brief Frames of a video, a camera or a list of image files
+ */
+struct FrameSource {
+  cv::VideoCapture capture;
+  std::vector<std::string> paths;
+  size_t next_path;
+
+  FrameSource() : next_path(0) {}
+
+  /**
+   * @brief Decode the next frame, files that are not images are skipped
+   * @return false at the end of the stream
+   */
+  bool read(cv::Mat *frame);
+};
+
+/**
+ * @brief Whether a frame is processed as tiles
+ */
+bool is_tiled(const OrbAccelerator *accelerator, const cv::Mat &gray);
+
+/**
+ * @brief Detect the keypoints of a grayscale frame, tiles if is_tiled()
+ * @return Number of keypoints, -1 on error
+ */
+int detect_frame(OrbAccelerator *accelerator, const cv::Mat &gray,
+                 KeypointBatch *batch);
 
 /**
- * @brief Convert quadrant and theta values to orientation in degrees
- * @param quadrant Quadrant value (0-3)
- * @param theta Theta value within quadrant
- * @return Orientation angle in degrees
+ * @brief Decode stage: fill free frames from the source
  */
-float get_orientation(uint16_t quadrant, uint16_t theta);
+void decode_stage(const OrbAccelerator *accelerator, FrameSource *source,
+                  SpscQueue<StreamFrame *> *free_frames,
+                  SpscQueue<StreamFrame *> *decoded);
+
+/**
+ * @brief Accelerator stage: detect the keypoints of decoded frames
+ * @param controller Sets the thresholds of each next frame, may be null
+ */
+void accelerate_stage(OrbAccelerator *accelerator,
+                      ThresholdController *controller,
+                      SpscQueue<StreamFrame *> *decoded,
+                      SpscQueue<StreamFrame *> *detected);
+
+/**
+ * @brief Match a frame against the references, then make its strongest
+ *        keypoints the references of the next frame
+ *
+ * Sets matched, unless the frame was tiled or there were no references.
+ * @param have_references Whether the previous frame loaded references
+ * @return Whether references are loaded for the next frame
+ */
+bool match_frame(OrbAccelerator *accelerator, bool have_references,
+                 StreamFrame *frame);
+
+/**
+ * @brief Print the depth and stall times of one queue of the pipeline
+ */
+void print_queue(const char *producer, const char *consumer,
+                 const SpscQueueStats &stats);
+
+/**
+ * @brief Print the mean stage times of frames and where they waited
+ * @param total Metrics summed over the frames
+ */
+void print_metrics(const OrbFrameMetrics &total, size_t frames);
+
+/**
+ * @brief Whether the input names a single image, not a stream of frames
+ */
+bool is_single_image(const std::string &input);
+
+/**
+ * @brief Print keypoints and their descriptors, one feature per two lines
+ * @param batch Keypoints read from the accelerator
+ */
+void print_keypoints(const KeypointBatch &batch);
 
 // ============================================================================
 // MAIN FUNCTION
@@ -81,9 +222,121 @@ int main(int argc, char const *argv[]) {
   // COMMAND LINE ARGUMENT PROCESSING
   // ========================================================================
 
-  if (argc < 2) {
+  // Optional --backend <zynq|shm|model>, --model is kept as an alias
+  std::string backend = "zynq";
+  bool ping_pong = false;
+  u32 dma_base_addr = 0;
+  std::string uio_path;
+  std::string config_path;
+  bool scan_features = false;
+  int arg = 1;
+  while (argc > arg && std::string(argv[arg]).compare(0, 2, "--") == 0) {
+    std::string option = argv[arg];
+    if (option == "--model") {
+      backend = "model";
+      arg++;
+    } else if (option == "--no-output") {
+      write_output = false;
+      arg++;
+    } else if (option == "--tile") {
+      tile_frames = true;
+      arg++;
+    } else if (option == "--match") {
+      match_frames = true;
+      arg++;
+    } else if (option == "--host-match") {
+      host_match = true;
+      arg++;
+    } else if (option == "--track") {
+      track_keypoints = true;
+      arg++;
+    } else if (option == "--log" && argc > arg + 1) {
+      log_path = argv[arg + 1];
+      arg += 2;
+    } else if (option == "--metrics" && argc > arg + 1) {
+      metrics_path = argv[arg + 1];
+      arg += 2;
+    } else if (option == "--target-features" && argc > arg + 1) {
+      target_features = static_cast<int>(strtol(argv[arg + 1], nullptr, 10));
+      arg += 2;
+    } else if (option == "--config" && argc > arg + 1) {
+      config_path = argv[arg + 1];
+      arg += 2;
+    } else if (option == "--scan-features") {
+      scan_features = true;
+      arg++;
+    } else if (option == "--ping-pong") {
+      ping_pong = true;
+      arg++;
+    } else if (option == "--dma" && argc > arg + 1) {
+      dma_base_addr = static_cast<u32>(strtoul(argv[arg + 1], nullptr, 0));
+      arg += 2;
+    } else if (option == "--uio" && argc > arg + 1) {
+      uio_path = argv[arg + 1];
+      arg += 2;
+    } else if (option == "--backend" && argc > arg + 1) {
+      backend = argv[arg + 1];
+      arg += 2;
+    } else {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return 1;
+    }
+  }
+
+  if (argc < arg + 1) {
     std::cerr << "Usage: " << argv[0]
-              << " <image_path> [positive_threshold] [negative_threshold]"
+              << " [--backend zynq|shm|model] [--config file] [--tile] "
+                 "[--match] [--host-match] [--track] [--log file] "
+                 "[--metrics file] "
+                 "[--target-features count] "
+                 "[--ping-pong] "
+                 "[--dma address] "
+                 "[--uio device] [--scan-features] [--no-output] <image_path> "
+                 "[positive_threshold] [negative_threshold]"
+              << std::endl;
+    std::cerr << "  --backend: zynq (FPGA, default), shm (emulated device on "
+                 "/dev/shm) or model (software model)"
+              << std::endl;
+    std::cerr << "  --model: Same as --backend model" << std::endl;
+    std::cerr << "  --config: Geometry of the bitstream (default: "
+              << BITSTREAM_CONFIG << " if present, else 640x480)" << std::endl;
+    std::cerr << "  --tile: Process frames larger than the bitstream as "
+                 "overlapping tiles instead of rejecting or resizing them"
+              << std::endl;
+    std::cerr << "  --match: Match the keypoints of each frame of a stream "
+                 "against the strongest of the previous frame, on the "
+                 "descriptor matcher"
+              << std::endl;
+    std::cerr << "  --host-match: Match the keypoints of each frame of a "
+                 "stream against the previous frame on the host, with the "
+                 "ratio test and cross-check"
+              << std::endl;
+    std::cerr << "  --track: Follow the keypoints of a stream from frame to "
+                 "frame, searching a window around each one"
+              << std::endl;
+    std::cerr << "  --log: Write the keypoints of every frame to a binary "
+                 "log (keypoint_log.h) instead of printing them"
+              << std::endl;
+    std::cerr << "  --metrics: Write the stage times and fabric counters of "
+                 "every frame, JSON Lines if the file ends in .json, else CSV"
+              << std::endl;
+    std::cerr << "  --target-features: Set the thresholds of every frame to "
+                 "keep about this many keypoints, starting from "
+                 "positive_threshold"
+              << std::endl;
+    std::cerr << "  --ping-pong: Refuse a bitstream whose get_pix is not "
+                 "PING_PONG, the default without a sidecar"
+              << std::endl;
+    std::cerr << "  --dma: Upload pixels with the DMA controller at this AXI "
+                 "address"
+              << std::endl;
+    std::cerr << "  --uio: Wait on the chunk_done interrupt of this UIO device "
+                 "instead of polling"
+              << std::endl;
+    std::cerr << "  --scan-features: Find the end of the keypoints by "
+                 "scanning for pos == 0 (bitstream without the status word)"
+              << std::endl;
+    std::cerr << "  --no-output: Do not write the annotated image"
               << std::endl;
     std::cerr << "  image_path: Path to input image file" << std::endl;
     std::cerr << "  positive_threshold: FAST corner detection positive "
@@ -96,10 +349,10 @@ int main(int argc, char const *argv[]) {
   }
 
   // Parse optional threshold parameters
-  if (argc >= 4) {
+  if (argc >= arg + 3) {
     char *endptr = nullptr;
-    corner_thresh = static_cast<int32_t>(strtol(argv[2], &endptr, 10));
-    corner_thresh_n = static_cast<int32_t>(strtol(argv[3], &endptr, 10));
+    corner_thresh = static_cast<int32_t>(strtol(argv[arg + 1], &endptr, 10));
+    corner_thresh_n = static_cast<int32_t>(strtol(argv[arg + 2], &endptr, 10));
 
     std::cout << "Using custom thresholds: positive=" << corner_thresh
               << ", negative=" << corner_thresh_n << std::endl;
@@ -109,41 +362,76 @@ int main(int argc, char const *argv[]) {
   // PLATFORM INITIALIZATION
   // ========================================================================
 
-  std::cout << "Initializing FPGA platform..." << std::endl;
-  platform_t platform = init_platform();
+  OrbAcceleratorConfig config;
+  if (load_bitstream_config(&config_path, &config) != 0) return 1;
+  std::cout << "Bitstream geometry: " << config.line_size << "x"
+            << config.num_lines << ", " << (4 << config.theta_size)
+            << " orientation sectors, best " << config.cell_k
+            << " keypoints per cell of a " << config.grid_cols << "x"
+            << config.grid_rows << " grid" << std::endl;
+  if (ping_pong && !config.ping_pong) {
+    std::cerr << "--ping-pong needs a bitstream with get_pix PING_PONG"
+              << std::endl;
+    return 1;
+  }
+  if (!uio_path.empty() && !config.chunk_irq) {
+    std::cerr << "--uio needs a bitstream with chunk_done wired to IRQ_F2P"
+              << std::endl;
+    return 1;
+  }
+  config.dma_base_addr = dma_base_addr;
+  config.uio_path = uio_path;
+  if (scan_features) config.feature_status = false;
+  if (match_frames && config.match_refs == 0) {
+    std::cerr << "--match needs a bitstream with the descriptor matcher"
+              << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<OrbAccelerator> accelerator =
+      orb_accelerator_create(backend, config);
+  if (!accelerator) {
+    std::cerr << "Unknown backend: " << backend << std::endl;
+    return 1;
+  }
 
-  // Reset the FPGA accelerator
-  _reset_ptr[0] = 0;
+  std::cout << "Initializing " << accelerator->name() << " backend..."
+            << std::endl;
+  if (accelerator->open() != 0) {
+    std::cerr << "Could not open the " << accelerator->name() << " backend"
+              << std::endl;
+    return 1;
+  }
+  if (accelerator->reset() != 0) {
+    std::cerr << "Could not reset the " << accelerator->name() << " backend"
+              << std::endl;
+    return 1;
+  }
+  accelerator->set_thresholds(corner_thresh, corner_thresh_n);
 
   // ========================================================================
   // MEMORY INITIALIZATION
   // ========================================================================
 
-  std::cout << "Initializing feature memory buffers..." << std::endl;
-
-  // Clear feature descriptor memory
-  for (int i = 0; i < FEAT_MEM_LINES - 1; i++) {
-    // Clear descriptor data (2 sections, 4 components each)
-    for (int section = 1; section >= 0; section--) {
-      for (int component = 3; component >= 0; component--) {
-        _descripts_ptr[section][i * 4 + component] = 0;
-      }
-    }
-    // Clear position data
-    _descripts_pos_ptr[i] = 0;
+  if (scan_features) {
+    std::cout << "Initializing feature memory buffers..." << std::endl;
+    accelerator->clear_features();
   }
 
   // ========================================================================
   // IMAGE PROCESSING
   // ========================================================================
 
-  std::string imagePath = argv[1];
-  uint32_t index = 1;  // Buffer index starts at 1 (0 reserved for control)
-  u32 index_offset = 0;
+  std::string imagePath = argv[arg];
+  int result = 0;
 
-  std::cout << "Processing image: " << imagePath << std::endl;
-
-  int result = process_frame(imagePath, &index, &index_offset);
+  if (is_single_image(imagePath)) {
+    std::cout << "Processing image: " << imagePath << std::endl;
+    result = process_frame(accelerator.get(), imagePath);
+  } else {
+    std::cout << "Processing stream: " << imagePath << std::endl;
+    result = process_stream(accelerator.get(), imagePath);
+  }
 
   if (result == 0) {
     std::cout << "Image processing completed successfully." << std::endl;
@@ -151,301 +439,571 @@ int main(int argc, char const *argv[]) {
     std::cerr << "Error processing image." << std::endl;
   }
 
+  accelerator->close();
   return result;
 }
 
-int process_frame(std::string imagePath, uint32_t *index, u32 *index_offset) {
+int process_frame(OrbAccelerator *accelerator, std::string imagePath) {
   // ========================================================================
   // IMAGE LOADING AND VALIDATION
   // ========================================================================
   cv::Mat grayImage = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
-  cv::Mat coloredImage = cv::imread(imagePath, cv::IMREAD_COLOR);
+  cv::Mat coloredImage;  // Overlay, derived from grayImage if written
 
   if (grayImage.empty()) {
     std::cerr << "Could not read the image: " << imagePath << std::endl;
     return 1;
   }
+  const OrbAcceleratorConfig &config = accelerator->config();
+  if (!is_tiled(accelerator, grayImage) &&
+      (grayImage.cols != config.line_size ||
+       grayImage.rows != config.num_lines)) {
+    std::cerr << "Image must be " << config.line_size << "x"
+              << config.num_lines << (tile_frames ? " or larger" : "") << ": "
+              << imagePath << std::endl;
+    return 1;
+  }
 
   // ========================================================================
   // VARIABLE INITIALIZATION
   // ========================================================================
 
-  // Pixel processing variables
-  int pos = 0;           // Position in current memory line (0-7)
-  uint64_t pix = 0;      // Current pixel value
-  u64 mem_line = 0;      // 64-bit memory line (8 pixels)
-  u32 mem_line_32b = 0;  // 32-bit memory line for feature data
-  int y = 0, x = 0;      // Image coordinates
-
-  // Timing measurement
-  auto start = std::chrono::high_resolution_clock::now();
-  auto stop = std::chrono::high_resolution_clock::now();
-  auto timer =
-      std::chrono::duration_cast<std::chrono::microseconds>(stop - stop);
-
-  // DMA instruction (declared but not used in current version)
-  dma_instr_t instruction;
-
-  // Feature descriptor parsing variables
-  uint16_t descriptor_pos_x[2] = {0};
-  uint16_t descriptor_pos_y[2] = {0};
-  uint16_t descriptor_score[2] = {0};
-  uint16_t descriptor_angle[2] = {0};
-  uint16_t descriptor_quadrant[2] = {0};
-  uint16_t descriptor_theta[2] = {0};
-  uint16_t descriptor_scale[2] = {0};
-  float descriptor_orientation[2] = {0};
-  uint32_t partial_descriptor = 0;
-
-  // Unused variables (kept for compatibility)
-  float offset = 0;
-  float invert = 0;
-  int extra = 0;
+  KeypointBatch batch;
+  int threshold = corner_thresh;
 
   // ========================================================================
-  // FPGA HARDWARE INITIALIZATION SEQUENCE
+  // FRAME PROCESSING
   // ========================================================================
 
-  // Initialize input buffer
-  _in_buffer[0] = 0;
+  // Automatic threshold: rerun the image until the threshold settles, then
+  // time a run with it
+  if (target_features > 0) {
+    ThresholdControlConfig control;
+    control.target = target_features;
+    ThresholdController controller(control, corner_thresh);
+    for (int run = 0; run < THRESHOLD_SETTLE_RUNS; run++) {
+      threshold = controller.threshold();
+      accelerator->set_thresholds(threshold, -threshold);
+      if (detect_frame(accelerator, grayImage, &batch) < 0) {
+        std::cerr << "Accelerator failed on: " << imagePath << std::endl;
+        return 1;
+      }
+      if (controller.update(batch, accelerator->overflowed()) == threshold) {
+        break;
+      }
+    }
+    threshold = controller.threshold();
+    accelerator->set_thresholds(threshold, -threshold);
+    std::cout << "Automatic threshold: " << threshold << std::endl;
+  }
 
-  // FPGA reset sequence
-  _reset_ptr[0] = 0;  // Reset low
-  *index = 1;         // Reset buffer index to 1
-  _reset_ptr[0] = 1;  // Reset high (activate)
-  // Frame memory initialization - FPGA BRAM clear
-  for (int i = 0; i < (MEM_SIZE_PIX / MEM_LINE_SIZE_PIX); i++) {
-    _bram_ptr[i] = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  if (detect_frame(accelerator, grayImage, &batch) < 0) {
+    std::cerr << "Accelerator failed on: " << imagePath << std::endl;
+    return 1;
+  }
+  auto stop = std::chrono::high_resolution_clock::now();
+  std::cout << "Processing time: "
+            << std::chrono::duration_cast<std::chrono::microseconds>(stop -
+                                                                     start)
+                   .count()
+            << " us" << std::endl;
+  if (accelerator->overflowed()) {
+    std::cout << "Selection cells full, the weakest keypoints were dropped"
+              << std::endl;
   }
 
-  // Configure ORB corner detection thresholds
-  _corner_thresh_ptr[0] = static_cast<uint64_t>(corner_thresh);
-  _corner_thresh_ptr[1] = static_cast<uint64_t>(corner_thresh_n);
+  const OrbDmaStats &dma_stats = accelerator->dma_stats();
+  if (dma_stats.transfers > 0) {
+    double slowest = 0;
+    for (size_t i = 0; i < dma_stats.transfer_us.size(); i++) {
+      slowest = std::max(slowest, dma_stats.transfer_us[i]);
+    }
+    std::cout << "DMA: " << dma_stats.transfers << " transfers, "
+              << dma_stats.bytes << " bytes, slowest " << slowest
+              << " us, stalled " << dma_stats.stall_us << " us" << std::endl;
+  }
+  print_metrics(accelerator->metrics(), 1);
+  if (!metrics_path.empty()) {
+    FrameMetricsWriter metrics;
+    if (metrics.open(metrics_path) < 0 ||
+        metrics.write(0, 0, accelerator->metrics()) < 0 ||
+        metrics.close() < 0) {
+      std::cerr << "Could not write the frame metrics: " << metrics_path
+                << std::endl;
+      return 1;
+    }
+  }
 
   // ========================================================================
-  // PIXEL STREAMING TO FPGA
+  // IMAGE NORMALIZATION FOR VISUALIZATION
   // ========================================================================
 
-  // Stream image pixels to FPGA in 8-pixel chunks
-  for (y = 0; y < NUM_LINES; y++) {
-    for (x = 0; x < LINE_SIZE; x++) {
-      // Extract pixel value
-      pix = static_cast<uint64_t>(grayImage.at<uchar>(y, x));
-
-      // Pack pixel into memory line (8 pixels per 64-bit word)
-      mem_line |= (pix & 0xFF) << (pos * 8);
-
-      if (pos < 7) {
-        pos++;
-      } else {
-        pos = 0;
-
-        // Write to both input buffer and BRAM simultaneously
-        _in_buffer[*index] = mem_line;
-        _bram_ptr[*index] = mem_line;
-        mem_line = 0;
-        ++*index;
-
-        // Check if buffer is full and trigger FPGA processing
-        if (*index == MEM_SIZE_PIX / MEM_LINE_SIZE_PIX + 1) {
-          // Brief delay before triggering FPGA
-          usleep(100);
-
-          // FPGA TRIGGER SEQUENCE
-          start = std::chrono::high_resolution_clock::now();
-          _bram_ptr[0] = 1;            // Trigger FPGA processing
-          while (_bram_ptr[0] == 1) {  // Wait for completion
-                                       // FPGA sets this to 0 when done
-          }
-          stop = std::chrono::high_resolution_clock::now();
-          timer += std::chrono::duration_cast<std::chrono::microseconds>(stop -
-                                                                         start);
-
-          *index = 1;  // Reset buffer index
-        }
+  if (write_output) {
+    coloredImage.create(grayImage.rows, grayImage.cols, CV_8UC3);
+
+    // Find intensity range for normalization
+    int minValue = 255, maxValue = 0;
+    for (int y = 0; y < grayImage.rows; ++y) {
+      for (int x = 0; x < grayImage.cols; ++x) {
+        int pixelValue = static_cast<int>(grayImage.at<uchar>(y, x));
+        minValue = std::min(minValue, pixelValue);
+        maxValue = std::max(maxValue, pixelValue);
       }
     }
-  }
 
-  // Handle any remaining data in buffer
-  if (_bram_ptr[0] == 0) {
-    start = std::chrono::high_resolution_clock::now();
-    _bram_ptr[0] = 1;            // Final trigger
-    while (_bram_ptr[0] == 1) {  // Wait for completion
-                                 // FPGA processing final batch
+    // Handle edge case: uniform intensity
+    if (minValue == maxValue) {
+      minValue = 0;
+      maxValue = 255;
     }
-    stop = std::chrono::high_resolution_clock::now();
-    timer +=
-        std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
-  }
 
-  // Wait for all FPGA operations to complete
-  usleep(10000);
+    // Normalize and create base visualization image
+    for (int y = 0; y < grayImage.rows; ++y) {
+      for (int x = 0; x < grayImage.cols; ++x) {
+        int pixelValue = static_cast<int>(grayImage.at<uchar>(y, x));
+        uchar normalizedValue = static_cast<uchar>(
+            255 * (pixelValue - minValue) / (maxValue - minValue));
+        coloredImage.at<cv::Vec3b>(y, x) =
+            cv::Vec3b(normalizedValue, normalizedValue, normalizedValue);
+      }
+    }
+  }
 
   // ========================================================================
-  // IMAGE NORMALIZATION FOR VISUALIZATION
+  // FEATURE DISPLAY
   // ========================================================================
 
-  // Find intensity range for normalization
-  int minValue = 255, maxValue = 0;
-  for (int y = 0; y < NUM_LINES; ++y) {
-    for (int x = 0; x < LINE_SIZE; ++x) {
-      int pixelValue = static_cast<int>(grayImage.at<uchar>(y, x));
-      minValue = std::min(minValue, pixelValue);
-      maxValue = std::max(maxValue, pixelValue);
+  int descriptor_count = batch.count;
+  if (log_path.empty()) {
+    print_keypoints(batch);
+  } else {
+    KeypointLogWriter log;
+    if (log.open(log_path, false) < 0 || log.write(0, 0, batch) < 0 ||
+        log.close() < 0) {
+      std::cerr << "Could not write the keypoint log: " << log_path
+                << std::endl;
+      return 1;
     }
+    std::cout << "Keypoints logged to: " << log_path << std::endl;
   }
 
-  // Handle edge case: uniform intensity
-  if (minValue == maxValue) {
-    minValue = 0;
-    maxValue = 255;
+  // Mark feature locations in visualization (green dots)
+  for (int i = 0; write_output && i < descriptor_count; i++) {
+    if (batch.y[i] < grayImage.rows && batch.x[i] < grayImage.cols) {
+      coloredImage.at<cv::Vec3b>(batch.y[i], batch.x[i]) =
+          cv::Vec3b(0, 255, 0);
+    }
   }
 
-  // Normalize and create base visualization image
-  for (int y = 0; y < NUM_LINES; ++y) {
-    for (int x = 0; x < LINE_SIZE; ++x) {
-      int pixelValue = static_cast<int>(grayImage.at<uchar>(y, x));
-      uchar normalizedValue = static_cast<uchar>(255 * (pixelValue - minValue) /
-                                                 (maxValue - minValue));
-      coloredImage.at<cv::Vec3b>(y, x) =
-          cv::Vec3b(normalizedValue, normalizedValue, normalizedValue);
-    }
+  // ========================================================================
+  // OUTPUT GENERATION
+  // ========================================================================
+
+  // Generate descriptive filename
+  std::string out_filename = "features_image" + std::to_string(threshold) +
+                             "[" + std::to_string(descriptor_count) + "]" +
+                             ".bmp";
+
+  std::cout << "Found " << descriptor_count << " features" << std::endl;
+
+  // Save annotated image
+  if (write_output) {
+    cv::imwrite(out_filename, coloredImage);
+    std::cout << "Output saved as: " << out_filename << std::endl;
   }
 
+  return 0;
+}
+
+int process_stream(OrbAccelerator *accelerator, const std::string &input) {
   // ========================================================================
-  // FEATURE DESCRIPTOR EXTRACTION FROM FPGA MEMORY
+  // FRAME SOURCE
   // ========================================================================
 
-  int descriptor_count = 0;
+  FrameSource source;
+  struct stat info;
 
-  // Read feature descriptors from FPGA memory
-  // sequence
-  for (int i = 0; i < FEAT_MEM_LINES - 1; i++) {
-    // Read position data from FPGA memory
-    mem_line_32b = _descripts_pos_ptr[i];
-    if (mem_line_32b == 0) {
-      break;  // End of valid features
-    }
+  if (stat(input.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+    cv::glob(input + "/*", source.paths);
+  } else if (input.find_first_of("*?[") != std::string::npos) {
+    cv::glob(input, source.paths);
+  } else if (!source.capture.open(input)) {
+    std::cerr << "Could not open the video: " << input << std::endl;
+    return 1;
+  }
+  std::sort(source.paths.begin(), source.paths.end());
 
-    descriptor_count++;
+  // ========================================================================
+  // STREAMING
+  // ========================================================================
 
-    // Extract position coordinates (Y:upper 16 bits, X:lower 16 bits)
-    descriptor_pos_y[0] =
-        static_cast<uint16_t>((0xFFFF0000 & mem_line_32b) >> 16);
-    descriptor_pos_x[0] = static_cast<uint16_t>((0x0000FFFF & mem_line_32b));
+  // Frames go round decode -> accelerate -> consume -> decode, so decoding
+  // of the next frames overlaps with the accelerator and the consumer
+  std::vector<StreamFrame> frames(PIPELINE_FRAMES);
+  SpscQueue<StreamFrame *> free_frames(PIPELINE_FRAMES);
+  SpscQueue<StreamFrame *> decoded(PIPELINE_FRAMES);
+  SpscQueue<StreamFrame *> detected(PIPELINE_FRAMES);
+  for (size_t i = 0; i < frames.size(); i++) {
+    free_frames.push(&frames[i]);
+  }
 
-    // Read score and angle data from FPGA memory
-    mem_line_32b = _descripts_scr_angle_ptr[i];
-    descriptor_score[0] =
-        static_cast<uint16_t>((0x0FFF0000 & mem_line_32b) >> 16);
-    descriptor_angle[0] = static_cast<uint16_t>((0x0000FFFF & mem_line_32b));
-    descriptor_theta[0] = static_cast<uint16_t>((0x00000003 & mem_line_32b));
-    descriptor_quadrant[0] =
-        static_cast<uint16_t>((0x0000000C & mem_line_32b) >> 2);
-    descriptor_scale[0] =
-        static_cast<uint16_t>((0xC0000000 & mem_line_32b) >> 30);
+  std::vector<double> latencies;
+  std::vector<double> match_times;
+  std::vector<double> track_times;
+  int result = 0;
+  StreamFrame *frame;
+
+  // Keypoints of the previous frame, the train set of --host-match
+  HammingMatcherConfig match_config;
+  match_config.cross_check = true;
+  HammingMatcher matcher(match_config);
+  KeypointBatch previous;
+  std::vector<DescriptorPair> pairs;
+  KeypointTracker tracker;
+
+  // Written from its own thread, the consumer only copies each batch
+  KeypointLogWriter log;
+  if (!log_path.empty() && log.open(log_path, true) < 0) {
+    std::cerr << "Could not create the keypoint log: " << log_path
+              << std::endl;
+    return 1;
+  }
+  FrameMetricsWriter metrics;
+  OrbFrameMetrics total;
+  if (!metrics_path.empty() && metrics.open(metrics_path) < 0) {
+    std::cerr << "Could not create the frame metrics: " << metrics_path
+              << std::endl;
+    return 1;
+  }
 
-    // Calculate feature orientation
-    descriptor_orientation[0] =
-        get_orientation(descriptor_quadrant[0], descriptor_theta[0]);
+  std::unique_ptr<ThresholdController> controller;
+  if (target_features > 0) {
+    ThresholdControlConfig control;
+    control.target = target_features;
+    controller.reset(new ThresholdController(control, corner_thresh));
+    accelerator->set_thresholds(controller->threshold(),
+                                -controller->threshold());
+  }
 
-    // Display feature information
-    std::cout << std::dec << "(" << descriptor_pos_y[0] << ","
-              << descriptor_pos_x[0] << ") "
-              << "score:" << descriptor_score[0]
-              << " orientation:" << descriptor_orientation[0]
-              << "° quadrant: " << descriptor_quadrant[0]
-              << " theta: " << descriptor_theta[0]
-              << " scale: " << descriptor_scale[0] << std::endl;
-
-    // Display binary descriptor data
-    for (int section = 1; section >= 0; section--) {
-      for (int component = 3; component >= 0; component--) {
-        partial_descriptor =
-            static_cast<uint32_t>(_descripts_ptr[section][i * 4 + component]);
-        std::cout << std::hex << std::setw(8) << std::setfill('0')
-                  << partial_descriptor;
-      }
+  auto first = std::chrono::high_resolution_clock::now();
+  std::thread decoder(decode_stage, accelerator, &source, &free_frames,
+                      &decoded);
+  std::thread detector(accelerate_stage, accelerator, controller.get(),
+                       &decoded, &detected);
+
+  while (detected.pop(&frame)) {
+    auto output_start = std::chrono::high_resolution_clock::now();
+    if (frame->count < 0) {
+      std::cerr << "Accelerator failed on frame " << latencies.size()
+                << std::endl;
+      result = 1;
+      break;
     }
-    std::cout << std::dec << std::endl;  // Reset to decimal
 
-    // Mark feature locations in visualization (green dots)
-    // Note: Only descriptor_pos_y[0] and descriptor_pos_x[0] are valid
-    if (descriptor_pos_y[0] < NUM_LINES && descriptor_pos_x[0] < LINE_SIZE) {
-      coloredImage.at<cv::Vec3b>(descriptor_pos_y[0], descriptor_pos_x[0]) =
-          cv::Vec3b(0, 255, 0);
+    latencies.push_back(frame->accel_us);
+    std::cout << "frame " << latencies.size() - 1 << ": " << frame->count
+              << " features, " << static_cast<int>(frame->accel_us) << " us";
+    if (controller) std::cout << ", threshold " << frame->threshold;
+    if (frame->matched >= 0) std::cout << ", " << frame->matched << " matched";
+    if (host_match && latencies.size() > 1) {
+      auto start = std::chrono::high_resolution_clock::now();
+      int matched = matcher.match(frame->batch, previous, &pairs);
+      auto stop = std::chrono::high_resolution_clock::now();
+      match_times.push_back(
+          std::chrono::duration<double, std::micro>(stop - start).count());
+      std::cout << ", " << matched << " host matches in "
+                << static_cast<int>(match_times.back()) << " us";
+    }
+    if (host_match) previous = frame->batch;
+    if (track_keypoints) {
+      auto start = std::chrono::high_resolution_clock::now();
+      int tracked = tracker.update(frame->batch);
+      auto stop = std::chrono::high_resolution_clock::now();
+      track_times.push_back(
+          std::chrono::duration<double, std::micro>(stop - start).count());
+      std::cout << ", " << tracked << " tracked in "
+                << static_cast<int>(track_times.back()) << " us";
+    }
+    uint64_t frame_id = latencies.size() - 1;
+    if (!log_path.empty() &&
+        log.write(frame_id, frame->timestamp_ns, frame->batch) < 0) {
+      std::cerr << "Could not write the keypoint log: " << log_path
+                << std::endl;
+      result = 1;
+      break;
+    }
+    std::cout << (frame->overflowed ? " (overflow)" : "") << std::endl;
+    frame->metrics.output_us = std::chrono::duration<double, std::micro>(
+                                   std::chrono::high_resolution_clock::now() -
+                                   output_start)
+                                   .count();
+    total.add(frame->metrics);
+    if (!metrics_path.empty() &&
+        metrics.write(frame_id, frame->timestamp_ns, frame->metrics) < 0) {
+      std::cerr << "Could not write the frame metrics: " << metrics_path
+                << std::endl;
+      result = 1;
+      break;
     }
-    // descriptor_pos_y[1] and descriptor_pos_x[1] are not set, so skip them
+    free_frames.push(frame);
   }
+  auto last = std::chrono::high_resolution_clock::now();
+
+  // Stops the other stages early on error, no-op at the end of the stream
+  free_frames.close();
+  decoded.close();
+  decoder.join();
+  detector.join();
+  if (!log_path.empty() && log.close() < 0) result = 1;
+  if (!metrics_path.empty() && metrics.close() < 0) result = 1;
+  if (result != 0) return result;
 
   // ========================================================================
-  // OUTPUT GENERATION
+  // STATISTICS
   // ========================================================================
 
-  // Generate descriptive filename
-  std::string out_filename = "features_image" + std::to_string(corner_thresh) +
-                             "[" + std::to_string(descriptor_count) + "]" +
-                             ".bmp";
-
-  // Save annotated image
-  cv::imwrite(out_filename, coloredImage);
+  if (latencies.empty()) {
+    std::cerr << "No frames in: " << input << std::endl;
+    return 1;
+  }
 
-  std::cout << "Found " << descriptor_count << " features" << std::endl;
-  std::cout << "Output saved as: " << out_filename << std::endl;
+  double seconds = std::chrono::duration<double>(last - first).count();
+  double busy_us = std::accumulate(latencies.begin(), latencies.end(), 0.0);
+  size_t count = latencies.size();
+  std::sort(latencies.begin(), latencies.end());
+
+  // Wall clock fps is bound by the slowest stage, ideally the accelerator
+  std::cout << "Frames: " << count << ", " << count / seconds
+            << " fps (accelerator only: " << count * 1e6 / busy_us << " fps)"
+            << std::endl;
+  std::cout << "Latency us: p50 " << latencies[(count - 1) * 50 / 100]
+            << ", p90 " << latencies[(count - 1) * 90 / 100] << ", p99 "
+            << latencies[(count - 1) * 99 / 100] << ", max "
+            << latencies[count - 1] << std::endl;
+  if (!match_times.empty()) {
+    std::cout << "Host matching us: mean "
+              << std::accumulate(match_times.begin(), match_times.end(), 0.0) /
+                     match_times.size()
+              << ", max "
+              << *std::max_element(match_times.begin(), match_times.end())
+              << " (" << matcher.config().threads << " threads)"
+              << std::endl;
+  }
+  if (!track_times.empty()) {
+    std::cout << "Tracking us: mean "
+              << std::accumulate(track_times.begin(), track_times.end(), 0.0) /
+                     track_times.size()
+              << ", max "
+              << *std::max_element(track_times.begin(), track_times.end())
+              << std::endl;
+  }
+  if (!log_path.empty()) {
+    std::cout << "Log: " << log.frames() << " frames, "
+              << log.bytes() / 1e6 << " MB, writer behind for "
+              << log.stall_us() / 1000 << " ms" << std::endl;
+  }
+  print_metrics(total, count);
+  print_queue("decode", "accelerate", decoded.stats());
+  print_queue("accelerate", "consume", detected.stats());
+  print_queue("consume", "decode", free_frames.stats());
 
   return 0;
 }
 
-// ============================================================================
-// UTILITY FUNCTIONS
-// ============================================================================
+bool FrameSource::read(cv::Mat *frame) {
+  while (true) {
+    if (capture.isOpened()) return capture.read(*frame);
+    if (next_path == paths.size()) return false;
+    *frame = cv::imread(paths[next_path++], cv::IMREAD_GRAYSCALE);
+    if (!frame->empty()) return true;
+  }
+}
 
-/**
- * @brief Convert FPGA quadrant and theta values to orientation angle
- *
- * The FPGA ORB implementation encodes feature orientation using:
- * - quadrant: Which 90-degree quadrant (0-3)
- * - theta: Fine angle within the quadrant
- *
- * This function reconstructs the full orientation angle in degrees.
- * Formula: theta * (90/4) - (90/4/2) = theta * 22.5 - 11.25
- *
- * @param quadrant Quadrant identifier (0-3)
- * @param theta Theta value within the quadrant
- * @return Orientation angle in degrees (0-360)
- */
-float get_orientation(uint16_t quadrant, uint16_t theta) {
-  float invert = 1;
-  float offset = 0;
-  float degree = 0;
-
-  switch (quadrant) {
-    case 0:
-      offset = 0;
-      invert = 1;
-      break;
-    case 1:
-      offset = 180;
-      invert = -1;
-      break;
-    case 2:
-      offset = 180;
-      invert = 1;
-      break;
-    case 3:
-      offset = 360;
-      invert = -1;
-      break;
-    default:
-      offset = 0;
-      invert = 1;
-      break;
+bool is_tiled(const OrbAccelerator *accelerator, const cv::Mat &gray) {
+  const OrbAcceleratorConfig &config = accelerator->config();
+  return tile_frames && gray.cols >= config.line_size &&
+         gray.rows >= config.num_lines &&
+         (gray.cols != config.line_size || gray.rows != config.num_lines);
+}
+
+int detect_frame(OrbAccelerator *accelerator, const cv::Mat &gray,
+                 KeypointBatch *batch) {
+  if (is_tiled(accelerator, gray)) {
+    return accelerator->detect_tiled(gray.ptr<uint8_t>(0),
+                                     static_cast<int>(gray.step), gray.cols,
+                                     gray.rows, batch);
+  }
+  return accelerator->detect(gray.ptr<uint8_t>(0), static_cast<int>(gray.step),
+                             batch);
+}
+
+void decode_stage(const OrbAccelerator *accelerator, FrameSource *source,
+                  SpscQueue<StreamFrame *> *free_frames,
+                  SpscQueue<StreamFrame *> *decoded) {
+  cv::Size size(accelerator->config().line_size,
+                accelerator->config().num_lines);
+  StreamFrame *frame;
+
+  while (free_frames->pop(&frame)) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!source->read(&frame->frame)) break;
+    frame->timestamp_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    if (frame->frame.channels() == 3) {
+      cv::cvtColor(frame->frame, frame->gray, cv::COLOR_BGR2GRAY);
+    } else {
+      frame->gray = frame->frame;
+    }
+    if (frame->gray.size() != size && !is_tiled(accelerator, frame->gray)) {
+      cv::resize(frame->gray, frame->gray, size);
+    }
+    frame->metrics.decode_us = std::chrono::duration<double, std::micro>(
+                                   std::chrono::high_resolution_clock::now() -
+                                   start)
+                                   .count();
+    if (!decoded->push(frame)) break;
+  }
+  decoded->close();
+}
+
+void accelerate_stage(OrbAccelerator *accelerator,
+                      ThresholdController *controller,
+                      SpscQueue<StreamFrame *> *decoded,
+                      SpscQueue<StreamFrame *> *detected) {
+  StreamFrame *frame;
+  bool have_references = false;
+
+  while (decoded->pop(&frame)) {
+    frame->threshold = controller ? controller->threshold() : corner_thresh;
+    auto start = std::chrono::high_resolution_clock::now();
+    frame->count = detect_frame(accelerator, frame->gray, &frame->batch);
+    auto stop = std::chrono::high_resolution_clock::now();
+    frame->accel_us =
+        std::chrono::duration<double, std::micro>(stop - start).count();
+    frame->overflowed = accelerator->overflowed();
+    double decode_us = frame->metrics.decode_us;
+    frame->metrics = accelerator->metrics();
+    frame->metrics.decode_us = decode_us;
+
+    // The thresholds of the next frame, before the consumer owns the batch
+    if (controller && frame->count >= 0) {
+      int next = controller->update(frame->batch, frame->overflowed);
+      accelerator->set_thresholds(next, -next);
+    }
+    frame->matched = -1;
+    if (match_frames && frame->count >= 0) {
+      have_references = match_frame(accelerator, have_references, frame);
+    }
+    if (!detected->push(frame) || frame->count < 0) break;
+  }
+  detected->close();
+}
+
+bool match_frame(OrbAccelerator *accelerator, bool have_references,
+                 StreamFrame *frame) {
+  if (have_references && !is_tiled(accelerator, frame->gray) &&
+      accelerator->read_matches(&frame->matches) >= 0) {
+    frame->matched = 0;
+    for (size_t i = 0; i < frame->matches.size(); i++) {
+      const KeypointMatch &match = frame->matches[i];
+      if (match.best >= 0 && match.best_distance <= MATCH_MAX_DISTANCE) {
+        frame->matched++;
+      }
+    }
   }
 
-  // Convert theta to degrees within quadrant
-  degree = static_cast<float>(theta * 90 / 4 - 90 / 4 / 2);
+  // The batch is by decreasing score, its head is the strongest keypoints
+  return accelerator->load_references(frame->batch.descriptors.data(),
+                                      frame->batch.count) >= 0;
+}
+
+void print_queue(const char *producer, const char *consumer,
+                 const SpscQueueStats &stats) {
+  std::cout << "Queue " << producer << " -> " << consumer << ": depth max "
+            << stats.max_depth << ", mean " << stats.mean_depth() << "; "
+            << producer << " blocked " << stats.push_stall_us / 1000 << " ms, "
+            << consumer << " blocked " << stats.pop_stall_us / 1000 << " ms"
+            << std::endl;
+}
+
+bool is_single_image(const std::string &input) {
+  static const char *const video_extensions[] = {".avi", ".mp4", ".mkv",
+                                                 ".mov", ".webm", ".h264"};
+  struct stat info;
+
+  if (input.compare(0, 10, "/dev/video") == 0) return false;
+  if (stat(input.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) return false;
+  if (input.find_first_of("*?[") != std::string::npos) return false;
+
+  std::string extension =
+      input.substr(std::min(input.rfind('.'), input.size()));
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 ::tolower);
+  for (size_t i = 0; i < sizeof(video_extensions) / sizeof(*video_extensions);
+       i++) {
+    if (extension == video_extensions[i]) return false;
+  }
+  return true;
+}
 
-  // Apply quadrant transformation
-  return static_cast<float>(degree * invert + offset);
+void print_keypoints(const KeypointBatch &batch) {
+  for (int i = 0; i < batch.count; i++) {
+    // Display feature information
+    std::cout << std::dec << "(" << batch.y[i] << "," << batch.x[i] << ") "
+              << "score:" << batch.score[i]
+              << " orientation:" << batch.orientation(i)
+              << "° quadrant: " << batch.quadrant(i)
+              << " theta: " << batch.theta(i)
+              << " scale: " << static_cast<int>(batch.scale[i]) << '\n';
+
+    // Display binary descriptor data, most significant word first
+    const uint8_t *descriptor = batch.descriptor(i);
+    for (int word = DESCRIPTOR_BYTES / 4 - 1; word >= 0; word--) {
+      uint32_t partial_descriptor;
+      memcpy(&partial_descriptor, descriptor + word * 4, 4);
+      std::cout << std::hex << std::setw(8) << std::setfill('0')
+                << partial_descriptor;
+    }
+    std::cout << std::dec << '\n';  // Reset to decimal
+  }
+  std::cout.flush();
+}
+
+void print_metrics(const OrbFrameMetrics &total, size_t frames) {
+  double n = static_cast<double>(frames);
+  std::cout << "Stages us per frame: decode " << total.decode_us / n
+            << ", pack " << total.pack_us / n << ", upload "
+            << total.upload_us / n << ", wait " << total.wait_us / n
+            << ", readback " << total.readback_us / n << ", output "
+            << total.output_us / n << " (bound: " << frame_bound(total) << ")"
+            << std::endl;
+  if (!total.has_counters) return;
+
+  // The fabric runs at 100 MHz, 100 cycles per us
+  const OrbPerfCounters &counters = total.counters;
+  double fed = counters.stream_cycles > 0
+                   ? 100.0 * counters.pixels / counters.stream_cycles
+                   : 0;
+  std::cout << "Fabric per frame: " << counters.pixels / n << " pixels in "
+            << counters.stream_cycles / n << " cycles (" << fed
+            << "% fed), drain " << counters.drain_cycles / n / 100
+            << " us, " << counters.candidates / n << " candidates, "
+            << counters.survivors / n << " survivors, "
+            << counters.descriptors / n << " descriptors, dropped "
+            << counters.fifo_dropped / n << " on a full FIFO and "
+            << counters.busy_dropped / n << " on a busy constructor"
+            << std::endl;
+  // Levels past the pyramid never queue a feature
+  for (int level = 0; level < PERF_LEVELS; level++) {
+    if (counters.fifo_high_water[level] == 0) continue;
+    std::cout << "Level " << level << ": FIFO high water "
+              << counters.fifo_high_water[level] << ", dropped "
+              << counters.level_fifo_dropped[level] / n
+              << " on a full FIFO and "
+              << counters.level_busy_dropped[level] / n
+              << " on a busy constructor per frame" << std::endl;
+  }
 }
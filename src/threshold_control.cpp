@@ -0,0 +1,72 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file threshold_control.cpp
+ * @brief FAST threshold set per frame to track a target keypoint count
+ */
+
+#include "threshold_control.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+ThresholdController::ThresholdController(const ThresholdControlConfig &config,
+                                         int initial)
+    : config_(config),
+      threshold_(initial),
+      last_error_(0),
+      first_(true),
+      histogram_(FAST_SCORE_MAX + 1) {
+  config_.target = std::max(config_.target, 1);
+  config_.max_thresh = std::min(config_.max_thresh, THRESHOLD_MAX);
+  config_.min_thresh = std::min(config_.min_thresh, config_.max_thresh);
+  threshold_ = clamp(threshold_);
+}
+
+double ThresholdController::clamp(double thresh) const {
+  return std::min(std::max(thresh, static_cast<double>(config_.min_thresh)),
+                  static_cast<double>(config_.max_thresh));
+}
+
+int ThresholdController::threshold() const {
+  return static_cast<int>(lround(threshold_));
+}
+
+int ThresholdController::update(const KeypointBatch &batch, bool overflowed) {
+  // An empty frame counts as half a keypoint, so the error stays finite
+  double count = batch.count > 0 ? batch.count : 0.5;
+  double error = log2(count / config_.target);
+  if (overflowed) error += 1;
+
+  // Octaves of threshold, the same loop gain at any contrast
+  double step = config_.ki * error;
+  if (!first_) step += config_.kp * (error - last_error_);
+  double next = threshold_ * exp2(step);
+  if (error > 0) next = std::max(next, histogram_threshold(batch));
+
+  threshold_ = clamp(next);
+  last_error_ = error;
+  first_ = false;
+  return threshold();
+}
+
+/**
+ * @brief Threshold that would leave about target keypoints of the frame
+ *
+ * Read from the score histogram, the score of the target-th strongest
+ * keypoint over FAST_CIRCLE_PIXELS. 0 if the frame has fewer keypoints.
+ */
+double ThresholdController::histogram_threshold(const KeypointBatch &batch) {
+  std::fill(histogram_.begin(), histogram_.end(), 0);
+  for (int i = 0; i < batch.count; i++) histogram_[batch.score[i]]++;
+
+  int stronger = 0;
+  for (int score = FAST_SCORE_MAX; score > 0; score--) {
+    stronger += histogram_[score];
+    if (stronger >= config_.target) {
+      return static_cast<double>(score) / FAST_CIRCLE_PIXELS;
+    }
+  }
+  return 0;
+}
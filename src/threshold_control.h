@@ -0,0 +1,95 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file threshold_control.h
+ * @brief FAST threshold set per frame to track a target keypoint count
+ *
+ * The keypoint count of a frame falls roughly exponentially as the FAST
+ * threshold rises, so ThresholdController runs a PI controller on the log2
+ * of the count over the target and writes the result to both thresholds of
+ * the next frame. Steps are octaves of threshold, so the loop gain does not
+ * change with the contrast of the scene.
+ *
+ * With too many keypoints the score histogram of the frame also gives a
+ * direct estimate: the keypoint of rank n scores about FAST_CIRCLE_PIXELS
+ * times the threshold that leaves n keypoints, as each of the 16 circle
+ * pixels then differs from the centre by about the threshold. The
+ * threshold jumps to that estimate when it is above the PI step, which
+ * recovers from an overflowing frame in one or two frames.
+ */
+
+#ifndef THRESHOLD_CONTROL_H
+#define THRESHOLD_CONTROL_H
+
+#include <vector>
+
+#include "keypoint_batch.h"
+
+#define FAST_CIRCLE_PIXELS 16  // Pixels summed into the FAST score
+#define FAST_SCORE_MAX 4095    // 12-bit feature_score
+#define THRESHOLD_MAX 255      // Largest value of the signed 9-bit registers
+
+/**
+ * @brief Controller gains and limits
+ *
+ * Gains are in octaves of threshold per octave of error, i.e. per factor of
+ * two between the count and the target.
+ */
+struct ThresholdControlConfig {
+  int target;      // Keypoints wanted per frame
+  double kp;       // Proportional gain, on the change of the error
+  double ki;       // Integral gain, on the error of each frame
+  int min_thresh;  // Lowest threshold
+  int max_thresh;  // Highest threshold, at most THRESHOLD_MAX
+
+  ThresholdControlConfig()
+      : target(300),
+        kp(0.02),
+        ki(0.06),
+        min_thresh(1),
+        max_thresh(THRESHOLD_MAX) {}
+};
+
+class ThresholdController {
+ public:
+  /**
+   * @param initial Threshold of the first frame
+   */
+  ThresholdController(const ThresholdControlConfig &config, int initial);
+
+  /**
+   * @brief Threshold for the next frame; corner_thresh_n is its negation
+   */
+  int threshold() const;
+
+  /**
+   * @brief Account for a frame processed with threshold()
+   *
+   * Velocity form of the PI controller: the step is kp times the change of
+   * the error plus ki times the error, and the threshold is clamped, so the
+   * integral cannot wind up. On overflow the count is saturated and the
+   * error is taken an octave higher. With a positive error the threshold
+   * goes at least to the estimate of the score histogram.
+   * @param batch Keypoints of the frame
+   * @param overflowed Whether the selection cells of the frame were full
+   * @return Threshold for the next frame
+   */
+  int update(const KeypointBatch &batch, bool overflowed);
+
+  /**
+   * @brief Error of the last frame, log2 of its count over the target
+   */
+  double error() const { return last_error_; }
+
+ private:
+  double clamp(double thresh) const;
+  double histogram_threshold(const KeypointBatch &batch);
+
+  ThresholdControlConfig config_;
+  double threshold_;
+  double last_error_;
+  bool first_;
+  std::vector<int> histogram_;  // Keypoints per score
+};
+
+#endif  // THRESHOLD_CONTROL_H
@@ -0,0 +1,176 @@
+/**
+ * Copyright 2025 INES-ID
+ *
+ * @file tool_common.h
+ * @brief Pieces shared by the command line tools
+ *
+ * The bitstream configuration next to the binary, comma separated option
+ * lists and the --out results file, written as CSV or, for a name ending in
+ * .json, as JSON Lines. test_fast_zybo, bench_orb, orb_accuracy and
+ * fifo_sizing take them from here so their options behave the same.
+ */
+
+#ifndef TOOL_COMMON_H
+#define TOOL_COMMON_H
+
+#include <math.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "orb_accelerator.h"
+
+// Geometry of the bitstream, written next to it by gen_bit-bin.sh
+#define BITSTREAM_CONFIG "ORB_writeDescriptHold.cfg"
+
+// Usage line of the --out option of every tool
+#define RESULTS_OUT_USAGE \
+  "  --out: Results file, JSON Lines if it ends in .json, else CSV"
+
+/**
+ * @brief Load the configuration of the bitstream
+ * @param path File to read; if empty, BITSTREAM_CONFIG when present, and
+ *             set to it
+ * @param config Configuration to fill, left at its defaults without a file
+ * @return 0 on success or without a file, -1 if the file can not be read
+ */
+static inline int load_bitstream_config(std::string *path,
+                                        OrbAcceleratorConfig *config) {
+  struct stat info;
+  if (path->empty() && stat(BITSTREAM_CONFIG, &info) == 0) {
+    *path = BITSTREAM_CONFIG;
+  }
+  if (!path->empty() && orb_config_load(*path, config) != 0) {
+    std::cerr << "Could not read the configuration: " << *path << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Items of a comma separated list, empty ones skipped
+ */
+static inline std::vector<std::string> split_list(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+/**
+ * @brief Whether a results file is written as JSON Lines
+ */
+static inline bool results_json(const std::string &path) {
+  const std::string suffix = ".json";
+  return path.size() >= suffix.size() &&
+         path.compare(path.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+/**
+ * @brief Results file of named fields, one record per line
+ *
+ * A CSV file gets its header from the field names of the first record. A
+ * NAN number is an empty CSV field and is left out of a JSON record.
+ */
+class RecordWriter {
+ public:
+  RecordWriter() : file_(NULL), json_(false), rows_(0) {}
+  ~RecordWriter() { close(); }
+  RecordWriter(const RecordWriter &) = delete;
+  RecordWriter &operator=(const RecordWriter &) = delete;
+
+  /**
+   * @brief Create the file
+   * @return 0 on success, -1 on error, reported with perror
+   */
+  int open(const std::string &path) {
+    json_ = results_json(path);
+    rows_ = 0;
+    file_ = fopen(path.c_str(), "w");
+    if (!file_) {
+      perror(path.c_str());
+      return -1;
+    }
+    return 0;
+  }
+
+  bool is_open() const { return file_ != NULL; }
+
+  void text(const char *name, const std::string &value) {
+    field(name);
+    line_ += json_ ? "\"" + value + "\"" : value;
+  }
+
+  void integer(const char *name, long long value) {
+    field(name);
+    line_ += std::to_string(value);
+  }
+
+  void number(const char *name, double value, int decimals) {
+    if (isnan(value) && json_) return;
+    field(name);
+    if (isnan(value)) return;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    line_ += buffer;
+  }
+
+  /**
+   * @brief Write the record of the fields since the previous one
+   */
+  void end_record() {
+    if (!file_) return;
+    if (json_) {
+      fprintf(file_, "{%s}\n", line_.c_str());
+    } else {
+      if (rows_ == 0) fprintf(file_, "%s\n", header_.c_str());
+      fprintf(file_, "%s\n", line_.c_str());
+    }
+    rows_++;
+    line_.clear();
+    header_.clear();
+  }
+
+  /**
+   * @brief Close the file
+   * @return 0 on success, -1 on a write error, reported with perror
+   */
+  int close() {
+    if (!file_) return 0;
+    int result = fclose(file_) == 0 ? 0 : -1;
+    if (result != 0) perror("fclose(results)");
+    file_ = NULL;
+    return result;
+  }
+
+ private:
+  // Separator and, for JSON, the name of the next field
+  void field(const char *name) {
+    if (json_) {
+      if (!line_.empty()) line_ += ", ";
+      line_ += "\"" + std::string(name) + "\": ";
+    } else {
+      if (!header_.empty()) {
+        line_ += ",";
+        header_ += ",";
+      }
+      header_ += name;
+    }
+  }
+
+  FILE *file_;
+  bool json_;
+  long rows_;
+  std::string line_;    // Fields of the record being built
+  std::string header_;  // CSV field names of the record being built
+};
+
+#endif  // TOOL_COMMON_H